@@ -6,6 +6,7 @@
 #include "lib/cenote_delay.h"
 #include "vibrato.h"
 #include "xfade.h"
+#include "dirty.h"
 #include "lib/state.h"
 
 #include "lib/cenote_delay.h"
@@ -28,6 +29,32 @@ static constexpr float kShiftMaxSmall = 15.0f; // 15 hz if sw3 is not pressed
 #define MAX_DELAY_MS_LARGE 1500.0f
 #define MAX_DELAY_MS_SMALL 112.5f
 
+// delay memory. by default 1.5 s @ 48kHz in internal SRAM (750 ms @ 96kHz).
+// build with CENOTE_LONG_DELAY for 10 s at up to 96kHz in SDRAM.
+// CENOTE_HALF_RATE runs the feedback loop at sr / 2: half the memory.
+#ifdef CENOTE_HALF_RATE
+#define DELAY_RATE_DIV 2
+#else
+#define DELAY_RATE_DIV 1
+#endif
+
+#ifdef CENOTE_LONG_DELAY
+#define DELAY_MAX_MS 10000.0f
+#define DELAY_BUF_SIZE (96000 * 10 / DELAY_RATE_DIV + 2)
+#else
+#define DELAY_MAX_MS MAX_DELAY_MS_LARGE
+#define DELAY_BUF_SIZE (48000 * 3 / 2 / DELAY_RATE_DIV + 2)
+#endif
+
+// the feedback clip runs at the base rate. build with CENOTE_CLIP_X2 to
+// run it 2x oversampled (cleaner repeats at high feedback, ~11x the
+// clip's cost: measure the callback's load before shipping it).
+#ifdef CENOTE_CLIP_X2
+#define CLIP_OVERSAMPLE Saturator::OVERSAMPLE::X2
+#else
+#define CLIP_OVERSAMPLE Saturator::OVERSAMPLE::X1
+#endif
+
 
 // Declare a global daisy_petal for hardware access
 DaisyPetal  hw;
@@ -69,6 +96,11 @@ struct FswState {
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 CenoteDelayEngine del;
+#ifdef CENOTE_LONG_DELAY
+float DSY_SDRAM_BSS delay_buf[DELAY_BUF_SIZE];
+#else
+float delay_buf[DELAY_BUF_SIZE];
+#endif
 VibratoEngine vibrato; // Two engines for stereo vibrato
 Oscillator updown_lfo; // Up/Down LFO for freqshift
 
@@ -83,6 +115,13 @@ bool prev_bypass_state = false; // Previous bypass state for ramping
 
 // pot and switch values
 TerrariumState s;
+// knob jitter below this isn't a change
+constexpr static float kKnobHysteresis = 0.002f;
+Hysteresis pot_hyst[6];
+// engine setters run only when their derived value changes
+DirtyCounter setter_stats;
+Dirty<float> dirty_delay_ms, dirty_feedback, dirty_shift, dirty_lfo_depth, dirty_lfo_freq, dirty_mix, dirty_level;
+Dirty<bool> dirty_bypass_shift;
 // State for footswitches
 FswState fsw1, fsw2; // Footswitch states
 
@@ -153,12 +192,12 @@ void controlBlock() {
     knob6.Process();
 
     // update state
-    s.pot1 = knob1.Value();
-    s.pot2 = knob2.Value();
-    s.pot3 = knob3.Value();
-    s.pot4 = knob4.Value();
-    s.pot5 = knob5.Value();
-    s.pot6 = knob6.Value();
+    s.pot1 = pot_hyst[0].Process(knob1.Value());
+    s.pot2 = pot_hyst[1].Process(knob2.Value());
+    s.pot3 = pot_hyst[2].Process(knob3.Value());
+    s.pot4 = pot_hyst[3].Process(knob4.Value());
+    s.pot5 = pot_hyst[4].Process(knob5.Value());
+    s.pot6 = pot_hyst[5].Process(knob6.Value());
 
     s.sw1 = hw.switches[Terrarium::SWITCH_1].Pressed();
     s.sw2 = hw.switches[Terrarium::SWITCH_2].Pressed();
@@ -170,44 +209,64 @@ void controlBlock() {
     led2.Set(fsw2.state ? 1.0f : 0.0f);
 
     // set knob2 to delay time (sw3 selects time range)
-    del.SetDelayMs(
-        s.pot2 * (s.sw3 ? MAX_DELAY_MS_LARGE : MAX_DELAY_MS_SMALL)
-    );
+    {
+        float delay_ms = s.pot2 * (s.sw3 ? fmin(DELAY_MAX_MS, del.GetMaxDelayMs()) : MAX_DELAY_MS_SMALL);
+        if (dirty_delay_ms.Changed(delay_ms))
+            del.SetDelayMs(delay_ms);
+    }
 
     // set knob3 to feedback (fsw2 is "infinite" hold)
-    del.SetFeedback(
-        fsw2.state ? 1.0f : (s.pot3 * 0.9999999999f)
-    );
+    {
+        float feedback = fsw2.state ? 1.0f : (s.pot3 * 0.9999999999f);
+        if (dirty_feedback.Changed(feedback))
+            del.SetFeedback(feedback);
+    }
 
     // set knob5 to pitch shift amount (sign from sw4, range from sw3)
     {
         float up_or_down = s.sw4 ? 1.0f : -1.0f;
         float shift_mult = s.sw3 ? kShiftMaxLarge : kShiftMaxSmall;
-        del.SetTransposition(up_or_down * (s.pot5 * shift_mult));
-        del.SetBypassFrequencyShift(!s.sw2); // bypass freq shifter if sw2 is pressed
+        float shift = up_or_down * (s.pot5 * shift_mult);
+        if (dirty_shift.Changed(shift))
+            del.SetTransposition(shift);
+        if (dirty_bypass_shift.Changed(!s.sw2))
+            del.SetBypassFrequencyShift(!s.sw2); // bypass freq shifter if sw2 is pressed
     }
 
     // vibrato depth/rate (+ disable at tiny depths for latency reasons)
     {
         float lfodepth = s.sw1 ? 1.0f : s.pot4 * 0.5f;
-        vibrato.SetLfoDepth(lfodepth);
-        vibrato.SetLfoFreq(s.pot1 * 15.0f + 0.1f);
-        (s.pot4 < 0.1f) ? vibrato.SetMix(0.0f) : vibrato.SetMix(1.0f);
+        float lfofreq = s.pot1 * 15.0f + 0.1f;
+        float mix = (s.pot4 < 0.1f) ? 0.0f : 1.0f;
+        if (dirty_lfo_depth.Changed(lfodepth))
+            vibrato.SetLfoDepth(lfodepth);
+        if (dirty_lfo_freq.Changed(lfofreq))
+            vibrato.SetLfoFreq(lfofreq);
+        if (dirty_mix.Changed(mix))
+            vibrato.SetMix(mix);
     }
 
     led1.Update();
     led2.Update();
 
     // xfade level is active when either fsw engaged
-    xfade.SetCrossfade(
-        (fsw1.state || fsw2.state) ? knob6.Value() : 0.0f
-    );
+    {
+        float level = (fsw1.state || fsw2.state) ? s.pot6 : 0.0f;
+        if (dirty_level.Changed(level))
+            xfade.SetCrossfade(level);
+    }
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // AUDIO BLOCK
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+// per-block buffers (mono)
+static constexpr size_t kMaxBlock = 48;
+float sig_buf[kMaxBlock];
+float delay_in_buf[kMaxBlock];
+float del_out_buf[kMaxBlock];
+
 /*
  * This runs at a fixed rate, to prepare audio samples
  */
@@ -221,10 +280,6 @@ void callback(
     controlBlock();
 
 
-    float del_out;
-    float sig;
-    float delay_in; 
-
     bool new_bypass_state = (fsw1 || fsw2);
     if (new_bypass_state != prev_bypass_state) {
         // Bypass state changed, ramp the bypass
@@ -237,27 +292,30 @@ void callback(
     }
 
     uint8_t ramp_finished = 0;
-    for(size_t i = 0; i < size; i += 2)
+    for(size_t start = 0; start < size; start += 2 * kMaxBlock)
     {
-        sig = in[i];
+        size_t frames = std::min(kMaxBlock, (size - start) / 2);
+
+        for(size_t j = 0; j < frames; j++)
+        {
+            // vibrato is always on
+            sig_buf[j] = vibrato.Process(in[start + 2 * j]);
+
+            // ramp the input to the delay
+            delay_in_buf[j] = sig_buf[j] * bypass_ramp.Process(&ramp_finished);
+        }
 
-        // vibrato is always on
-        sig = vibrato.Process(sig);
-        
         // process delay
-        delay_in = sig * bypass_ramp.Process(&ramp_finished); // ramp the input to the delay
-        del_out = del.Process(
-            delay_in, 
-            /*clip=*/true, 
-            /*limit=*/fsw2
-        );
+        del.ProcessBlock(delay_in_buf, del_out_buf, frames, /*limit=*/fsw2);
 
-        // mix delay
-        sig = xfade.Process(sig, del_out * 1.414f); // little oomph
+        for(size_t j = 0; j < frames; j++)
+        {
+            // mix delay
+            float sig = xfade.Process(sig_buf[j], del_out_buf[j] * 1.414f); // little oomph
 
-        // softclip out
-        out[i] = SoftClip(sig); // Soft clipping
-        // out[i] = del_out; // Soft clipping
+            // softclip out
+            out[start + 2 * j] = SoftClip(sig); // Soft clipping
+        }
     }
 }
 
@@ -284,7 +342,9 @@ void init() {
     knob5.Init(hw.knob[Terrarium::KNOB_5], 0.0f, 1.0f, Parameter::EXPONENTIAL);
 
     // engines
-    del.Init(sr);
+    del.Init(sr, delay_buf, DELAY_BUF_SIZE, DELAY_MAX_MS);
+    del.SetHalfRate(DELAY_RATE_DIV == 2);
+    del.SetClipOversampling(CLIP_OVERSAMPLE);
     vibrato.Init(sr);
 
     updown_lfo.Init(sr);
@@ -296,10 +356,21 @@ void init() {
     bypass_ramp.Init(sr);
     bypass_ramp.Start(0.0f, 0.0f, ramp_time_ms * 0.001f);
 
-    // control_recorder.Init(); // (no-op in sandbox unless you wire it)
+    // control_recorder.Init(sr / 2.0f); // one Process() per 2-sample block (no-op in sandbox unless you wire it)
 
     xfade.Init(sr, 10.0f);
     xfade.SetCrossfadeType(Xfade::TYPE::ASYMMETRIC_MIX); // power crossfade
+
+    for (Hysteresis& h : pot_hyst)
+        h.Init(kKnobHysteresis);
+    dirty_delay_ms.Init(&setter_stats);
+    dirty_feedback.Init(&setter_stats);
+    dirty_shift.Init(&setter_stats);
+    dirty_bypass_shift.Init(&setter_stats);
+    dirty_lfo_depth.Init(&setter_stats);
+    dirty_lfo_freq.Init(&setter_stats);
+    dirty_mix.Init(&setter_stats);
+    dirty_level.Init(&setter_stats);
 }
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -6,7 +6,10 @@
 #include <cmath>
 #include <cstdint>
 #include "daisysp.h"
-#include "freqshift.h"
+#include "extdelayline.h"
+#include "halfband.h"
+#include "paramramp.h"
+#include "feedback_chain.h"
 
 using namespace daisysp;
 
@@ -18,80 +21,106 @@ class CenoteDelayEngine
     CenoteDelayEngine() {}
     ~CenoteDelayEngine() {}
 
-    void Init(float sample_rate, float fade_time_ms = 20.0f)
+    /**
+       buf/buf_size: delay memory owned by the caller (SRAM or SDRAM).
+       max_delay_ms: longest delay wanted; only as much of buf as that
+       needs at the loop's sample rate is used (the rest is left alone).
+    */
+    void Init(float  sample_rate,
+              float* buf,
+              size_t buf_size,
+              float  max_delay_ms,
+              float  fade_time_ms = 20.0f)
     {
-        sample_rate_ = sample_rate;
-
-        del_.Init();
-        freqshifter_.Init(sample_rate);
+        sample_rate_  = sample_rate;
+        buf_          = buf;
+        buf_size_     = buf_size;
+        max_delay_ms_ = max_delay_ms;
+        half_rate_    = false;
 
         feedback_ = 0.2f;
+        delay_.Init(sample_rate_, 0.f, ParamRamp::MODE::EXPONENTIAL, 0.f);
+        InitLoop();
         SetDelayMs(1000.f);
 
-        wet_        = 1.0f;
-        wet_target_ = 1.0f;
-        bypass_     = false;
-        bypass_freqshift_ = false;
-
-        const float fade_seconds = fmax(0.001f, fade_time_ms * 0.001f);
-        wet_coeff_ = std::exp(-1.0f / (fade_seconds * sample_rate_));
-
-
-        lopass_.Init(sample_rate_);
-        lopass_.SetFreq(8000.0f);
-        lopass_.SetRes(0.f);
-        hipass_.Init(sample_rate_);
-        hipass_.SetFreq(40.0f);
-        hipass_.SetRes(0.f);
-
+        bypass_ = false;
+        wet_.Init(sample_rate_, fmax(1.0f, fade_time_ms), ParamRamp::MODE::LINEAR, 1.0f);
     }
 
     float Process(float in, bool clip = true, bool limit = false)
     {
         // smooth the wet sign
-        fonepole(wet_, wet_target_, wet_coeff_);
-
-        // smooth delay time
-        fonepole(delay_, delay_target_, 0.00007f);
-        del_.SetDelay(delay_);
-
-        // read delayed sample
-        float delayed = del_.Read();
-
-        // write new sample to delay line
-        float line_in = in + delayed * feedback_;
-
-        // shift pitch
-        if (bypass_freqshift_)
-            freqshifter_.SetShift(0.0f);
+        const float wet = wet_.Process();
 
-        line_in = freqshifter_.Process(line_in);
-            
-        // filter edges
-        lopass_.Process(line_in);
-        line_in = lopass_.Low();
+        if(!half_rate_)
+            return ProcessLoop(in, limit) * wet;
 
-        hipass_.Process(line_in);
-        line_in = hipass_.High();
+        // half rate: the loop runs once per pair of input samples, and
+        // its upsampled output comes out over the next pair
+        pair_in_[phase_]    = in;
+        const float delayed = pair_out_[phase_];
+        if(phase_ == 1)
+            upsampler_.Process(ProcessLoop(downsampler_.Process(pair_in_), limit),
+                               pair_out_);
+        phase_ ^= 1;
 
-        line_in = SoftClip(line_in);
+        // dry/wet
+        return delayed * wet;
+    }
 
-        // apply limiter
-        if (limit)
-            line_in = SoftLimit(line_in);
+    /**
+       Block version of Process(). While the delay is longer than the block
+       (always, past ~0.1 ms at block sizes 2-4) no read of this block can
+       land on a sample written in it, so the whole block of delayed
+       samples is read first, at the positions the per-sample glide
+       gives, and the feedback chain then runs stage by stage. Falls back to Process() for shorter delays and in
+       half-rate mode. While idle (see IsIdle()) and the input is silent,
+       the block is silence and the loop doesn't run.
+    */
+    void ProcessBlock(const float* in, float* out, size_t size, bool limit = false)
+    {
+        while(size > 0)
+        {
+            const size_t n = size < kMaxBlock ? size : kMaxBlock;
+            ProcessChunk(in, out, n, limit);
+            in += n;
+            out += n;
+            size -= n;
+        }
+    }
 
-        del_.Write(line_in);
+    /**
+       Run the feedback loop (delay line, freq shifter, filters, clip) at
+       half the sample rate, between half-band decimation and
+       interpolation. The loop is low-passed at 8 kHz anyway, so the
+       repeats sound the same for half the delay memory per second and
+       about half the loop's CPU. Switching clears the delay line.
+    */
+    void SetHalfRate(bool half_rate)
+    {
+        if(half_rate == half_rate_)
+            return;
+        const float ratio  = half_rate ? 0.5f : 2.0f;
+        const float target = delay_.GetTarget();
+        half_rate_         = half_rate;
+        InitLoop();
+        delay_.SetValue(delay_.Value() * ratio);
+        delay_.SetTarget(fmin(target * ratio, max_delay_samps_));
+    }
 
-        // dry/wet
-        const float out = delayed * wet_;
+    bool GetHalfRate() const { return half_rate_; }
 
-        return out;
-    }
+    /**
+       Nothing above kSilence has gone into the line for longer than the
+       line is long, so every repeat has died away. Any input (or a
+       non-silent write from Process()) wakes it up again.
+    */
+    bool IsIdle() const { return quiet_ >= del_.GetSize(); }
 
     void SetDelayMs(float ms)
     {
         ms = fmax(0.1f, ms);
-        delay_target_ = ms * 0.001f * sample_rate_;
+        delay_.SetTarget(fmin(ms * 0.001f * loop_rate_, max_delay_samps_));
     }
 
     void SetFeedback(float feedback)
@@ -102,51 +131,176 @@ class CenoteDelayEngine
     void SetBypass(bool should_bypass)
     {
         bypass_ = should_bypass;
-        wet_target_ = bypass_ ? 0.0f : 1.0f;
+        wet_.SetTarget(bypass_ ? 0.0f : 1.0f);
     }
 
     void SetFadeTimeMs(float fade_time_ms)
     {
-        const float fade_seconds = fmax(0.001f, fade_time_ms * 0.001f);
-        wet_coeff_ = std::exp(-1.0f / (fade_seconds * sample_rate_));
+        wet_.SetTimeMs(fmax(1.0f, fade_time_ms));
     }
 
     float GetMaxDelayMs() const
     {
-        return (kDelayLength / sample_rate_) * 1000.0f; // Convert samples to milliseconds
+        return (max_delay_samps_ / loop_rate_) * 1000.0f; // Convert samples to milliseconds
+    }
+
+    // oversample the feedback clipper (X1 = plain SoftClip)
+    void SetClipOversampling(Saturator::OVERSAMPLE os)
+    {
+        chain_.SetClipOversampling(os);
     }
 
     void SetBypassFrequencyShift(bool bypass)
     {
-        bypass_freqshift_ = bypass;
+        chain_.SetBypassShift(bypass);
     }
 
     void SetTransposition(float hz)
     {
-        freqshifter_.SetShift(hz);
+        chain_.SetShift(hz);
     }
 
   private:
+    // (re)build everything that runs at the loop's rate
+    void InitLoop()
+    {
+        loop_rate_ = half_rate_ ? sample_rate_ * 0.5f : sample_rate_;
+
+        size_t size = ExtDelayLine<float>::SizeFor(loop_rate_, max_delay_ms_);
+        del_.Init(buf_, size < buf_size_ ? size : buf_size_);
+        max_delay_samps_ = (float)(del_.GetSize() - 2);
+
+        // same glide time at either rate (and land on the target: a glide
+        // a fraction of a sample short is heard as a lowpass by linear interp)
+        delay_.SetCoefficient(half_rate_ ? 1.0f - (1.0f - 0.00007f) * (1.0f - 0.00007f)
+                                         : 0.00007f);
+        delay_.SetSnap(0.01f);
+
+        chain_.Init(loop_rate_);
+
+        downsampler_.Init(kHalfbandTransition);
+        upsampler_.Init(kHalfbandTransition);
+        pair_in_[0] = pair_in_[1] = 0.f;
+        pair_out_[0] = pair_out_[1] = 0.f;
+        phase_ = 0;
+
+        quiet_ = 0;
+    }
+
+    void ProcessChunk(const float* in, float* out, size_t size, bool limit)
+    {
+        // the tail has died away and nothing new comes in: only the
+        // glides move (the line and the filters keep their near-silence)
+        if(IsIdle())
+        {
+            float peak = 0.f;
+            for(size_t i = 0; i < size; i++)
+                peak = fabsf(in[i]) > peak ? fabsf(in[i]) : peak;
+            if(peak < kSilence)
+            {
+                delay_.NextBlock(half_rate_ ? (size + 1) / 2 : size);
+                wet_.NextBlock(size);
+                for(size_t i = 0; i < size; i++)
+                    out[i] = 0.f;
+                return;
+            }
+        }
+
+        // the glide stays between the current delay and its target
+        if(half_rate_ || fmin(delay_.Value(), delay_.GetTarget()) < (float)(size + 1))
+        {
+            for(size_t i = 0; i < size; i++)
+                out[i] = Process(in[i], true, limit);
+            return;
+        }
+
+        // read every delayed sample up front. the write head will have
+        // moved i times by sample i, so it reads i samples closer. the
+        // glide steps a sample at a time, as in Process(), so the read
+        // positions (d - i is exact in float) are the same.
+        float line[kMaxBlock];
+        for(size_t i = 0; i < size; i++)
+        {
+            const float d = delay_.Process();
+            out[i]  = del_.Read(d - (float)i);
+            line[i] = in[i] + out[i] * feedback_;
+        }
+        del_.SetDelay(delay_.Value());
+
+        chain_.ProcessBlock(line, size, limit);
+
+        float peak = 0.f;
+        for(size_t i = 0; i < size; i++)
+        {
+            del_.Write(line[i]);
+            peak = fabsf(line[i]) > peak ? fabsf(line[i]) : peak;
+        }
+        quiet_ = peak > kSilence ? 0 : quiet_ + size;
+
+        // dry/wet (nothing to do once faded in)
+        if(wet_.IsSettled() && wet_.Value() == 1.0f)
+            return;
+        float       wet      = wet_.Value();
+        const float wet_step = wet_.NextBlock(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            wet += wet_step;
+            out[i] *= wet;
+        }
+    }
+
+    // one sample of the loop at loop_rate_, returns the delayed sample
+    inline float ProcessLoop(float in, bool limit)
+    {
+        // smooth delay time
+        del_.SetDelay(delay_.Process());
+
+        // read delayed sample (at half rate the top octave is close to the
+        // loop's Nyquist, linear interp would dull it)
+        float delayed = half_rate_ ? del_.ReadHermite() : del_.Read();
+
+        // write new sample to delay line
+        const float write = chain_.Process(in + delayed * feedback_, limit);
+        del_.Write(write);
+        quiet_ = fabsf(write) > kSilence ? 0 : quiet_ + 1;
+
+        return delayed;
+    }
+
+    static constexpr size_t kMaxBlock = 48;
+    static constexpr float  kSilence  = 1e-5f; // -100 dBFS
+
+    // 8 coefficients, flat to ~9 kHz @ 48k, stopband from ~15 kHz
+    static constexpr size_t kHalfbandCoefs      = 8;
+    static constexpr double kHalfbandTransition = 0.06;
+
     float sample_rate_;
-    static constexpr int32_t kDelayLength = 1.5 * 48000; // enough for ~1.5 s @48kHz
+    float loop_rate_;       // sample_rate_, or half of it
+    float max_delay_samps_; // longest delay the buffer allows (loop samples)
+
+    float* buf_;
+    size_t buf_size_;
+    float  max_delay_ms_;
 
-    FrequencyShifter freqshifter_; 
-    bool bypass_freqshift_ = false; // Bypass frequency shifting
+    // half-rate mode
+    bool                            half_rate_;
+    Downsampler2x<kHalfbandCoefs>   downsampler_;
+    Upsampler2x<kHalfbandCoefs>     upsampler_;
+    float                           pair_in_[2];
+    float                           pair_out_[2];
+    uint8_t                         phase_;
 
-    Svf lopass_; // Low-pass filter for feedback smoothing
-    Svf hipass_; // High-pass filter for feedback smoothing
+    CenoteFeedbackChain chain_; // shift, filters, clip
 
-    float feedback_;
-    float delay_;         // smoothed current delay length (in samples)
-    float delay_target_;  // target delay length (in samples)
+    float     feedback_;
+    ParamRamp delay_; // delay length (in loop samples)
 
-    DelayLine<float, kDelayLength> del_;
+    ExtDelayLine<float> del_;
+    size_t              quiet_; // loop samples since a write above kSilence
 
     // bypass 
-    bool  bypass_;
-    float wet_;          
-    float wet_target_;  
-    float wet_coeff_;  
+    bool      bypass_;
+    ParamRamp wet_;
 
 };
 } // namespace daisysp
@@ -0,0 +1,325 @@
+// cenote_delay_test.cpp
+// A/B render of the full-rate and half-rate feedback loops, ProcessBlock
+// against the per-sample path, idling after the tail, and their cost.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../../flib -I../../DaisySP/Source cenote_delay_test.cpp
+//       ../../DaisySP/build/libdaisysp.a -o cenote_delay_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "cenote_delay.h"
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr       = 48000.f;
+static constexpr size_t kBufSize  = 48000 * 2;
+static constexpr float  kDelayMs  = 250.f;
+static constexpr size_t kSettle   = 48000 * 5; // let the delay glide land
+static constexpr size_t kBurst    = 1440;      // 30 ms
+
+static float buf[kBufSize];
+
+// magnitude of a single DFT bin (Goertzel) at `hz` over x[start, start + n)
+double goertzel(const std::vector<float>& x, size_t start, size_t n, double hz)
+{
+    double w = 2.0 * M_PI * hz / kSr;
+    double k = 2.0 * std::cos(w);
+    double s1 = 0.0, s2 = 0.0;
+    for (size_t i = start; i < start + n; i++) {
+        double s0 = x[i] + k * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    double re = s1 - s2 * std::cos(w);
+    double im = s2 * std::sin(w);
+    return std::sqrt(re * re + im * im) / n;
+}
+
+static const double kPartials[] = {250.0, 1000.0, 3000.0, 6000.0};
+
+// a 30 ms burst of four partials after the settle time, then silence
+std::vector<float> render(bool half_rate, float shift_hz)
+{
+    CenoteDelayEngine del;
+    del.Init(kSr, buf, kBufSize, 1500.f);
+    del.SetHalfRate(half_rate);
+    del.SetDelayMs(kDelayMs);
+    del.SetFeedback(0.6f);
+    del.SetTransposition(shift_hz);
+
+    const size_t len = kSettle + 5 * (size_t)(kDelayMs * 0.001f * kSr);
+    std::vector<float> out(len);
+    for (size_t i = 0; i < len; i++) {
+        float x = 0.f;
+        if (i >= kSettle && i < kSettle + kBurst) {
+            for (double f : kPartials)
+                x += 0.2f * (float)std::sin(2.0 * M_PI * f * (i - kSettle) / kSr);
+        }
+        out[i] = del.Process(x);
+    }
+    return out;
+}
+
+// Test 1: the first four repeats have the same partial levels in both
+// modes. Below 4 kHz they should match; 6 kHz sits near the 8 kHz loop
+// lowpass, where DaisySP's Svf at 24 kHz (clamped at sr / 3) rolls off a
+// little earlier, so it is allowed ~1 dB more loss per pass.
+void test_ab_render()
+{
+    std::cout << "\n== Test 1: A/B render, full vs half rate ==\n";
+    const size_t repeat = (size_t)(kDelayMs * 0.001f * kSr);
+    for (float shift : {0.f, 15.f}) {
+        std::vector<float> full = render(false, shift);
+        std::vector<float> half = render(true, shift);
+        double worst_low = 0.0, worst_top = 0.0;
+        for (size_t r = 1; r <= 4; r++) {
+            // middle 20 ms of the r-th repeat
+            size_t start = kSettle + r * repeat + 240;
+            for (double f : kPartials) {
+                double a = 20.0 * std::log10(goertzel(full, start, 960, f + r * shift));
+                double b = 20.0 * std::log10(goertzel(half, start, 960, f + r * shift));
+                if (f < 4000.0)
+                    worst_low = std::max(worst_low, std::fabs(a - b));
+                else
+                    worst_top = std::max(worst_top, std::fabs(a - b) / r);
+            }
+        }
+        char msg[96];
+        std::snprintf(msg, sizeof(msg), "shift %2.0f Hz: partials < 4 kHz within %.2f dB", shift, worst_low);
+        CHECK(worst_low < 0.5, msg);
+        std::snprintf(msg, sizeof(msg), "shift %2.0f Hz: 6 kHz partial %.2f dB per repeat", shift, worst_top);
+        CHECK(worst_top < 1.5, msg);
+    }
+}
+
+// Test 2: cost per sample of both modes
+void test_cost()
+{
+    std::cout << "\n== Test 2: cost per sample ==\n";
+    double ns[2];
+    for (int half = 0; half < 2; half++) {
+        CenoteDelayEngine del;
+        del.Init(kSr, buf, kBufSize, 1500.f);
+        del.SetHalfRate(half == 1);
+        del.SetDelayMs(kDelayMs);
+        del.SetFeedback(0.6f);
+        del.SetTransposition(15.f);
+
+        const size_t len = 48000 * 5;
+        float acc = 0.f;
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < len; i++)
+            acc += del.Process(0.1f * (float)((i * 7919) % 101) / 101.f);
+        auto t1 = std::chrono::steady_clock::now();
+        volatile float sink = acc;
+        (void)sink;
+        ns[half] = std::chrono::duration<double, std::nano>(t1 - t0).count() / len;
+    }
+    std::printf("full rate: %6.2f ns/sample\n", ns[0]);
+    std::printf("half rate: %6.2f ns/sample (%.2fx)\n", ns[1], ns[0] / ns[1]);
+    CHECK(ns[1] < ns[0], "half rate is cheaper");
+}
+
+// noise through a moving delay (glides 1000 -> 300 ms, then jumps to
+// 80 ms), with shift and high feedback. block == 0 is the per-sample path.
+std::vector<float> render_moving(size_t block)
+{
+    CenoteDelayEngine del;
+    del.Init(kSr, buf, kBufSize, 1500.f);
+    del.SetDelayMs(300.f);
+    del.SetFeedback(0.8f);
+    del.SetTransposition(15.f);
+
+    const size_t len = 48000 * 4;
+    std::vector<float> in(len), out(len);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        in[i] = 0.25f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+    }
+    for (size_t i = 0; i < len; i += (block ? block : 1)) {
+        if (i >= len / 2 && i < len / 2 + (block ? block : 1))
+            del.SetDelayMs(80.f);
+        if (block == 0)
+            out[i] = del.Process(in[i]);
+        else
+            del.ProcessBlock(&in[i], &out[i], block);
+    }
+    return out;
+}
+
+// Test 3: ProcessBlock matches the per-sample path to float rounding,
+// through the start-up glide and a jump in delay time: both step the
+// glide a sample at a time and read at the same positions. (What's left
+// is the shifter's carrier, renormalized once per call.)
+void test_block_matches_per_sample()
+{
+    std::cout << "\n== Test 3: ProcessBlock vs Process ==\n";
+    std::vector<float> ref = render_moving(0);
+    for (size_t b : {2, 4, 48}) {
+        std::vector<float> blk = render_moving(b);
+        float err = 0.f, peak = 0.f;
+        for (size_t i = 0; i < ref.size(); i++) {
+            err  = std::max(err, std::fabs(ref[i] - blk[i]));
+            peak = std::max(peak, std::fabs(ref[i]));
+        }
+        char msg[96];
+        std::snprintf(msg, sizeof(msg), "block %2zu: max error %.2e (peak %.2f)", b, err, peak);
+        CHECK(err < 2e-5f * peak, msg);
+    }
+}
+
+// Test 4: cost per sample of Process() and ProcessBlock()
+void test_block_cost()
+{
+    std::cout << "\n== Test 4: ProcessBlock cost ==\n";
+    const size_t blocks[] = {0, 2, 4, 48};
+    double ns[4];
+    for (size_t k = 0; k < 4; k++) {
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<float> y = render_moving(blocks[k]);
+        auto t1 = std::chrono::steady_clock::now();
+        volatile float sink = y[y.size() / 2];
+        (void)sink;
+        ns[k] = std::chrono::duration<double, std::nano>(t1 - t0).count() / y.size();
+    }
+    std::printf("Process():        %6.2f ns/sample\n", ns[0]);
+    for (size_t k = 1; k < 4; k++)
+        std::printf("ProcessBlock(%2zu): %6.2f ns/sample (%.2fx)\n", blocks[k], ns[k], ns[0] / ns[k]);
+}
+
+std::vector<float> noise_block(size_t len)
+{
+    std::vector<float> x(len);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        x[i] = 0.25f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+    }
+    return x;
+}
+
+// 0.5 s of noise, silence until well after the tail dies, 0.5 s of noise
+// at `second_burst`, silence
+std::vector<float> bursts(size_t len, size_t second_burst)
+{
+    std::vector<float> in = noise_block(len);
+    for (size_t i = 0; i < len; i++)
+        if (!(i < 24000 || (i >= second_burst && i < second_burst + 24000)))
+            in[i] = 0.f;
+    return in;
+}
+
+// Test 5: once the tail has died away the engine idles (exact silence, no
+// loop), wakes on the next input and sounds as if it had run all along.
+// (Unshifted: a shifter that idled wakes with its carrier at another phase
+// than one that kept running, which is inaudible but not sample-equal.)
+void test_idle()
+{
+    std::cout << "\n== Test 5: idle after the tail ==\n";
+    const size_t len = 48000 * 20, second = 48000 * 12;
+    std::vector<float> in = bursts(len, second), ref(len), out(len);
+
+    CenoteDelayEngine a, b;
+    for (CenoteDelayEngine* d : {&a, &b}) {
+        d->Init(kSr, buf, kBufSize, 1500.f);
+        d->SetDelayMs(kDelayMs);
+        d->SetFeedback(0.6f);
+    }
+    // a: per-sample, never idles
+    for (size_t i = 0; i < len; i++)
+        ref[i] = a.Process(in[i]);
+
+    // b: blocks of 4 (same buffer: a is done with it)
+    b.Init(kSr, buf, kBufSize, 1500.f);
+    b.SetDelayMs(kDelayMs);
+    b.SetFeedback(0.6f);
+    size_t idle_at = 0, woke_at = 0;
+    for (size_t i = 0; i < len; i += 4) {
+        b.ProcessBlock(&in[i], &out[i], 4);
+        if (!idle_at && b.IsIdle())
+            idle_at = i;
+        if (idle_at && !woke_at && !b.IsIdle())
+            woke_at = i;
+    }
+
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "idle %.2f s after the burst", (idle_at - 24000) / kSr);
+    CHECK(idle_at > 0 && idle_at < second, msg);
+    bool silent = true;
+    for (size_t i = idle_at + 4; i < second; i++)
+        silent = silent && out[i] == 0.f;
+    CHECK(silent, "idle output is silence");
+    std::snprintf(msg, sizeof(msg), "woke %zu samples into the next input", woke_at - second);
+    CHECK(woke_at >= second && woke_at <= second + 4, msg);
+
+    float err = 0.f, peak = 0.f;
+    for (size_t i = 0; i < len; i++) {
+        err  = std::max(err, std::fabs(ref[i] - out[i]));
+        peak = std::max(peak, std::fabs(ref[i]));
+    }
+    std::snprintf(msg, sizeof(msg), "matches a loop that never idled within %.2e (peak %.2f)", err, peak);
+    CHECK(err < 2e-5f * peak, msg); // as Test 3
+}
+
+// Test 6: what idling and the shifter bypass save, at block size 4. Timed
+// after 3 s, by which time the silent run has gone idle.
+void test_idle_cost()
+{
+    std::cout << "\n== Test 6: idle / bypass cost ==\n";
+    const size_t warmup = 48000 * 3, len = 48000 * 4;
+    std::vector<float> in = noise_block(warmup + len), out(warmup + len);
+    std::vector<float> quiet(warmup + len, 0.f);
+
+    auto run = [&](bool bypass, const std::vector<float>& x) {
+        CenoteDelayEngine del;
+        del.Init(kSr, buf, kBufSize, 1500.f);
+        del.SetDelayMs(kDelayMs);
+        del.SetFeedback(0.6f);
+        del.SetTransposition(15.f);
+        del.SetBypassFrequencyShift(bypass);
+        for (size_t i = 0; i < warmup; i += 4)
+            del.ProcessBlock(&x[i], &out[i], 4);
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = warmup; i < warmup + len; i += 4)
+            del.ProcessBlock(&x[i], &out[i], 4);
+        auto t1 = std::chrono::steady_clock::now();
+        volatile float sink = out[warmup + len / 2];
+        (void)sink;
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / len;
+    };
+
+    const double shifted = run(false, in);
+    const double bypass  = run(true, in);
+    const double idle    = run(false, quiet);
+    std::printf("shifting:          %6.2f ns/sample\n", shifted);
+    std::printf("shifter bypassed:  %6.2f ns/sample (%.2fx)\n", bypass, shifted / bypass);
+    std::printf("idle (no input):   %6.2f ns/sample (%.2fx)\n", idle, shifted / idle);
+    CHECK(bypass < shifted, "bypassing the shifter is cheaper");
+    CHECK(idle < 0.25 * shifted, "idle costs under a quarter of running");
+}
+
+int main()
+{
+    std::cout << "Running cenote delay tests...\n";
+    test_ab_render();
+    test_cost();
+    test_block_matches_per_sample();
+    test_block_cost();
+    test_idle();
+    test_idle_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -1,13 +1,14 @@
-
 #pragma once
 
 #ifndef H_CONTROL_RECORDER_H
 #define H_CONTROL_RECORDER_H
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include "daisy_seed.h"
 #include "daisysp.h"
+#include "timeline.h"
 #include "state.h"
 
 using namespace daisy;
@@ -15,6 +16,30 @@ using namespace daisysp;
 
 namespace daisysp
 {
+/**
+   Records the Terrarium's pots and switches and plays them back in a loop.
+
+   Controls are sampled at a fixed frame rate (100 Hz by default), not once
+   per Process() call, and stored as a stream of 16-bit words holding only
+   what changed:
+
+       header: bits 0-5   which pots follow
+               bits 6-9   the four switches
+               bits 10-15 frames since the previous header (0-63)
+       then one word per flagged pot, quantized to kPotBits
+
+   A header with no pots is written at least every 63 frames. Pots moving
+   by one step or less (ADC jitter) are not stored. Playback interpolates
+   pots linearly between frames; switches change on frame boundaries.
+
+   kPoolWords (96 KB, about what the old 4000 raw frames took) holds four
+   minutes of one pot turning nonstop, over a minute of all six, and hours
+   of a still pedal.
+
+   WriteTimeline() exports a take as a TimelineWriter event stream (pots
+   are knobs 0-5, switches 0-3), and Apply() plays such events back into
+   a TerrariumState.
+*/
 class TerrariumControlRecorder {
 public:
     TerrariumControlRecorder() {}
@@ -26,9 +51,24 @@ public:
         PLAYING
     };
 
-    void Init()
+    static constexpr uint8_t kPotBits   = 10;
+    static constexpr size_t  kPoolWords = 49152;
+
+    /**
+       control_rate: how often Process() is called (Hz), e.g. the audio
+       callback rate. frame_rate: how often the controls are recorded.
+    */
+    void Init(float control_rate, float frame_rate = 100.0f)
     {
-        index_ = 0;
+        control_rate_ = control_rate;
+        decimation_   = (uint32_t)(control_rate / frame_rate + 0.5f);
+        if (decimation_ < 1) decimation_ = 1;
+
+        state_  = CtrlRecorderState::IDLE;
+        index_  = 0;
+        tick_   = 0;
+        used_   = 0;
+        length_ = 0;
         for (int i = 0; i < n_pots_; i++) {
             prev_pots_[i] = 0.0f;
             pot_override_[i] = false;
@@ -41,9 +81,11 @@ public:
 
     void StartRecording()
     {
-        // index_ = 0;
         if (state_ != CtrlRecorderState::RECORDING) {
-            index_ = 0;
+            index_          = 0;
+            tick_           = 0;
+            used_           = 0;
+            last_rec_frame_ = 0;
         }
         state_ = CtrlRecorderState::RECORDING;
         ResetOverrides();
@@ -51,9 +93,24 @@ public:
 
     void StartPlaying()
     {
+        if (state_ == CtrlRecorderState::RECORDING)
+            length_ = index_;
+        ResetOverrides();
+        if (length_ == 0) {
+            state_ = CtrlRecorderState::IDLE;
+            return;
+        }
+
+        // frame 0 (a full frame) into cur_, frame 1 into nxt_
         index_ = 0;
+        tick_  = 0;
+        Rewind();
+        DecodeFrame(0);
+        for (uint8_t i = 0; i < n_pots_; i++) cur_[i] = nxt_[i];
+        sw_cur_ = sw_nxt_;
+        DecodeNext();
+
         state_ = CtrlRecorderState::PLAYING;
-        ResetOverrides();
     }
 
     void StopPlaying()
@@ -71,14 +128,71 @@ public:
 
     CtrlRecorderState GetState() const { return state_; }
 
+    /// frame being recorded or played
     size_t GetIndex()
     {
         return index_;
     }
 
-    // void Process(float* pots, bool* switches)
+    /// recorded (or recording) length in seconds
+    float GetLengthSeconds() const
+    {
+        const size_t frames = state_ == CtrlRecorderState::RECORDING ? index_ : length_;
+        return frames * decimation_ / control_rate();
+    }
+
+    /// fraction of the pool used
+    float GetFill() const { return (float)used_ / kPoolWords; }
+
+    /**
+       Write the last take as timeline events, stamped in samples at
+       `sample_rate` (one knob event per stored pot change, one switch
+       event per edge). False if the writer filled up.
+    */
+    bool WriteTimeline(TimelineWriter& w, float sample_rate) const
+    {
+        const size_t frames = state_ == CtrlRecorderState::RECORDING ? index_ : length_;
+        const double samps  = (double)decimation_ * sample_rate / control_rate();
+
+        size_t  pos = 0, frame = 0;
+        uint8_t sw  = 0;
+        while (pos < used_) {
+            const uint16_t h = pool_[pos++];
+            frame += h >> kDeltaShift;
+            if (frame >= frames)
+                break;
+            const uint32_t t = (uint32_t)(frame * samps + 0.5);
+            for (uint8_t i = 0; i < n_pots_; i++)
+                if (h & (1u << i))
+                    if (!w.Knob(t, i, pool_[pos++] * (1.0f / kPotMax)))
+                        return false;
+            const uint8_t now = (h >> kSwShift) & 0xF;
+            for (uint8_t i = 0; i < n_switches_; i++)
+                if (frame == 0 || ((now ^ sw) >> i & 1))
+                    if (!w.Switch(t, i, (now >> i) & 1))
+                        return false;
+            sw = now;
+        }
+        return true;
+    }
+
+    /// apply a knob or switch event to `s` (footswitches aren't part of it)
+    static void Apply(const TimelineEvent& e, terrarium::TerrariumState& s)
+    {
+        if (e.type == TimelineEvent::KNOB) {
+            float* pots[n_pots_] = {&s.pot1, &s.pot2, &s.pot3, &s.pot4, &s.pot5, &s.pot6};
+            if (e.id < n_pots_)
+                *pots[e.id] = e.Knob();
+        }
+        else if (e.type == TimelineEvent::SWITCH) {
+            bool* switches[n_switches_] = {&s.sw1, &s.sw2, &s.sw3, &s.sw4};
+            if (e.id < n_switches_)
+                *switches[e.id] = e.value != 0;
+        }
+    }
+
     void Process(
-        TerrariumState& s
+        terrarium::TerrariumState& s
     )
     {
         float pots[n_pots_];
@@ -97,20 +211,11 @@ public:
         switches[3] = s.sw4;
 
         if (state_ == CtrlRecorderState::RECORDING) {
-            // Record
-            for (uint8_t i = 0; i < n_pots_; i++) {
-                pot_buf_[index_][i] = pots[i];
-            }
-            for (uint8_t i = 0; i < n_switches_; i++) {
-                switch_buf_[index_][i] = switches[i];
-            }
-
-            last_recorded_index_ = index_;
-
-            if (++index_ >= buf_size_) {
-                StartPlaying(); 
-                ResetOverrides();
-            }
+            // Record one frame every decimation_ calls
+            if (tick_ == 0)
+                RecordFrame(pots, switches); // may fill up and start playing
+            if (state_ == CtrlRecorderState::RECORDING && ++tick_ >= decimation_)
+                tick_ = 0;
         }
         else if (state_ == CtrlRecorderState::PLAYING) {
 
@@ -128,28 +233,30 @@ public:
                 }
             }
             // Save current hardware state for next frame comparison
-            for (uint8_t i = 0; i < n_pots_; i++) 
+            for (uint8_t i = 0; i < n_pots_; i++)
                 prev_pots_[i] = pots[i];
-            for (uint8_t i = 0; i < n_switches_; i++) 
+            for (uint8_t i = 0; i < n_switches_; i++)
                 prev_switches_[i] = switches[i];
 
 
-            // Apply recorded values for non-overridden controls
+            // Apply recorded values for non-overridden controls,
+            // pots interpolated between this frame and the next
+            const float frac = (float)tick_ / decimation_;
             for (uint8_t i = 0; i < n_pots_; i++) {
                 if (!pot_override_[i]) {
-                    pots[i] = pot_buf_[index_][i];
+                    pots[i] = cur_[i] + (nxt_[i] - cur_[i]) * frac;
                 }
             }
             for (uint8_t i = 0; i < n_switches_; i++) {
                 if (!switch_override_[i]) {
-                    switches[i] = switch_buf_[index_][i];
+                    switches[i] = (sw_cur_ >> i) & 1;
                 }
             }
 
-            // Advance playback index
-            index_++;
-            if (index_ >= last_recorded_index_) {
-                index_ = 0;
+            // Advance playback
+            if (++tick_ >= decimation_) {
+                tick_ = 0;
+                AdvanceFrame();
             }
         }
 
@@ -166,19 +273,127 @@ public:
     }
 
 private:
+    static constexpr uint16_t kPotMax    = (1u << kPotBits) - 1;
+    static constexpr uint32_t kMaxDelta  = 63;
+    static constexpr int      kSwShift   = 6;
+    static constexpr int      kDeltaShift = 10;
+
+    float control_rate() const { return control_rate_ > 0.f ? control_rate_ : 1.f; }
+
     void ResetOverrides()
     {
         for (int i = 0; i < n_pots_; i++) pot_override_[i] = false;
         for (int i = 0; i < n_switches_; i++) switch_override_[i] = false;
     }
 
+    static uint16_t Quantize(float v)
+    {
+        v = v < 0.f ? 0.f : (v > 1.f ? 1.f : v);
+        return (uint16_t)(v * kPotMax + 0.5f);
+    }
+
+    void RecordFrame(const float* pots, const bool* switches)
+    {
+        const bool first = (index_ == 0);
+
+        uint16_t q[n_pots_];
+        uint16_t mask = 0;
+        size_t   n    = 0;
+        for (uint8_t i = 0; i < n_pots_; i++) {
+            q[i] = Quantize(pots[i]);
+            const int d = (int)q[i] - (int)rec_pots_[i];
+            if (first || d > 1 || d < -1) {
+                mask |= 1u << i;
+                n++;
+            }
+        }
+        uint16_t sw = 0;
+        for (uint8_t i = 0; i < n_switches_; i++)
+            sw |= (uint16_t)switches[i] << i;
+
+        const uint32_t delta = (uint32_t)(index_ - last_rec_frame_);
+        if (first || mask || sw != rec_sw_ || delta >= kMaxDelta) {
+            if (used_ + 1 + n > kPoolWords) {
+                // full: loop what we have
+                StartPlaying();
+                return;
+            }
+            pool_[used_++] = mask | (sw << kSwShift) | (delta << kDeltaShift);
+            for (uint8_t i = 0; i < n_pots_; i++) {
+                if (mask & (1u << i)) {
+                    pool_[used_++] = q[i];
+                    rec_pots_[i]   = q[i];
+                }
+            }
+            rec_sw_         = sw;
+            last_rec_frame_ = index_;
+        }
+        index_++;
+    }
+
+    // decoding restarts at the first header (frame 0)
+    void Rewind()
+    {
+        read_      = 0;
+        dec_frame_ = 0;
+    }
+
+    // apply every header stamped `frame` to nxt_ / sw_nxt_
+    void DecodeFrame(size_t frame)
+    {
+        while (read_ < used_) {
+            const uint16_t h = pool_[read_];
+            const size_t   f = dec_frame_ + (h >> kDeltaShift);
+            if (f != frame)
+                break;
+            dec_frame_ = f;
+            read_++;
+            sw_nxt_ = (h >> kSwShift) & 0xF;
+            for (uint8_t i = 0; i < n_pots_; i++)
+                if (h & (1u << i))
+                    nxt_[i] = pool_[read_++] * (1.0f / kPotMax);
+        }
+    }
+
+    // the frame after index_ (wrapping to frame 0) into nxt_
+    void DecodeNext()
+    {
+        if (index_ + 1 >= length_) {
+            Rewind();
+            DecodeFrame(0);
+        } else {
+            DecodeFrame(index_ + 1);
+        }
+    }
+
+    void AdvanceFrame()
+    {
+        index_ = (index_ + 1 >= length_) ? 0 : index_ + 1;
+        for (uint8_t i = 0; i < n_pots_; i++) cur_[i] = nxt_[i];
+        sw_cur_ = sw_nxt_;
+        DecodeNext();
+    }
+
     static constexpr uint8_t n_pots_ = 6;
     static constexpr uint8_t n_switches_ = 4;
-    static constexpr uint16_t buf_size_ = 4000;
-    size_t last_recorded_index_ = 0;
 
-    float pot_buf_[buf_size_][n_pots_];
-    bool switch_buf_[buf_size_][n_switches_];
+    // recording
+    uint16_t pool_[kPoolWords];
+    size_t   used_   = 0;
+    size_t   length_ = 0; // frames in the last recording
+    uint16_t rec_pots_[n_pots_];
+    uint16_t rec_sw_;
+    size_t   last_rec_frame_;
+
+    // playback
+    size_t   read_;      // next header
+    size_t   dec_frame_; // frame of the last decoded header
+    float    cur_[n_pots_], nxt_[n_pots_];
+    uint8_t  sw_cur_, sw_nxt_;
+
+    float    control_rate_ = 0.f;
+    uint32_t decimation_   = 1;
+    uint32_t tick_         = 0;
 
     float prev_pots_[n_pots_];
     bool prev_switches_[n_switches_];
@@ -186,7 +401,7 @@ private:
     bool pot_override_[n_pots_];
     bool switch_override_[n_switches_];
 
-    bool listen_for_overrides_ = true; 
+    bool listen_for_overrides_ = true;
 
 
     size_t index_;
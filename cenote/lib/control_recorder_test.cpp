@@ -0,0 +1,196 @@
+// control_recorder_test.cpp
+// TerrariumControlRecorder: how long a take fits, how closely playback
+// follows it, its timeline export, and that live controls still override.
+// build (host build of libDaisy/DaisySP):
+//   g++ -O2 -std=c++14 -I../../flib -I../../libDaisy/src -I../../DaisySP/Source control_recorder_test.cpp
+//       ../../DaisySP/build/libdaisysp.a -o control_recorder_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "control_recorder.h"
+
+using daisysp::TerrariumControlRecorder;
+using daisysp::TimelineEvent;
+using daisysp::TimelinePlayer;
+using daisysp::TimelineReader;
+using daisysp::TimelineWriter;
+using terrarium::TerrariumState;
+using Rec = TerrariumControlRecorder::CtrlRecorderState;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kRate = 24000.f; // cenote: one Process() per 2-sample block
+static constexpr size_t kTake = (size_t)kRate * 180;
+
+static TerrariumControlRecorder rec; // 96 KB
+
+// a performance: two pots swept, one nudged now and then, the rest still
+// but for ADC jitter; a switch flipped every 7 s
+TerrariumState gesture(size_t n)
+{
+    const double t = n / kRate;
+    TerrariumState s;
+    s.pot1 = 0.5f + 0.45f * (float)std::sin(2.0 * M_PI * 0.1 * t);
+    s.pot2 = 0.5f + 0.3f * (float)std::sin(2.0 * M_PI * 0.25 * t);
+    s.pot3 = (n / (size_t)(kRate * 20)) % 2 ? 0.8f : 0.2f;
+    s.pot4 = 0.33f + ((uint32_t)(n * 2654435761u) >> 31) * 0.0005f;
+    s.pot5 = 0.5f;
+    s.pot6 = 0.9f;
+    s.sw2  = (n / (size_t)(kRate * 7)) % 2;
+    return s;
+}
+
+float pot(const TerrariumState& s, int i)
+{
+    const float p[] = {s.pot1, s.pot2, s.pot3, s.pot4, s.pot5, s.pot6};
+    return p[i];
+}
+
+// Test 1: three minutes fit, and play back in a loop within a few
+// thousandths of the take (pot3's jumps become 10 ms slides into the
+// frame they were recorded on, which the comparison skips)
+void test_playback()
+{
+    std::cout << "\n== Test 1: a 3 minute take ==\n";
+    rec.Init(kRate);
+    rec.StartRecording();
+    for (size_t n = 0; n < kTake; n++) {
+        TerrariumState s = gesture(n);
+        rec.Process(s);
+    }
+    CHECK(rec.GetState() == Rec::RECORDING, "still recording after 3 minutes");
+    std::printf("pool %.1f%% full (%.1f minutes of this would fit)\n", 100.f * rec.GetFill(),
+                3.f / rec.GetFill());
+    rec.StartPlaying();
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "loop is %.2f s", rec.GetLengthSeconds());
+    CHECK(std::fabs(rec.GetLengthSeconds() - 180.f) < 0.011f, msg);
+
+    rec.SetListenForOverrides(false);
+    float worst = 0.f;
+    size_t sw_wrong = 0;
+    for (size_t loop = 0; loop < 2; loop++) {
+        for (size_t n = 0; n < kTake; n++) {
+            const TerrariumState want = gesture(n);
+            TerrariumState s;
+            rec.Process(s);
+            for (int i = 0; i < 6; i++)
+                if (i != 2 || (n + 240) % (size_t)(kRate * 20) > 240)
+                    worst = std::fmax(worst, std::fabs(pot(s, i) - pot(want, i)));
+            sw_wrong += s.sw2 != want.sw2;
+        }
+    }
+    std::snprintf(msg, sizeof(msg), "pots within %.4f of the take, twice round", worst);
+    CHECK(worst < 0.004f, msg);
+    std::snprintf(msg, sizeof(msg), "switch off the take for %zu calls (at most a frame per flip)", sw_wrong);
+    CHECK(sw_wrong <= 2 * 26 * 240, msg);
+}
+
+// Test 2: exported as a timeline and replayed sample-accurately into a
+// TerrariumState, the take comes back frame for frame (the knobs' 16 bits
+// round the recorder's 10 again)
+void test_timeline()
+{
+    std::cout << "\n== Test 2: timeline export ==\n";
+    static uint32_t buf[1 << 16];
+    TimelineWriter w;
+    w.Init(buf, sizeof(buf), 48000.f);
+    CHECK(rec.WriteTimeline(w, 48000.f), "whole take written");
+
+    TimelineReader r;
+    r.Init(buf, w.GetSize());
+    std::printf("%zu events, %zu bytes (%.1f%% of the recorder's pool)\n", r.GetCount(), w.GetSize(),
+                100.0 * w.GetSize() / (2.0 * TerrariumControlRecorder::kPoolWords));
+
+    // a frame is 240 control calls = 480 samples
+    TimelinePlayer player;
+    player.Init(r);
+    TerrariumState s;
+    float worst = 0.f;
+    bool switches = true;
+    for (size_t f = 0; f < 180 * 100; f++) {
+        player.Render(480, 48, [&](const TimelineEvent& e) { TerrariumControlRecorder::Apply(e, s); },
+                      [](uint32_t, size_t) {});
+        const TerrariumState want = gesture(f * 240);
+        for (int i = 0; i < 6; i++)
+            if (i != 2 || (f * 240) % (size_t)(kRate * 20) != 0)
+                worst = std::fmax(worst, std::fabs(pot(s, i) - pot(want, i)));
+        switches = switches && s.sw2 == want.sw2 && !s.sw1;
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "pots within %.4f of the take at every frame", worst);
+    CHECK(worst < 0.004f, msg);
+    CHECK(switches, "switches flip on their frames");
+}
+
+// Test 3: a live pot or switch takes over from the recording, the rest
+// keep playing
+void test_overrides()
+{
+    std::cout << "\n== Test 3: overrides ==\n";
+    rec.SetListenForOverrides(true);
+    rec.StartPlaying();
+    TerrariumState live;
+    live.pot3 = 0.5f;
+    bool pot_live = true, sw_live = true, others = true;
+    for (size_t n = 0; n < (size_t)kRate * 2; n++) {
+        if (n == 1000)
+            live.pot3 = 0.6f;
+        if (n == 2000)
+            live.sw4 = true;
+        TerrariumState s = live;
+        rec.Process(s);
+        const TerrariumState want = gesture(n);
+        if (n > 1000)
+            pot_live = pot_live && s.pot3 == 0.6f;
+        if (n > 2000)
+            sw_live = sw_live && s.sw4;
+        others = others && std::fabs(s.pot1 - want.pot1) < 0.004f && s.sw2 == want.sw2;
+    }
+    CHECK(pot_live, "moved pot follows the hand");
+    CHECK(sw_live, "flipped switch follows the hand");
+    CHECK(others, "untouched controls keep playing");
+}
+
+// Test 4: all six pots moving nonstop still fit over a minute, and a full
+// pool loops what it holds
+void test_full()
+{
+    std::cout << "\n== Test 4: worst case ==\n";
+    rec.Init(kRate);
+    rec.StartRecording();
+    size_t n = 0;
+    while (rec.GetState() == Rec::RECORDING && n < kTake) {
+        const float v = 0.5f + 0.45f * (float)std::sin(2.0 * M_PI * 0.5 * n / kRate);
+        TerrariumState s;
+        s.pot1 = s.pot2 = s.pot3 = s.pot4 = s.pot5 = s.pot6 = v;
+        rec.Process(s);
+        n++;
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "full after %.1f s, then playing", n / kRate);
+    CHECK(rec.GetState() == Rec::PLAYING && n / kRate > 60.f, msg);
+    std::printf("(the old recorder held %.2f s at the same rate)\n", 4000 / kRate);
+}
+
+int main()
+{
+    std::cout << "Running control recorder tests...\n";
+    test_playback();
+    test_timeline();
+    test_overrides();
+    test_full();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#ifndef CENOTE_FEEDBACK_CHAIN_H
+#define CENOTE_FEEDBACK_CHAIN_H
+
+#include <cmath>
+#include <cstddef>
+#include "daisysp.h"
+#include "freqshift.h"
+#include "saturator.h"
+
+namespace daisysp
+{
+/**
+   What Cenote's repeats go through on their way back into the line:
+   frequency shift, 40 Hz - 8 kHz band limit, soft clip and an optional
+   SoftLimit. Shared by CenoteDelayEngine and MultiTapDelayEngine.
+
+   Init() can be called again at a new rate (half-rate mode); the shift
+   and clip settings are kept.
+*/
+class CenoteFeedbackChain
+{
+  public:
+    CenoteFeedbackChain() {}
+    ~CenoteFeedbackChain() {}
+
+    void Init(float sample_rate)
+    {
+        freqshifter_.Init(sample_rate);
+        freqshifter_.SetShift(shift_hz_);
+        UpdateShiftBypass();
+        clip_.Init(clip_os_);
+
+        lopass_.Init(sample_rate);
+        lopass_.SetFreq(8000.0f);
+        lopass_.SetRes(0.f);
+        hipass_.Init(sample_rate);
+        hipass_.SetFreq(40.0f);
+        hipass_.SetRes(0.f);
+    }
+
+    inline float Process(float in, bool limit)
+    {
+        // shift pitch
+        freqshifter_.ProcessBlock(&in, &in, 1);
+
+        // filter edges
+        lopass_.Process(in);
+        hipass_.Process(lopass_.Low());
+        in = clip_.Process(hipass_.High());
+
+        // apply limiter
+        return limit ? SoftLimit(in) : in;
+    }
+
+    /// In place, stage by stage
+    void ProcessBlock(float* buf, size_t size, bool limit)
+    {
+        freqshifter_.ProcessBlock(buf, buf, size);
+
+        for(size_t i = 0; i < size; i++)
+        {
+            lopass_.Process(buf[i]);
+            hipass_.Process(lopass_.Low());
+            buf[i] = hipass_.High();
+        }
+
+        clip_.ProcessBlock(buf, buf, size);
+
+        if(limit)
+            for(size_t i = 0; i < size; i++)
+                buf[i] = SoftLimit(buf[i]);
+    }
+
+    void SetShift(float hz)
+    {
+        shift_hz_ = hz;
+        freqshifter_.SetShift(hz);
+    }
+
+    void SetBypassShift(bool bypass)
+    {
+        bypass_shift_ = bypass;
+        UpdateShiftBypass();
+    }
+
+    /// the shifter's bypass has faded in and its allpasses are skipped
+    bool IsShiftBypassed() const { return freqshifter_.IsBypassed(); }
+
+    // oversample the clipper (X1 = plain SoftClip)
+    void SetClipOversampling(Saturator::OVERSAMPLE os)
+    {
+        clip_os_ = os;
+        clip_.SetOversampling(os);
+    }
+
+  private:
+    // only the switch bypasses: a shift swept through 0 Hz keeps running
+    // the allpasses (and the carrier), so the loop never steps there
+    void UpdateShiftBypass() { freqshifter_.SetBypass(bypass_shift_); }
+
+    FrequencyShifter freqshifter_;
+    float            shift_hz_     = 0.f;
+    bool             bypass_shift_ = false;
+
+    Saturator             clip_;
+    Saturator::OVERSAMPLE clip_os_ = Saturator::OVERSAMPLE::X1;
+
+    Svf lopass_; // Low-pass filter for feedback smoothing
+    Svf hipass_; // High-pass filter for feedback smoothing
+};
+} // namespace daisysp
+
+#endif // CENOTE_FEEDBACK_CHAIN_H
@@ -0,0 +1,216 @@
+#pragma once
+
+#ifndef CENOTE_MULTITAP_DELAY_H
+#define CENOTE_MULTITAP_DELAY_H
+
+#include <cmath>
+#include <cstddef>
+#include "daisysp.h"
+#include "extdelayline.h"
+#include "paramramp.h"
+#include "feedback_chain.h"
+
+namespace daisysp
+{
+/**
+   Cenote's delay with up to MaxTaps read taps on one line. Every tap has
+   its own time, gain and pan; they share the write head, the buffer and
+   one feedback chain, which runs once on the gain-weighted sum of the
+   taps. An extra tap costs one interpolated read (plus three
+   multiply-adds for feedback and the stereo mix) per sample.
+
+   Output is wet only, stereo.
+*/
+template <size_t MaxTaps>
+class MultiTapDelayEngine
+{
+  public:
+    MultiTapDelayEngine() {}
+    ~MultiTapDelayEngine() {}
+
+    /// buf/buf_size/max_delay_ms: as CenoteDelayEngine::Init
+    void Init(float sample_rate, float* buf, size_t buf_size, float max_delay_ms)
+    {
+        sample_rate_ = sample_rate;
+
+        size_t size = ExtDelayLine<float>::SizeFor(sample_rate_, max_delay_ms);
+        del_.Init(buf, size < buf_size ? size : buf_size);
+        max_delay_samps_ = (float)(del_.GetSize() - 2);
+
+        chain_.Init(sample_rate_);
+        feedback_ = 0.2f;
+
+        num_taps_ = 1;
+        for(size_t t = 0; t < MaxTaps; t++)
+        {
+            // same glide as CenoteDelayEngine's delay time
+            taps_[t].delay.Init(sample_rate_, 0.f, ParamRamp::MODE::EXPONENTIAL, 0.f);
+            taps_[t].delay.SetCoefficient(0.00007f);
+            taps_[t].delay.SetSnap(0.01f);
+            SetTapTime(t, 250.f * (t + 1));
+            SetTapGain(t, 1.f);
+            SetTapPan(t, 0.f);
+        }
+    }
+
+    void SetNumTaps(size_t n) { num_taps_ = n < MaxTaps ? n : MaxTaps; }
+
+    size_t GetNumTaps() const { return num_taps_; }
+
+    void SetTapTime(size_t tap, float ms)
+    {
+        if(tap >= MaxTaps)
+            return;
+        ms = fmax(0.1f, ms);
+        taps_[tap].delay.SetTarget(fmin(ms * 0.001f * sample_rate_, max_delay_samps_));
+    }
+
+    /// also how much of this tap goes back into the line
+    void SetTapGain(size_t tap, float gain)
+    {
+        if(tap >= MaxTaps)
+            return;
+        taps_[tap].gain = gain;
+        UpdatePanGains(tap);
+    }
+
+    /// -1 (left) .. 1 (right), constant power
+    void SetTapPan(size_t tap, float pan)
+    {
+        if(tap >= MaxTaps)
+            return;
+        taps_[tap].pan = fclamp(pan, -1.f, 1.f);
+        UpdatePanGains(tap);
+    }
+
+    void SetFeedback(float feedback) { feedback_ = fclamp(feedback, 0.0f, 1.0f); }
+
+    void SetTransposition(float hz) { chain_.SetShift(hz); }
+
+    void SetBypassFrequencyShift(bool bypass) { chain_.SetBypassShift(bypass); }
+
+    void SetClipOversampling(Saturator::OVERSAMPLE os)
+    {
+        chain_.SetClipOversampling(os);
+    }
+
+    float GetMaxDelayMs() const
+    {
+        return (max_delay_samps_ / sample_rate_) * 1000.0f;
+    }
+
+    void ProcessBlock(const float* in,
+                      float*       out_l,
+                      float*       out_r,
+                      size_t       size,
+                      bool         limit = false)
+    {
+        while(size > 0)
+        {
+            const size_t n = size < kMaxBlock ? size : kMaxBlock;
+            ProcessChunk(in, out_l, out_r, n, limit);
+            in += n;
+            out_l += n;
+            out_r += n;
+            size -= n;
+        }
+    }
+
+  private:
+    struct Tap
+    {
+        ParamRamp delay; // samples
+        float     gain;
+        float     pan;
+        float     gain_l, gain_r;
+    };
+
+    void UpdatePanGains(size_t tap)
+    {
+        Tap&        t     = taps_[tap];
+        const float theta = (t.pan + 1.f) * 0.25f * (float)M_PI;
+        t.gain_l          = t.gain * cosf(theta);
+        t.gain_r          = t.gain * sinf(theta);
+    }
+
+    void ProcessChunk(const float* in, float* out_l, float* out_r, size_t size, bool limit)
+    {
+        // each tap's delay: where it starts and its per-sample step
+        float start[MaxTaps], step[MaxTaps];
+        float shortest = max_delay_samps_;
+        for(size_t t = 0; t < num_taps_; t++)
+        {
+            ParamRamp& delay = taps_[t].delay;
+            shortest         = fmin(shortest, fmin(delay.Value(), delay.GetTarget()));
+            start[t]         = delay.Value();
+            step[t]          = delay.NextBlock(size);
+        }
+
+        float fb[kMaxBlock], left[kMaxBlock], right[kMaxBlock];
+        for(size_t i = 0; i < size; i++)
+            fb[i] = left[i] = right[i] = 0.f;
+
+        if(shortest >= (float)(size + 1))
+        {
+            // all reads first (sample i reads i closer, see
+            // CenoteDelayEngine::ProcessBlock), tap by tap
+            for(size_t t = 0; t < num_taps_; t++)
+            {
+                const Tap& tap = taps_[t];
+                float      d   = start[t];
+                for(size_t i = 0; i < size; i++)
+                {
+                    d += step[t];
+                    const float v = del_.Read(d - (float)i);
+                    fb[i] += v * tap.gain;
+                    left[i] += v * tap.gain_l;
+                    right[i] += v * tap.gain_r;
+                }
+            }
+
+            // feedback chain once, on the sum
+            for(size_t i = 0; i < size; i++)
+                fb[i] = in[i] + fb[i] * feedback_;
+            chain_.ProcessBlock(fb, size, limit);
+            for(size_t i = 0; i < size; i++)
+                del_.Write(fb[i]);
+        }
+        else
+        {
+            // a tap is shorter than the block: read/write sample by sample
+            for(size_t i = 0; i < size; i++)
+            {
+                for(size_t t = 0; t < num_taps_; t++)
+                {
+                    const Tap&  tap = taps_[t];
+                    const float v   = del_.Read(start[t] + step[t] * (float)(i + 1));
+                    fb[i] += v * tap.gain;
+                    left[i] += v * tap.gain_l;
+                    right[i] += v * tap.gain_r;
+                }
+                del_.Write(chain_.Process(in[i] + fb[i] * feedback_, limit));
+            }
+        }
+
+        for(size_t i = 0; i < size; i++)
+        {
+            out_l[i] = left[i];
+            out_r[i] = right[i];
+        }
+    }
+
+    static constexpr size_t kMaxBlock = 48;
+
+    float sample_rate_;
+    float max_delay_samps_;
+
+    ExtDelayLine<float> del_;
+    CenoteFeedbackChain chain_;
+    float               feedback_;
+
+    Tap    taps_[MaxTaps];
+    size_t num_taps_;
+};
+} // namespace daisysp
+
+#endif // CENOTE_MULTITAP_DELAY_H
@@ -0,0 +1,198 @@
+// multitap_delay_test.cpp
+// Tap levels/pans of MultiTapDelayEngine, and what each extra tap costs.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../../flib -I../../DaisySP/Source multitap_delay_test.cpp
+//       ../../DaisySP/build/libdaisysp.a -o multitap_delay_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "cenote_delay.h"
+#include "multitap_delay.h"
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr      = 48000.f;
+static constexpr size_t kBufSize = 48000 * 2;
+static constexpr size_t kSettle  = 48000 * 3; // let the tap glides settle
+static constexpr size_t kBurst   = 480;       // 10 ms
+static constexpr size_t kBlock   = 4;
+
+static float buf[kBufSize];
+
+// magnitude of a single DFT bin (Goertzel) at `hz` over x[start, start + n)
+double goertzel(const std::vector<float>& x, size_t start, size_t n, double hz)
+{
+    double w = 2.0 * M_PI * hz / kSr;
+    double k = 2.0 * std::cos(w);
+    double s1 = 0.0, s2 = 0.0;
+    for (size_t i = start; i < start + n; i++) {
+        double s0 = x[i] + k * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    double re = s1 - s2 * std::cos(w);
+    double im = s2 * std::sin(w);
+    return std::sqrt(re * re + im * im) / n;
+}
+
+// Test 1: a 1 kHz burst comes out of each tap at its time, gain and pan
+// (no feedback). The loop's filters take ~0.25 dB off 1 kHz, so tap gains
+// are checked against tap 0.
+void test_taps()
+{
+    std::cout << "\n== Test 1: tap time, gain and pan ==\n";
+    const float ms[]   = {100.f, 220.f, 370.f};
+    const float gain[] = {1.f, 0.5f, 0.25f};
+    const float pan[]  = {-1.f, 0.f, 0.6f};
+
+    MultiTapDelayEngine<8> del;
+    del.Init(kSr, buf, kBufSize, 1000.f);
+    del.SetNumTaps(3);
+    del.SetFeedback(0.f);
+    for (size_t t = 0; t < 3; t++) {
+        del.SetTapTime(t, ms[t]);
+        del.SetTapGain(t, gain[t]);
+        del.SetTapPan(t, pan[t]);
+    }
+
+    const size_t len = kSettle + 48000 / 2;
+    std::vector<float> in(len, 0.f), l(len), r(len);
+    for (size_t i = 0; i < kBurst; i++)
+        in[kSettle + i] = 0.1f * (float)std::sin(2.0 * M_PI * 1000.0 * i / kSr);
+    for (size_t i = 0; i < len; i += kBlock)
+        del.ProcessBlock(&in[i], &l[i], &r[i], kBlock);
+
+    const double ref = goertzel(in, kSettle, kBurst, 1000.0);
+    double level0 = 0.0;
+    for (size_t t = 0; t < 3; t++) {
+        // the burst, plus a little for the loop filters' delay
+        const size_t start = kSettle + (size_t)(ms[t] * 0.001f * kSr) + 48;
+        const double a_l   = goertzel(l, start, kBurst - 96, 1000.0);
+        const double a_r   = goertzel(r, start, kBurst - 96, 1000.0);
+        const double level = 20.0 * std::log10(std::sqrt(a_l * a_l + a_r * a_r) / ref);
+        const double want  = 20.0 * std::log10(gain[t] / gain[0]);
+        const double theta = (pan[t] + 1.0) * 0.25 * M_PI;
+        const double angle = std::atan2(a_r, a_l);
+        char msg[96];
+        if (t == 0) {
+            level0 = level;
+            std::snprintf(msg, sizeof(msg), "tap 0 @ %3.0f ms: %6.2f dB", ms[t], level);
+            CHECK(std::fabs(level) < 0.5, msg);
+        } else {
+            std::snprintf(msg, sizeof(msg), "tap %zu @ %3.0f ms: %6.2f dB re tap 0 (want %6.2f)", t, ms[t],
+                          level - level0, want);
+            CHECK(std::fabs(level - level0 - want) < 0.1, msg);
+        }
+        std::snprintf(msg, sizeof(msg), "tap %zu pan angle %.3f (want %.3f)", t, angle, theta);
+        CHECK(std::fabs(angle - theta) < 0.02, msg);
+    }
+
+    // nothing between the taps
+    const size_t gap = kSettle + (size_t)(0.3f * kSr);
+    const double a   = goertzel(l, gap, kBurst, 1000.0) + goertzel(r, gap, kBurst, 1000.0);
+    CHECK(20.0 * std::log10(a / ref) < -60.0, "silence between taps");
+}
+
+// noise through `taps` taps at block size kBlock, ns per sample
+double tap_cost(size_t taps)
+{
+    MultiTapDelayEngine<8> del;
+    del.Init(kSr, buf, kBufSize, 1000.f);
+    del.SetNumTaps(taps);
+    del.SetFeedback(0.6f);
+    del.SetTransposition(15.f);
+    for (size_t t = 0; t < taps; t++) {
+        del.SetTapTime(t, 90.f * (t + 1));
+        del.SetTapGain(t, 1.f / taps);
+        del.SetTapPan(t, -1.f + 2.f * t / 7.f);
+    }
+
+    const size_t len = 48000 * 5;
+    float in[kBlock], l[kBlock], r[kBlock];
+    uint32_t seed = 1;
+    float acc = 0.f;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < len; i += kBlock) {
+        for (size_t j = 0; j < kBlock; j++) {
+            seed = seed * 1664525u + 1013904223u;
+            in[j] = 0.25f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+        }
+        del.ProcessBlock(in, l, r, kBlock);
+        acc += l[0] + r[kBlock - 1];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    volatile float sink = acc;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / len;
+}
+
+// Test 2: every tap after the first costs one read (and its mix), far less
+// than another delay engine would
+void test_cost()
+{
+    std::cout << "\n== Test 2: cost per tap (block " << kBlock << ") ==\n";
+
+    // one plain CenoteDelayEngine for scale
+    double engine_ns;
+    {
+        CenoteDelayEngine del;
+        del.Init(kSr, buf, kBufSize, 1000.f);
+        del.SetDelayMs(90.f);
+        del.SetFeedback(0.6f);
+        del.SetTransposition(15.f);
+        const size_t len = 48000 * 5;
+        float in[kBlock], out[kBlock];
+        float acc = 0.f;
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < len; i += kBlock) {
+            for (size_t j = 0; j < kBlock; j++)
+                in[j] = 0.1f * (float)(((i + j) * 7919) % 101) / 101.f;
+            del.ProcessBlock(in, out, kBlock);
+            acc += out[0];
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        volatile float sink = acc;
+        (void)sink;
+        engine_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / len;
+    }
+
+    // best of three, the host's timing is noisy
+    double ns[9];
+    for (size_t n = 1; n <= 8; n++)
+        ns[n] = std::min(tap_cost(n), std::min(tap_cost(n), tap_cost(n)));
+
+    std::printf("CenoteDelayEngine: %6.2f ns/sample\n", engine_ns);
+    for (size_t n = 1; n <= 8; n++)
+        std::printf("%zu tap%s:            %6.2f ns/sample (+%5.2f)\n", n, n > 1 ? "s" : " ",
+                    ns[n], n > 1 ? ns[n] - ns[n - 1] : 0.0);
+    const double per_tap = (ns[8] - ns[1]) / 7.0;
+    std::printf("per extra tap:     %6.2f ns/sample (%.0f%% of one engine)\n", per_tap,
+                100.0 * per_tap / engine_ns);
+
+    std::printf("memory: %zu taps share one %zu-sample line, %zu bytes of state for 8 taps vs %zu for 1\n",
+                (size_t)8, kBufSize, sizeof(MultiTapDelayEngine<8>), sizeof(MultiTapDelayEngine<1>));
+
+    CHECK(per_tap < 0.5 * engine_ns, "an extra tap costs under half a delay engine");
+}
+
+int main()
+{
+    std::cout << "Running multi-tap delay tests...\n";
+    test_taps();
+    test_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
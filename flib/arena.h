@@ -0,0 +1,335 @@
+#pragma once
+#ifndef HUGO_LIB_ARENA_H
+#define HUGO_LIB_ARENA_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace daisysp
+{
+
+/**
+   @brief A pool of equal-sized sample chunks carved out of one block of
+          memory (SDRAM), shared by whatever grows into it.
+
+   Every chunk is the same size, so any free chunk serves any request:
+   the pool never fragments, and Alloc()/Free() are a push/pop on a free
+   list. Chunk sizes are a power of two frames so ChunkedBuffer can find
+   a frame with a shift and a mask.
+*/
+class ChunkArena
+{
+  public:
+    ChunkArena() {}
+    ~ChunkArena() {}
+
+    /**
+       mem: the pool (not cleared: ChunkedBuffer zeroes what it writes).
+       chunk_frames_log2: chunk size,
+       2^n frames of `chans` floats. free_list: room for one index per
+       chunk (size / chunk size of them).
+    */
+    void Init(float*    mem,
+              size_t    size,
+              size_t    chunk_frames_log2,
+              size_t    chans,
+              uint16_t* free_list,
+              size_t    free_list_size)
+    {
+        mem_         = mem;
+        chunk_log2_  = chunk_frames_log2;
+        chans_       = chans;
+        chunk_size_  = ((size_t)1 << chunk_log2_) * chans_;
+        num_chunks_  = size / chunk_size_;
+        if(num_chunks_ > free_list_size)
+            num_chunks_ = free_list_size;
+        free_list_   = free_list;
+
+        // hand out low addresses first
+        num_free_ = num_chunks_;
+        for(size_t i = 0; i < num_chunks_; i++)
+            free_list_[i] = (uint16_t)(num_chunks_ - 1 - i);
+    }
+
+    /// a free chunk, or nullptr when the pool is used up
+    inline float* Alloc()
+    {
+        if(num_free_ == 0)
+            return nullptr;
+        return mem_ + free_list_[--num_free_] * chunk_size_;
+    }
+
+    inline void Free(float* chunk)
+    {
+        free_list_[num_free_++] = (uint16_t)((chunk - mem_) / chunk_size_);
+    }
+
+    size_t GetChunkFramesLog2() const { return chunk_log2_; }
+    size_t GetChunkFrames() const { return (size_t)1 << chunk_log2_; }
+    size_t GetChans() const { return chans_; }
+    size_t GetNumChunks() const { return num_chunks_; }
+    size_t GetNumFree() const { return num_free_; }
+
+  private:
+    float*    mem_        = nullptr;
+    size_t    chunk_log2_ = 0;
+    size_t    chans_      = 1;
+    size_t    chunk_size_ = 0; // floats
+    size_t    num_chunks_ = 0;
+    uint16_t* free_list_  = nullptr;
+    size_t    num_free_   = 0;
+};
+
+/**
+   @brief A buffer of interleaved frames that grows chunk by chunk out of a
+          ChunkArena and hands its chunks back on Release().
+
+   Read()/Write() take a float index (frame * chans + chan), like a flat
+   buffer (chans must be a power of two). Reads past the allocated chunks
+   return 0 and writes there are dropped, so a reader running off the end
+   is harmless.
+
+   Chunks come back from the arena holding whatever was there, so each
+   chunk keeps a watermark of how far into it has been written: reads
+   above it return 0, and a write above it zeroes the gap first (none, for
+   a recording moving forward). A write never zeroes more than its own
+   chunk, however far it jumps. Release() needs no clearing.
+*/
+template <size_t MaxChunks>
+class ChunkedBuffer
+{
+  public:
+    ChunkedBuffer() {}
+    ~ChunkedBuffer() {}
+
+    /// every frame is in RAM: any of them can be read or written any time
+    static constexpr bool kInMemory = true;
+
+    void Init(ChunkArena* arena)
+    {
+        arena_      = arena;
+        shift_      = arena_->GetChunkFramesLog2();
+        size_log2_  = shift_;
+        while(((size_t)1 << (size_log2_ - shift_)) < arena_->GetChans())
+            size_log2_++;
+        mask_       = ((size_t)1 << size_log2_) - 1;
+        num_chunks_ = 0;
+    }
+
+    /// make sure frames [0, frames) are backed; false if the pool ran out
+    bool Reserve(size_t frames)
+    {
+        while(GetCapacityFrames() < frames)
+        {
+            if(num_chunks_ >= MaxChunks)
+                return false;
+            float* chunk = arena_->Alloc();
+            if(chunk == nullptr)
+                return false;
+            fill_[num_chunks_]     = 0;
+            chunks_[num_chunks_++] = chunk;
+        }
+        return true;
+    }
+
+    /// give every chunk back to the pool
+    void Release()
+    {
+        while(num_chunks_ > 0)
+            arena_->Free(chunks_[--num_chunks_]);
+    }
+
+    /**
+       trade chunks, and everything written in them, with another buffer
+       on the same arena: a few pointers each, nothing copied
+    */
+    void Swap(ChunkedBuffer& other)
+    {
+        // swap what both hold, then move the longer one's rest across
+        // (never reading a slot either side hasn't filled)
+        const bool   mine = num_chunks_ > other.num_chunks_;
+        const size_t lo   = mine ? other.num_chunks_ : num_chunks_;
+        const size_t hi   = mine ? num_chunks_ : other.num_chunks_;
+        for(size_t c = 0; c < lo; c++)
+        {
+            float* chunk     = chunks_[c];
+            chunks_[c]       = other.chunks_[c];
+            other.chunks_[c] = chunk;
+            const uint32_t fill = fill_[c];
+            fill_[c]            = other.fill_[c];
+            other.fill_[c]      = fill;
+        }
+        for(size_t c = lo; c < hi; c++)
+        {
+            if(mine)
+            {
+                other.chunks_[c] = chunks_[c];
+                other.fill_[c]   = fill_[c];
+            }
+            else
+            {
+                chunks_[c] = other.chunks_[c];
+                fill_[c]   = other.fill_[c];
+            }
+        }
+        const size_t num  = num_chunks_;
+        num_chunks_       = other.num_chunks_;
+        other.num_chunks_ = num;
+    }
+
+    size_t GetCapacityFrames() const { return num_chunks_ << shift_; }
+
+    /// the most frames this buffer could ever hold
+    size_t GetMaxFrames() const { return MaxChunks << shift_; }
+
+    size_t GetNumChunks() const { return num_chunks_; }
+
+    inline float Read(size_t i) const
+    {
+        const size_t c = i >> size_log2_;
+        return c < num_chunks_ && (i & mask_) < fill_[c] ? chunks_[c][i & mask_] : 0.f;
+    }
+
+    inline float& Write(size_t i)
+    {
+        const size_t c = i >> size_log2_;
+        if(c >= num_chunks_)
+            return sink_;
+        const size_t off = i & mask_;
+        if(off >= fill_[c])
+            ZeroTo(c, off + 1);
+        return chunks_[c][off];
+    }
+
+    /// copy n floats from i on out to dst (silence above the watermarks)
+    void ReadSpan(size_t i, float* dst, size_t n) const
+    {
+        while(n > 0)
+        {
+            const size_t c   = i >> size_log2_;
+            const size_t off = i & mask_;
+            const size_t len = n < mask_ + 1 - off ? n : mask_ + 1 - off;
+            if(c < num_chunks_ && off + len <= fill_[c])
+                memcpy(dst, chunks_[c] + off, len * sizeof(float));
+            else
+                for(size_t j = 0; j < len; j++)
+                    dst[j] = Read(i + j);
+            i += len;
+            dst += len;
+            n -= len;
+        }
+    }
+
+    /// copy n floats from src in at i on (dropped past the allocated chunks)
+    void WriteSpan(size_t i, const float* src, size_t n)
+    {
+        while(n > 0)
+        {
+            const size_t c   = i >> size_log2_;
+            const size_t off = i & mask_;
+            const size_t len = n < mask_ + 1 - off ? n : mask_ + 1 - off;
+            if(c >= num_chunks_)
+                return;
+            if(off > fill_[c])
+                ZeroTo(c, off);
+            memcpy(chunks_[c] + off, src, len * sizeof(float));
+            if(off + len > fill_[c])
+                fill_[c] = (uint32_t)(off + len);
+            i += len;
+            src += len;
+            n -= len;
+        }
+    }
+
+  private:
+    /// zero chunk c from its watermark up to `end` and move the watermark there
+    void ZeroTo(size_t c, size_t end)
+    {
+        memset(chunks_[c] + fill_[c], 0, (end - fill_[c]) * sizeof(float));
+        fill_[c] = (uint32_t)end;
+    }
+
+    ChunkArena* arena_ = nullptr;
+    size_t      shift_     = 0; // frames per chunk, log2
+    size_t      size_log2_ = 0; // floats per chunk, log2
+    size_t      mask_      = 0;
+    float*      chunks_[MaxChunks];
+    uint32_t    fill_[MaxChunks]; // each chunk's watermark, floats
+    size_t      num_chunks_ = 0;
+    float       sink_; // where writes past the end go
+};
+
+/**
+   @brief A flat buffer that is never cleared up front.
+
+   Like ChunkedBuffer it keeps watermarks of how far it has been written,
+   one per page (up to kMaxPages of them, as large as the buffer needs):
+   reads above a page's watermark return 0 and a write above it zeroes the
+   gap first, never more than its own page. Init() and Clear() cost a pass
+   over the watermarks however large the buffer is.
+*/
+class LazyBuffer
+{
+  public:
+    LazyBuffer() {}
+    ~LazyBuffer() {}
+
+    static constexpr size_t kMaxPages     = 256;
+    static constexpr size_t kMinPageLog2  = 8; // floats
+
+    /// mem: size floats, left as they are
+    void Init(float* mem, size_t size)
+    {
+        mem_   = mem;
+        size_  = size;
+        shift_ = kMinPageLog2;
+        while((size_ >> shift_) >= kMaxPages)
+            shift_++;
+        mask_ = ((size_t)1 << shift_) - 1;
+        Clear();
+    }
+
+    /// everything reads as silence again
+    void Clear()
+    {
+        for(size_t p = 0; p < kMaxPages; p++)
+            fill_[p] = 0;
+    }
+
+    size_t GetSize() const { return size_; }
+
+    /// floats a page holds (the most a write zeroes)
+    size_t GetPageSize() const { return mask_ + 1; }
+
+    inline float Read(size_t i) const
+    {
+        return i < size_ && (i & mask_) < fill_[i >> shift_] ? mem_[i] : 0.f;
+    }
+
+    inline float& Write(size_t i)
+    {
+        const size_t p   = i >> shift_;
+        const size_t off = i & mask_;
+        if(off >= fill_[p])
+        {
+            memset(mem_ + (p << shift_) + fill_[p], 0, (off + 1 - fill_[p]) * sizeof(float));
+            fill_[p] = (uint32_t)(off + 1);
+        }
+        return mem_[i];
+    }
+
+  private:
+    float*   mem_   = nullptr;
+    size_t   size_  = 0;
+    size_t   shift_ = kMinPageLog2; // floats per page, log2
+    size_t   mask_  = 0;
+    uint32_t fill_[kMaxPages]; // each page's watermark, floats
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_ARENA_H
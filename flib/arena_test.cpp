@@ -0,0 +1,333 @@
+// arena_test.cpp
+// ChunkArena / ChunkedBuffer: sharing, fragmentation under churn, swaps,
+// Ipoke/Ipeek on chunks vs a flat buffer, what allocation and chunked
+// access cost, and lazy zeroing (startup and clear without a memset).
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../DaisySP/Source arena_test.cpp
+//       ../DaisySP/build/libdaisysp.a -o arena_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include "arena.h"
+#include "ipoke.h"
+
+using namespace daisysp;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr size_t kLog2   = 14; // 16384-frame chunks, as wigglrs
+static constexpr size_t kFrames = 48000 * 120;
+static constexpr size_t kChunks = kFrames >> kLog2;
+
+static std::vector<float>    pool(kFrames);
+static std::vector<uint16_t> free_list(kChunks);
+
+using Buffer = ChunkedBuffer<512>;
+
+void init_arena(ChunkArena& arena)
+{
+    arena.Init(pool.data(), pool.size(), kLog2, 1, free_list.data(), free_list.size());
+}
+
+uint32_t rnd(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Test 1: two buffers share the pool: either can have all of it while the
+// other is empty, and after heavy churn by four buffers nothing is lost or
+// handed out twice, and one buffer can still take every chunk; two buffers
+// of different lengths swap chunks
+void test_sharing()
+{
+    std::cout << "\n== Test 1: sharing and fragmentation ==\n";
+    ChunkArena arena;
+    init_arena(arena);
+    Buffer a, b;
+    a.Init(&arena);
+    b.Init(&arena);
+
+    CHECK(!a.Reserve(kFrames + 1) && a.GetNumChunks() == kChunks, "one buffer takes the whole pool");
+    CHECK(!b.Reserve(1) && b.GetCapacityFrames() == 0, "the other gets nothing meanwhile");
+    a.Release();
+    CHECK(!b.Reserve(kFrames + 1) && b.GetNumChunks() == kChunks && arena.GetNumFree() == 0,
+          "released, all of it goes to the other");
+    b.Release();
+
+    Buffer bufs[4];
+    for (Buffer& x : bufs)
+        x.Init(&arena);
+    uint32_t seed = 3;
+    bool   balanced = true;
+    size_t refused  = 0;
+    for (size_t op = 0; op < 200000; op++) {
+        Buffer& x = bufs[rnd(seed) % 4];
+        if (rnd(seed) % 8 == 0)
+            x.Release();
+        else if (!x.Reserve(x.GetCapacityFrames() + 1 + rnd(seed) % (1 << (kLog2 + 6))))
+            refused++;
+        size_t held = 0;
+        for (Buffer& y : bufs)
+            held += y.GetNumChunks();
+        balanced = balanced && held + arena.GetNumFree() == kChunks;
+    }
+    CHECK(balanced, "200000 grow/release ops: held + free == pool throughout");
+    std::printf("(%zu grows refused when the pool was used up)\n", refused);
+
+    std::set<const float*> seen;
+    bool unique = true;
+    for (Buffer& y : bufs)
+        for (size_t c = 0; c < y.GetNumChunks(); c++) {
+            float& first = y.Write(c << kLog2);
+            unique = unique && seen.insert(&first).second;
+        }
+    CHECK(unique, "no chunk held twice");
+
+    for (Buffer& y : bufs)
+        y.Release();
+    CHECK(!a.Reserve(kFrames + 1) && a.GetNumChunks() == kChunks, "after churn one buffer still gets every chunk");
+    a.Release();
+
+    // a short buffer and a long one trade places, both ways round
+    a.Reserve(3 << kLog2);
+    b.Reserve(7 << kLog2);
+    a.Write(0) = 0.5f;
+    b.Write((6 << kLog2) + 1) = 0.25f;
+    a.Swap(b);
+    CHECK(a.GetNumChunks() == 7 && b.GetNumChunks() == 3 && a.Read((6 << kLog2) + 1) == 0.25f
+              && b.Read(0) == 0.5f,
+          "swapped: each holds the other's chunks and samples");
+    a.Swap(b);
+    CHECK(a.GetNumChunks() == 3 && b.GetNumChunks() == 7 && a.Read(0) == 0.5f
+              && b.Read((6 << kLog2) + 1) == 0.25f,
+          "and back");
+    a.Release();
+    b.Release();
+    CHECK(arena.GetNumFree() == kChunks, "every chunk back in the pool");
+}
+
+// Test 2: Ipoke/Ipeek write and read chunks exactly as a flat buffer
+void test_ipoke()
+{
+    std::cout << "\n== Test 2: Ipoke/Ipeek on chunks ==\n";
+    ChunkArena arena;
+    init_arena(arena);
+    const size_t frames = 48000 * 10;
+    Buffer chunked;
+    chunked.Init(&arena);
+    chunked.Reserve(frames);
+    std::vector<float> flat(frames, 0.f);
+
+    Ipoke                    pf;
+    IpokeT<StoreRef<Buffer>> pc;
+    Ipeek                    qf;
+    IpeekT<StoreRef<Buffer>> qc;
+    pf.Init(flat.data(), frames, 1);
+    pc.Init(&chunked, frames, 1);
+    qf.Init(flat.data(), frames, 1);
+    qc.Init(&chunked, frames, 1);
+
+    float pos = 0.f, worst = 0.f;
+    uint32_t seed = 9;
+    for (size_t i = 0; i < 48000 * 20; i++) {
+        const float in = (float)rnd(seed) / 16777216.f - 0.5f;
+        const float rate = i < 48000 * 10 ? 1.f : 1.37f; // a first pass, then overdubs
+        const float od = i < 48000 * 10 ? 0.f : 0.7f;
+        pf.SetOverdub(od);
+        pc.SetOverdub(od);
+        pf.Poke(pos, &in);
+        pc.Poke(pos, &in);
+        float a, b;
+        qf.Peek(pos * 0.9f, &a);
+        qc.Peek(pos * 0.9f, &b);
+        worst = std::fmax(worst, std::fabs(a - b));
+        pos += rate;
+        if (pos >= frames)
+            pos -= frames;
+    }
+    bool same = true;
+    for (size_t i = 0; i < frames; i++)
+        same = same && flat[i] == chunked.Read(i);
+    CHECK(same, "same buffer contents after a pass and overdubs");
+    CHECK(worst == 0.f, "same reads");
+    CHECK(chunked.Read(chunked.GetCapacityFrames()) == 0.f, "reads past the end are silent");
+}
+
+template <typename F>
+double ns_per(F&& run, size_t n)
+{
+    double best = 1e9;
+    for (int k = 0; k < 3; k++) { // best of three, the host's timing is noisy
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+    }
+    return best;
+}
+
+// Test 3: allocation is constant time, and a looper's reads (sequential,
+// at a rate) cost about the same from chunks as from a flat buffer
+void test_cost()
+{
+    std::cout << "\n== Test 3: cost ==\n";
+    ChunkArena arena;
+    init_arena(arena);
+    Buffer buf;
+    buf.Init(&arena);
+
+    const size_t rounds = 2000;
+    const double grow = ns_per([&] {
+        for (size_t r = 0; r < rounds; r++) {
+            buf.Reserve(kFrames);
+            buf.Release();
+        }
+    }, rounds * kChunks);
+    std::printf("alloc + free: %.2f ns per chunk\n", grow);
+    CHECK(grow < 50.0, "a chunk costs a few ns to take and give back");
+
+    buf.Reserve(kFrames);
+    buf.Write(kFrames - 1) = 0.f; // as if recorded: everything below the watermark
+    const size_t n = 1 << 22;
+    std::vector<float> flat(kFrames, 0.f);
+    std::vector<float> idx(n);
+    float pos = 0.5f;
+    for (size_t i = 0; i < n; i++) {
+        idx[i] = pos;
+        pos += 1.3f;
+        if (pos >= kFrames - 2)
+            pos = 0.5f;
+    }
+
+    Ipeek                    qf;
+    IpeekT<StoreRef<Buffer>> qc;
+    qf.Init(flat.data(), kFrames, 1);
+    qc.Init(&buf, kFrames, 1);
+    float acc = 0.f;
+    const double tf = ns_per([&] {
+        for (size_t i = 0; i < n; i++) {
+            float o;
+            qf.Peek(idx[i], &o);
+            acc += o;
+        }
+    }, n);
+    const double tc = ns_per([&] {
+        for (size_t i = 0; i < n; i++) {
+            float o;
+            qc.Peek(idx[i], &o);
+            acc += o;
+        }
+    }, n);
+    volatile float sink = acc;
+    (void)sink;
+    std::printf("Peek(): flat %.2f ns, chunked %.2f ns\n", tf, tc);
+    CHECK(tc < 1.5 * tf + 2.0, "chunked reads stay close to flat ones");
+}
+
+// Test 4: buffers aren't cleared up front: memory full of garbage reads as
+// silence until written, clearing is O(1), and starting the wigglrs' pool
+// and glitch's buffer costs nothing next to zeroing them
+void test_lazy()
+{
+    std::cout << "\n== Test 4: lazy zeroing ==\n";
+    std::fill(pool.begin(), pool.end(), 1.f); // whatever SDRAM held
+
+    ChunkArena arena;
+    init_arena(arena);
+    Buffer buf;
+    buf.Init(&arena);
+    buf.Reserve(48000);
+    bool silent = true;
+    for (size_t i = 0; i < 48000; i++)
+        silent = silent && buf.Read(i) == 0.f;
+    CHECK(silent, "a new buffer over garbage reads as silence");
+
+    for (size_t i = 0; i < 1000; i++)
+        buf.Write(i) += 0.5f; // a first pass, overdub-style
+    buf.Write(40000) = 0.25f;   // a jump (past a chunk boundary): the gap reads as zero
+    bool gap = true;
+    for (size_t i = 1000; i < 40000; i++)
+        gap = gap && buf.Read(i) == 0.f;
+    CHECK(buf.Read(999) == 0.5f && gap && buf.Read(40000) == 0.25f && buf.Read(40001) == 0.f,
+          "written floats read back, the rest is zero");
+    std::vector<float> span(3000);
+    buf.ReadSpan(0, span.data(), span.size());
+    CHECK(span[999] == 0.5f && span[1000] == 0.f && span[2999] == 0.f, "ReadSpan() reads the same");
+
+    // a jump far into a long buffer zeroes no more than the chunk it lands in
+    buf.Release();
+    std::fill(pool.begin(), pool.end(), 1.f);
+    const size_t end = kChunks << kLog2;
+    CHECK(buf.Reserve(end), "the whole pool");
+    buf.Write(0) = 0.5f;
+    buf.Write(end - 100) = 0.25f; // 2 minutes on
+    size_t touched = 0;
+    for (float v : pool)
+        touched += v != 1.f;
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "a jump over %zu frames zeroes %zu floats (a chunk: %zu)",
+                  end, touched, arena.GetChunkFrames());
+    CHECK(touched <= arena.GetChunkFrames() + 1, msg);
+    CHECK(buf.Read(end / 2) == 0.f && buf.Read(end - 100) == 0.25f, "and the gap reads as zero");
+
+    buf.Release();
+    buf.Reserve(48000); // the same chunks, old contents still in them
+    CHECK(buf.Read(0) == 0.f && buf.Read(40000) == 0.f, "released and re-reserved: silent again");
+    buf.Release();
+
+    std::vector<float> flat(48000 * 10, 1.f); // glitch's buffer
+    LazyBuffer lazy;
+    lazy.Init(flat.data(), flat.size());
+    lazy.Write(10) = 0.5f;
+    CHECK(lazy.Read(9) == 0.f && lazy.Read(10) == 0.5f && lazy.Read(11) == 0.f,
+          "LazyBuffer: zeroed up to the first write, silent above");
+    lazy.Clear();
+    CHECK(lazy.Read(10) == 0.f, "LazyBuffer: Clear() silences it");
+    lazy.Write(flat.size() - 1) = 0.25f; // 10 s on
+    touched = 0;
+    for (float v : flat)
+        touched += v != 1.f;
+    std::snprintf(msg, sizeof(msg), "LazyBuffer: a jump to the end zeroes %zu floats (a page: %zu)",
+                  touched, lazy.GetPageSize());
+    CHECK(touched <= lazy.GetPageSize() + 11 && lazy.Read(flat.size() / 2) == 0.f, msg);
+
+    // startup: both pedals' buffers, then as they used to be (zeroed)
+    std::vector<float> wig(48000 * 120 * 2); // the old pair of 60 s wigglr buffers
+    const double t_lazy = ns_per([&] {
+        init_arena(arena);
+        buf.Init(&arena);
+        lazy.Init(flat.data(), flat.size());
+    }, 1);
+    const double t_fill = ns_per([&] {
+        std::fill(wig.begin(), wig.end(), 0.f);
+        std::fill(flat.begin(), flat.end(), 0.f);
+    }, 1);
+    std::printf("startup: lazy %.1f us, zeroing %.1f us\n", t_lazy * 1e-3, t_fill * 1e-3);
+    CHECK(t_lazy * 100 < t_fill, "startup is over 100x faster than zeroing");
+}
+
+int main()
+{
+    std::cout << "Running arena tests...\n";
+    test_sharing();
+    test_ipoke();
+    test_cost();
+    test_lazy();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -0,0 +1,163 @@
+#pragma once
+#ifndef HUGO_LIB_BLOCKLIMITER_H
+#define HUGO_LIB_BLOCKLIMITER_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace daisysp
+{
+
+/**
+   @brief Peak limiter that decides its gain once per block.
+
+   The block's peak (plus `lookahead` samples still in the delay) is found
+   first, the gain recursion runs once, and the samples only get multiplied
+   by a flat gain or a linear ramp. Attack is instant, so the output never
+   goes over the threshold; release is a one-pole towards unity.
+
+   Without lookahead a falling gain is applied flat across the block (the
+   peak is already known, but the gain steps at the block edge). With
+   lookahead >= block size the gain ramps into the peak instead, at the
+   cost of `lookahead` samples of latency.
+*/
+class BlockLimiter
+{
+  public:
+    BlockLimiter() {}
+    ~BlockLimiter() {}
+
+    static constexpr size_t kMaxLookahead = 64;
+    static constexpr size_t kMaxBlock     = 64;
+
+    void Init(float  sample_rate,
+              float  threshold  = 1.0f,
+              float  release_ms = 100.0f,
+              size_t lookahead  = 0)
+    {
+        sample_rate_ = sample_rate;
+        threshold_   = threshold;
+        gain_        = 1.0f;
+        SetReleaseMs(release_ms);
+        SetLookahead(lookahead);
+    }
+
+    void SetThreshold(float threshold) { threshold_ = threshold; }
+
+    void SetReleaseMs(float release_ms)
+    {
+        release_samps_ = fmaxf(1.0f, release_ms * 0.001f * sample_rate_);
+        coef_size_     = 0; // recompute on next block
+    }
+
+    /// Changing the lookahead clears the delay
+    void SetLookahead(size_t samples)
+    {
+        lookahead_ = samples < kMaxLookahead ? samples : kMaxLookahead;
+        std::memset(delay_, 0, sizeof(delay_));
+    }
+
+    /// latency in samples (= lookahead)
+    size_t GetLatency() const { return lookahead_; }
+
+    /// current gain (without pre_gain)
+    float GetGain() const { return gain_; }
+
+    /// In place. pre_gain is applied before limiting, like daisysp::Limiter.
+    void ProcessBlock(float* buf, size_t size, float pre_gain = 1.0f)
+    {
+        while(size > 0)
+        {
+            const size_t n = size < kMaxBlock ? size : kMaxBlock;
+            if(lookahead_ == 0)
+            {
+                Apply(buf, n, PeakAbs(buf, n) * pre_gain, pre_gain);
+            }
+            else
+            {
+                // delay_[0, lookahead) holds the tail of the last block
+                std::memcpy(&delay_[lookahead_], buf, n * sizeof(float));
+                const float peak = PeakAbs(delay_, lookahead_ + n) * pre_gain;
+                std::memcpy(buf, delay_, n * sizeof(float));
+                std::memmove(delay_, &delay_[n], lookahead_ * sizeof(float));
+                Apply(buf, n, peak, pre_gain);
+            }
+            buf += n;
+            size -= n;
+        }
+    }
+
+  private:
+    // max |x|, four independent accumulators so the compares pipeline
+    static inline float PeakAbs(const float* x, size_t size)
+    {
+        float m0 = 0.f, m1 = 0.f, m2 = 0.f, m3 = 0.f;
+        size_t i = 0;
+        for(; i + 4 <= size; i += 4)
+        {
+            m0 = Max(m0, fabsf(x[i]));
+            m1 = Max(m1, fabsf(x[i + 1]));
+            m2 = Max(m2, fabsf(x[i + 2]));
+            m3 = Max(m3, fabsf(x[i + 3]));
+        }
+        for(; i < size; i++)
+            m0 = Max(m0, fabsf(x[i]));
+        return Max(Max(m0, m1), Max(m2, m3));
+    }
+
+    // plain compare, no NaN handling (fmaxf is a libcall on some targets)
+    static inline float Max(float a, float b) { return a > b ? a : b; }
+
+    inline void Apply(float* buf, size_t size, float peak, float pre_gain)
+    {
+        const float target = peak > threshold_ ? threshold_ / peak : 1.0f;
+        const float g0     = gain_;
+
+        if(target < g0)
+        {
+            gain_ = target;
+            if(lookahead_ < size)
+            {
+                const float g = gain_ * pre_gain;
+                for(size_t i = 0; i < size; i++)
+                    buf[i] *= g;
+                return;
+            }
+        }
+        else
+        {
+            if(size != coef_size_)
+            {
+                coef_size_    = size;
+                release_coef_ = 1.0f - expf(-(float)size / release_samps_);
+            }
+            gain_ = g0 + (target - g0) * release_coef_;
+        }
+
+        // ramp from the last block's gain to the new one
+        const float step = (gain_ - g0) * pre_gain / (float)size;
+        float       g    = g0 * pre_gain;
+        for(size_t i = 0; i < size; i++)
+        {
+            g += step;
+            buf[i] *= g;
+        }
+    }
+
+    float  sample_rate_;
+    float  threshold_;
+    float  gain_;
+    float  release_samps_;
+    float  release_coef_;
+    size_t coef_size_;
+    size_t lookahead_;
+    float  delay_[kMaxLookahead + kMaxBlock];
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_BLOCKLIMITER_H
@@ -0,0 +1,172 @@
+// blocklimiter_test.cpp
+// build: g++ -O2 -std=c++14 blocklimiter_test.cpp -o blocklimiter_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "blocklimiter.h"
+
+using daisysp::BlockLimiter;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr  = 48000.f;
+static constexpr size_t kLen = 48000;
+
+// sine bursts: 100 ms at `amp`, 100 ms at amp / 10, repeating
+std::vector<float> bursts(double hz, float amp, size_t n)
+{
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) {
+        float a = ((i / 4800) % 2 == 0) ? amp : amp * 0.1f;
+        x[i] = a * (float)std::sin(2.0 * M_PI * hz * i / kSr);
+    }
+    return x;
+}
+
+void run(BlockLimiter& lim, std::vector<float>& x, size_t block, float pre_gain = 1.0f)
+{
+    for (size_t i = 0; i < x.size(); i += block)
+        lim.ProcessBlock(&x[i], std::min(block, x.size() - i), pre_gain);
+}
+
+// Test 1: the output never goes over the threshold, any block size,
+// with and without lookahead.
+void test_ceiling()
+{
+    std::cout << "\n== Test 1: ceiling ==\n";
+    const size_t blocks[]     = {1, 2, 4, 48};
+    const size_t lookaheads[] = {0, 4, 64};
+    for (size_t la : lookaheads) {
+        for (size_t b : blocks) {
+            std::vector<float> x = bursts(1000.0, 3.0f, kLen);
+            BlockLimiter lim;
+            lim.Init(kSr, 0.7f, 50.0f, la);
+            run(lim, x, b, 0.7f);
+            float peak = 0.f;
+            for (float v : x)
+                peak = std::max(peak, std::fabs(v));
+            char msg[96];
+            std::snprintf(msg, sizeof(msg), "lookahead=%2zu block=%2zu: peak %.6f (threshold 0.7)", la, b, peak);
+            CHECK(peak <= 0.7f * (1.0f + 1e-6f), msg);
+        }
+    }
+}
+
+// Test 2: steady gain reduction matches threshold / level.
+void test_gain_accuracy()
+{
+    std::cout << "\n== Test 2: gain reduction accuracy ==\n";
+    const float levels[] = {1.5f, 3.0f, 10.0f};
+    for (float a : levels) {
+        std::vector<float> x(kLen);
+        for (size_t i = 0; i < kLen; i++)
+            x[i] = a * (float)std::sin(2.0 * M_PI * 997.0 * i / kSr);
+        BlockLimiter lim;
+        lim.Init(kSr, 1.0f, 100.0f, 0);
+        run(lim, x, 2);
+        double ideal_db = 20.0 * std::log10(1.0 / a);
+        double got_db   = 20.0 * std::log10(lim.GetGain());
+        char msg[96];
+        std::snprintf(msg, sizeof(msg), "level %4.1f: gain %.3f dB (ideal %.3f dB)", a, got_db, ideal_db);
+        CHECK(std::fabs(got_db - ideal_db) < 0.05, msg);
+    }
+}
+
+// Test 3: after the loud part stops, the gain recovers with the release
+// time constant (63% of the way back after release_ms).
+void test_release()
+{
+    std::cout << "\n== Test 3: release ==\n";
+    const float release_ms = 100.0f;
+    BlockLimiter lim;
+    lim.Init(kSr, 1.0f, release_ms, 0);
+    std::vector<float> loud(4800, 4.0f), quiet((size_t)(release_ms * 48), 0.1f);
+    run(lim, loud, 2);
+    const float g0 = lim.GetGain();
+    run(lim, quiet, 2);
+    const float recovered = (lim.GetGain() - g0) / (1.0f - g0);
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "recovered %.3f after %.0f ms (expect 0.632)", recovered, release_ms);
+    CHECK(std::fabs(recovered - 0.632f) < 0.01f, msg);
+}
+
+// daisysp::Limiter's per-sample loop, for the cost comparison
+#define SLOPE(out, in, positive, negative)                  \
+    {                                                       \
+        float error = (in)-out;                             \
+        out += (error > 0 ? positive : negative) * error;   \
+    }
+struct RefLimiter
+{
+    float peak_ = 0.5f, gain_ = 1.0f;
+    void ProcessBlock(float* in, size_t size, float pre_gain)
+    {
+        while (size--) {
+            float pre  = *in * pre_gain;
+            float peak = std::fabs(pre);
+            SLOPE(peak_, peak, 0.05f, 0.00002f);
+            float gain = (peak_ > 1.0f ? 1.0f / peak_ : 1.0f);
+            SLOPE(gain_, gain, 0.1f, 0.05f);
+            float x = gain_ * pre * 0.7f;
+            *in = x * (27.f + x * x) / (27.f + 9.f * x * x);
+            in++;
+        }
+    }
+};
+
+// Test 4: cost per sample, called once per sample (as glitch did) vs
+// once per block of 4.
+void test_cost()
+{
+    std::cout << "\n== Test 4: cost per sample ==\n";
+    std::vector<float> src = bursts(1000.0, 3.0f, kLen), x;
+    const int reps = 20;
+
+    RefLimiter ref;
+    x = src;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++)
+        for (size_t i = 0; i < kLen; i++)
+            ref.ProcessBlock(&x[i], 1, 1.0f);
+    auto t1 = std::chrono::steady_clock::now();
+    volatile float sink = x[kLen / 2];
+
+    BlockLimiter lim;
+    lim.Init(kSr, 0.7f, 100.0f, 0);
+    x = src;
+    auto t2 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++)
+        run(lim, x, 4, 0.7f);
+    auto t3 = std::chrono::steady_clock::now();
+    sink = x[kLen / 2];
+    (void)sink;
+
+    double ns_ref = std::chrono::duration<double, std::nano>(t1 - t0).count() / (reps * kLen);
+    double ns_blk = std::chrono::duration<double, std::nano>(t3 - t2).count() / (reps * kLen);
+    std::printf("daisysp::Limiter, 1 sample/call: %6.2f ns/sample\n", ns_ref);
+    std::printf("BlockLimiter, block of 4:        %6.2f ns/sample (%.1fx)\n", ns_blk, ns_ref / ns_blk);
+    CHECK(ns_blk < ns_ref, "BlockLimiter is cheaper");
+}
+
+int main()
+{
+    std::cout << "Running blocklimiter tests...\n";
+    test_ceiling();
+    test_gain_accuracy();
+    test_release();
+    test_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#ifndef HUGO_LIB_BOUNCE_H
+#define HUGO_LIB_BOUNCE_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+
+namespace daisysp
+{
+
+/**
+   @brief Renders a loop into another buffer at a new length (a pitch
+          "bounced" in), a slice at a time, from the main loop.
+
+   Output frame n is the loop at n * src_frames / dst_frames, so the
+   bounced loop has a whole number of frames and loops where the original
+   did. Each frame is a windowed sinc (Blackman, 16 zero crossings either
+   side) whose cutoff drops with the ratio when the loop gets shorter, so
+   pitching up doesn't alias the way a linear read does. The taps wrap
+   round the loop, so its ends join as they played.
+
+   The sinc and the window are turned from phasors, so a frame costs a
+   few sinf/cosf and a multiply-add or two per tap: 32 taps a frame, more
+   the shorter the loop gets, about 32 taps per frame of the longer of the
+   two loops all told. Frames are taken from src by Read() and put in dst
+   by Write(); what owns the two buffers (and when it's safe to touch
+   them) is up to the caller.
+*/
+template <typename Buf>
+class LoopBounce
+{
+  public:
+    LoopBounce() {}
+    ~LoopBounce() {}
+
+    static constexpr size_t kHalfTaps = 16; // zero crossings either side
+
+    /// render src's first src_frames into dst's first dst_frames, chans each
+    void Begin(const Buf* src, size_t src_frames, Buf* dst, size_t dst_frames, size_t chans)
+    {
+        src_    = src;
+        dst_    = dst;
+        src_n_  = src_frames;
+        dst_n_  = dst_frames;
+        chans_  = chans < kMaxChans ? chans : kMaxChans;
+        step_   = (double)src_frames / (double)dst_frames;
+        cutoff_ = step_ > 1.0 ? (float)(1.0 / step_) : 1.f;
+        width_  = (long)ceilf((float)kHalfTaps / cutoff_);
+        done_   = 0;
+    }
+
+    /// render up to `frames` more; the number rendered
+    size_t Render(size_t frames)
+    {
+        size_t n = 0;
+        for(; n < frames && done_ < dst_n_; n++, done_++)
+            RenderFrame(done_);
+        return n;
+    }
+
+    bool   IsDone() const { return done_ >= dst_n_; }
+    size_t GetFrames() const { return dst_n_; }
+    size_t GetDone() const { return done_; }
+
+    /// 0 to 1
+    float GetProgress() const { return dst_n_ > 0 ? (float)done_ / (float)dst_n_ : 0.f; }
+
+  private:
+    static constexpr size_t kMaxChans = 2;
+
+    void RenderFrame(size_t n)
+    {
+        const float  pi = (float)M_PI;
+        const double t  = (double)n * step_;
+        const long   i0 = (long)t;
+        const float  x  = (float)(t - (double)i0);
+        const long   w  = width_;
+
+        // tap k is d = k - x frames from the output: the sinc's phase is
+        // pi * fc * d and the window's pi * d / w, both turned a step a tap
+        const float d0 = (float)(1 - w) - x;
+        float       s = sinf(pi * cutoff_ * d0), c = cosf(pi * cutoff_ * d0);
+        float       ws = sinf(pi * d0 / (float)w), wc = cosf(pi * d0 / (float)w);
+        const float rs = sinf(pi * cutoff_), rc = cosf(pi * cutoff_);
+        const float qs = sinf(pi / (float)w), qc = cosf(pi / (float)w);
+
+        long j = (i0 + 1 - w) % (long)src_n_;
+        j      = j < 0 ? j + (long)src_n_ : j;
+
+        float acc[kMaxChans] = {0.f, 0.f};
+        float gain           = 0.f;
+        for(long k = 1 - w; k <= w; k++)
+        {
+            const float d    = (float)k - x;
+            const float arg  = pi * cutoff_ * d;
+            const float sinc = fabsf(arg) < 1e-6f ? 1.f : s / arg;
+            const float win  = 0.42f + 0.5f * wc + 0.08f * (2.f * wc * wc - 1.f);
+            const float h    = sinc * win;
+            gain += h;
+            for(size_t ch = 0; ch < chans_; ch++)
+                acc[ch] += h * src_->Read((size_t)j * chans_ + ch);
+
+            j = j + 1 == (long)src_n_ ? 0 : j + 1; // round the loop
+            const float sn = s * rc + c * rs;
+            c              = c * rc - s * rs;
+            s              = sn;
+            const float wn = ws * qc + wc * qs;
+            wc             = wc * qc - ws * qs;
+            ws             = wn;
+        }
+        const float norm = gain != 0.f ? 1.f / gain : 0.f;
+        for(size_t ch = 0; ch < chans_; ch++)
+            dst_->Write(n * chans_ + ch) = acc[ch] * norm;
+    }
+
+    const Buf* src_    = nullptr;
+    Buf*       dst_    = nullptr;
+    size_t     src_n_  = 0;
+    size_t     dst_n_  = 0;
+    size_t     chans_  = 1;
+    double     step_   = 1.0; // source frames per output frame
+    float      cutoff_ = 1.f; // of the source's Nyquist
+    long       width_  = kHalfTaps; // taps either side, source frames
+    volatile size_t done_ = 0;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_BOUNCE_H
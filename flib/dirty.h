@@ -0,0 +1,125 @@
+#pragma once
+#ifndef HUGO_LIB_DIRTY_H
+#define HUGO_LIB_DIRTY_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+
+namespace daisysp
+{
+
+/**
+   @brief Counts the engine setter calls Dirty<> let through and the ones
+          it skipped (shared by any number of them).
+*/
+struct DirtyCounter
+{
+    uint32_t calls   = 0;
+    uint32_t skipped = 0;
+
+    void Reset() { calls = skipped = 0; }
+
+    /// fraction of setter calls avoided
+    float Saved() const
+    {
+        const uint32_t total = calls + skipped;
+        return total ? (float)skipped / total : 0.f;
+    }
+};
+
+/**
+   @brief A knob with hysteresis: holds its value until the input moves
+          more than `threshold` away, so ADC jitter doesn't count as a change.
+
+   The ends (0 and 1 for a normalised knob) are always reached.
+*/
+class Hysteresis
+{
+  public:
+    Hysteresis() {}
+    ~Hysteresis() {}
+
+    void Init(float threshold, float value = 0.f, float lo = 0.f, float hi = 1.f)
+    {
+        threshold_ = threshold;
+        value_     = value;
+        lo_        = lo;
+        hi_        = hi;
+    }
+
+    /// returns the held value
+    inline float Process(float in)
+    {
+        if(fabsf(in - value_) > threshold_
+           || (in != value_ && (in <= lo_ || in >= hi_)))
+            value_ = in;
+        return value_;
+    }
+
+    float Value() const { return value_; }
+
+  private:
+    float threshold_ = 0.f;
+    float value_     = 0.f;
+    float lo_, hi_;
+};
+
+/**
+   @brief The arguments last passed to an engine setter.
+
+   Changed() is true (and remembers the new arguments) only when they
+   differ from last time, so
+
+       if(delay_ms.Changed(ms))
+           del.SetDelayMs(ms);
+
+   runs the setter, and whatever coefficients it recomputes, only when
+   the derived value actually moves. Several arguments are compared
+   together: Dirty<float, bool> p; if(p.Changed(x, b)) ...
+*/
+template <typename... Ts>
+class Dirty
+{
+  public:
+    Dirty() {}
+    ~Dirty() {}
+
+    /// count calls/skips in `counter` (may be shared, or nullptr)
+    void Init(DirtyCounter* counter = nullptr)
+    {
+        counter_ = counter;
+        dirty_   = true;
+    }
+
+    /// the next Changed() is true whatever it's given
+    void Invalidate() { dirty_ = true; }
+
+    inline bool Changed(const Ts&... v)
+    {
+        const std::tuple<Ts...> next(v...);
+        if(!dirty_ && next == last_)
+        {
+            if(counter_)
+                counter_->skipped++;
+            return false;
+        }
+        last_  = next;
+        dirty_ = false;
+        if(counter_)
+            counter_->calls++;
+        return true;
+    }
+
+  private:
+    std::tuple<Ts...> last_;
+    DirtyCounter*     counter_ = nullptr;
+    bool              dirty_   = true;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_DIRTY_H
@@ -0,0 +1,125 @@
+// dirty_test.cpp
+// Hysteresis and Dirty<>: how many setter calls a pedal's control block
+// skips when most knobs sit still (and ADC noise would otherwise look
+// like movement).
+// build: g++ -O2 -std=c++14 dirty_test.cpp -o dirty_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include "dirty.h"
+
+using daisysp::Dirty;
+using daisysp::DirtyCounter;
+using daisysp::Hysteresis;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr size_t kRate = 24000; // control blocks per second (2-sample blocks)
+
+// Test 1: jitter is held, a turn is followed to within the threshold, and
+// the ends are reached
+void test_hysteresis()
+{
+    std::cout << "\n== Test 1: hysteresis ==\n";
+    Hysteresis h;
+    h.Init(0.002f, 0.5f);
+    bool held = true;
+    uint32_t seed = 1;
+    for (size_t i = 0; i < 1000; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        held = held && h.Process(0.5f + 0.0015f * ((float)(seed >> 8) / 8388608.f - 1.f)) == 0.5f;
+    }
+    CHECK(held, "jitter under the threshold is held");
+
+    float worst = 0.f;
+    for (size_t i = 0; i <= 1000; i++) {
+        const float x = 0.5f - 0.5f * i / 1000.f;
+        worst = std::fmax(worst, std::fabs(h.Process(x) - x));
+    }
+    CHECK(worst <= 0.002f && h.Value() == 0.f, "a turn is followed, and lands on 0");
+}
+
+// Test 2: Dirty<> lets the first call and real changes through
+void test_dirty()
+{
+    std::cout << "\n== Test 2: Dirty<> ==\n";
+    DirtyCounter c;
+    Dirty<float, bool> d;
+    d.Init(&c);
+    CHECK(d.Changed(1.f, false), "first call goes through");
+    CHECK(!d.Changed(1.f, false), "same arguments skipped");
+    CHECK(d.Changed(1.f, true) && d.Changed(2.f, true), "either argument changing goes through");
+    d.Invalidate();
+    CHECK(d.Changed(2.f, true), "Invalidate() forces the next call");
+    CHECK(c.calls == 4 && c.skipped == 1, "counted");
+}
+
+// Test 3: cenote's control block for 10 s: six knobs with ADC noise, one
+// of them turned for 1 s, eight setters derived from them
+void test_control_block()
+{
+    std::cout << "\n== Test 3: a control block, 10 s ==\n";
+    for (int hyst = 0; hyst < 2; hyst++) {
+        DirtyCounter c;
+        Dirty<float> setters[8];
+        Hysteresis   knobs[6];
+        float        smooth[6];
+        for (auto& d : setters)
+            d.Init(&c);
+        for (int k = 0; k < 6; k++) {
+            knobs[k].Init(hyst ? 0.002f : 0.f, 0.3f);
+            smooth[k] = 0.3f;
+        }
+
+        uint32_t seed = 7;
+        for (size_t n = 0; n < kRate * 10; n++) {
+            float pot[6];
+            for (int k = 0; k < 6; k++) {
+                float target = 0.3f;
+                if (k == 1 && n >= kRate * 4 && n < kRate * 5)
+                    target = 0.3f + 0.5f * (n - kRate * 4) / kRate;
+                else if (k == 1 && n >= kRate * 5)
+                    target = 0.8f;
+                seed = seed * 1664525u + 1013904223u;
+                const float noise = 0.0005f * ((float)(seed >> 8) / 8388608.f - 1.f);
+                smooth[k] += 0.002f * (target + noise - smooth[k]); // the ADC's one-pole
+                pot[k] = knobs[k].Process(smooth[k]);
+            }
+            // the derived values (delay, feedback, shift, depth, rate, mix, level, ...)
+            setters[0].Changed(pot[1] * 1500.f);
+            setters[1].Changed(pot[2] * 0.9999999999f);
+            setters[2].Changed(pot[4] * 15.f);
+            setters[3].Changed(pot[3] * 0.5f);
+            setters[4].Changed(pot[0] * 15.f + 0.1f);
+            setters[5].Changed(pot[3] < 0.1f ? 0.f : 1.f);
+            setters[6].Changed(pot[5]);
+            setters[7].Changed(pot[1] * 112.5f);
+        }
+        std::printf("%s: %u setter calls, %u skipped (%.2f%% avoided)\n",
+                    hyst ? "with hysteresis   " : "without hysteresis", c.calls, c.skipped,
+                    100.f * c.Saved());
+        if (hyst) {
+            CHECK(c.Saved() > 0.99f, "over 99% of setter calls avoided");
+        }
+    }
+}
+
+int main()
+{
+    std::cout << "Running dirty flag tests...\n";
+    test_hysteresis();
+    test_dirty();
+    test_control_block();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
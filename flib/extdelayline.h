@@ -0,0 +1,135 @@
+#pragma once
+#ifndef HUGO_LIB_EXTDELAYLINE_H
+#define HUGO_LIB_EXTDELAYLINE_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace daisysp
+{
+
+/**
+   @brief daisysp::DelayLine over a caller-provided buffer.
+
+   Same read/write semantics as DelayLine<T, N> (Write() moves the write
+   head backwards, Read() looks `delay` samples ahead of it, linear
+   interpolation), but the length is set at runtime so the buffer can be
+   sized from the sample rate and live in SRAM or SDRAM as the caller
+   decides. Wraps with compares instead of the modulo of a runtime size.
+*/
+template <typename T>
+class ExtDelayLine
+{
+  public:
+    ExtDelayLine() {}
+    ~ExtDelayLine() {}
+
+    /// samples needed for `max_ms` at `sample_rate` (+2 for interpolation)
+    static size_t SizeFor(float sample_rate, float max_ms)
+    {
+        return (size_t)ceilf(max_ms * 0.001f * sample_rate) + 2;
+    }
+
+    void Init(T* buf, size_t size)
+    {
+        line_ = buf;
+        size_ = size;
+        Reset();
+    }
+
+    void Reset()
+    {
+        for(size_t i = 0; i < size_; i++)
+            line_[i] = T(0);
+        write_ptr_ = 0;
+        delay_     = 1;
+        frac_      = 0.f;
+    }
+
+    size_t GetSize() const { return size_; }
+
+    inline void SetDelay(size_t delay)
+    {
+        frac_  = 0.f;
+        delay_ = delay < size_ ? delay : size_ - 1;
+    }
+
+    inline void SetDelay(float delay)
+    {
+        int32_t int_delay = static_cast<int32_t>(delay);
+        frac_             = delay - static_cast<float>(int_delay);
+        delay_ = (size_t)int_delay < size_ ? (size_t)int_delay : size_ - 1;
+    }
+
+    inline void Write(const T sample)
+    {
+        line_[write_ptr_] = sample;
+        write_ptr_        = (write_ptr_ == 0 ? size_ : write_ptr_) - 1;
+    }
+
+    inline const T Read() const
+    {
+        size_t i0 = Wrap(write_ptr_ + delay_);
+        size_t i1 = Wrap(i0 + 1);
+        const T a = line_[i0];
+        const T b = line_[i1];
+        return a + (b - a) * frac_;
+    }
+
+    inline const T Read(float delay) const
+    {
+        int32_t delay_integral   = static_cast<int32_t>(delay);
+        float   delay_fractional = delay - static_cast<float>(delay_integral);
+        size_t  i0               = Wrap(write_ptr_ + delay_integral);
+        size_t  i1               = Wrap(i0 + 1);
+        const T a                = line_[i0];
+        const T b                = line_[i1];
+        return a + (b - a) * delay_fractional;
+    }
+
+    /// 4-point Hermite, same as DelayLine::ReadHermite
+    inline const T ReadHermite(float delay) const
+    {
+        int32_t delay_integral   = static_cast<int32_t>(delay);
+        float   delay_fractional = delay - static_cast<float>(delay_integral);
+        return Hermite(Wrap(write_ptr_ + delay_integral), delay_fractional);
+    }
+
+    inline const T ReadHermite() const
+    {
+        return Hermite(Wrap(write_ptr_ + delay_), frac_);
+    }
+
+  private:
+    // i < 2 * size_ for every caller above
+    inline size_t Wrap(size_t i) const { return i >= size_ ? i - size_ : i; }
+
+    inline const T Hermite(size_t i0, float f) const
+    {
+        const size_t i1    = Wrap(i0 + 1);
+        const T      xm1   = line_[i0 == 0 ? size_ - 1 : i0 - 1];
+        const T      x0    = line_[i0];
+        const T      x1    = line_[i1];
+        const T      x2    = line_[Wrap(i1 + 1)];
+        const T      c     = (x1 - xm1) * 0.5f;
+        const T      v     = x0 - x1;
+        const T      w     = c + v;
+        const T      a     = w + v + (x2 - x0) * 0.5f;
+        const T      b_neg = w + a;
+        return (((a * f) - b_neg) * f + c) * f + x0;
+    }
+
+    T*     line_      = nullptr;
+    size_t size_      = 0;
+    size_t write_ptr_ = 0;
+    size_t delay_     = 1;
+    float  frac_      = 0.f;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_EXTDELAYLINE_H
@@ -1,6 +1,7 @@
 #pragma once
 #include <cmath>
-#include <array>
+#include <cstddef>
+#include "hilbert.h"
 
 namespace daisysp
 {
@@ -15,74 +16,131 @@ class FrequencyShifter
     FrequencyShifter() {}
     ~FrequencyShifter() {}
 
+    static constexpr size_t kChunk  = 32; // frames of I/Q worked out at once
+    static constexpr float  kFadeMs = 5.f; // bypass crossfade
+
     /// Initialize filter poles and reset phase
     void Init(float sample_rate)
     {
         sample_rate_ = sample_rate;
-        phase_       = 0.f;
         freqShiftHz_ = 0.f;
+        bypass_      = false;
+        mix_         = 1.f;
+        mix_step_    = 1.f / (kFadeMs * 0.001f * sample_rate_);
 
-        // compute each all-pass coefficient from its center frequency
-        // (from SC: 15 * π / fs times a set of 12 multipliers)
-        const double gamconst = (15.0 * M_PI) / sample_rate_;
-        constexpr double gamMul[12] = {
-            0.3609,  2.7412, 11.1573, 44.7581,
-           179.6242,798.4578, 1.2524,  5.5671,
-            22.3423,89.6271,364.7914,2770.1114
-        };
-        for(int i = 0; i < 12; i++)
-        {
-            double g    = gamconst * gamMul[i];
-            coefs_[i]   = float((g - 1.0) / (g + 1.0));
-            y1_[i]      = 0.f;
-        }
+        // the I/Q allpasses (SC's poles, see Hilbert)
+        hilbert_.Init(sample_rate_);
+
+        // carrier phasor starts at phase 0, rotation at 0 Hz
+        car_cos_ = 1.f;
+        car_sin_ = 0.f;
+        rot_cos_ = 1.f;
+        rot_sin_ = 0.f;
     }
 
-    /// Set the desired frequency shift in Hz
+    /// Set the desired frequency shift in Hz.
+    /// Also caches the per-sample carrier rotation.
     void SetShift(float hz)
     {
+        if(hz == freqShiftHz_)
+            return;
         freqShiftHz_ = hz;
+
+        const double w = (2.0 * M_PI * hz) / sample_rate_;
+        rot_cos_       = float(std::cos(w));
+        rot_sin_       = float(std::sin(w));
     }
 
-    /// Process a single sample through Hilbert IIR + SSB modulation
+    /**
+       Crossfade (over kFadeMs) to the input passed straight through, and
+       skip the allpasses once the shifted signal has faded out. Lifting
+       the bypass fades the shifted signal back in; the filters restart
+       from rest only if it had faded out all the way.
+    */
+    void SetBypass(bool bypass)
+    {
+        if(bypass == bypass_)
+            return;
+        bypass_ = bypass;
+        if(!bypass_ && mix_ == 0.f)
+            hilbert_.Reset();
+    }
+
+    /// the bypass has faded in fully: the allpasses are skipped
+    bool IsBypassed() const { return bypass_ && mix_ == 0.f; }
+
+    /// Process a single sample: the same path (and state) as ProcessBlock()
     float Process(float in)
     {
-        // 1) Run 6 all-pass stages for the I branch
-        float I = runHilbert(in, 0);
-        // 2) And 6 more for the Q branch (taps 6–11)
-        float Q = runHilbert(in, 6);
-
-        // 3) Advance and wrap the phase
-        phase_ += (2.f * float(M_PI) * freqShiftHz_) / sample_rate_;
-        if(phase_ >=  2.f * float(M_PI)) phase_ -= 2.f * float(M_PI);
-        if(phase_ <   0.f)              phase_ += 2.f * float(M_PI);
-
-        // 4) Compute sin/cos
-        float s = std::sin(phase_);
-        float c = std::cos(phase_);
-
-        // 5) SSB out = I·cos(φ) + Q·sin(φ)
-        return I * c + Q * s;
+        float out;
+        ProcessBlock(&in, &out, 1);
+        return out;
     }
 
-  private:
-    /// Run six 1-pole all-pass stages starting at offset `ofs`
-    inline float runHilbert(float x, int ofs)
+    /**
+       Process a block (in-place safe). The I and Q allpass chains run in
+       float (see Hilbert) a chunk at a time, and the carrier is a rotating
+       phasor (renormalized once per block) instead of sin/cos per sample.
+       Shares its state with Process(): the two can be mixed freely.
+    */
+    void ProcessBlock(const float* in, float* out, size_t size)
     {
-        double v = x;
-        for(int i = 0; i < 6; i++)
+        if(IsBypassed())
+        {
+            if(out != in)
+                for(size_t i = 0; i < size; i++)
+                    out[i] = in[i];
+            return;
+        }
+
+        float c = car_cos_;
+        float s = car_sin_;
+        float I[kChunk], Q[kChunk];
+        for(size_t done = 0; done < size;)
         {
-            double y0 = v - coefs_[ofs+i] * y1_[ofs+i];
-            double ay = coefs_[ofs+i] * y0 + y1_[ofs+i];
-            y1_[ofs+i] = float(y0);
-            v = ay;
+            const size_t n = size - done < kChunk ? size - done : kChunk;
+            hilbert_.ProcessBlock(in + done, I, Q, n);
+            const float target = bypass_ ? 0.f : 1.f;
+            for(size_t i = 0; i < n; i++)
+            {
+                // advance the carrier by one sample
+                const float cn = c * rot_cos_ - s * rot_sin_;
+                s              = s * rot_cos_ + c * rot_sin_;
+                c              = cn;
+
+                const float wet = I[i] * c + Q[i] * s;
+                if(mix_ != target)
+                    mix_ = bypass_ ? fmaxf(mix_ - mix_step_, 0.f)
+                                   : fminf(mix_ + mix_step_, 1.f);
+                if(mix_ == 1.f)
+                {
+                    out[done + i] = wet;
+                    continue;
+                }
+                // in or out of the bypass: between the input and the shift
+                const float dry = in[done + i];
+                out[done + i]   = dry + mix_ * (wet - dry);
+            }
+            done += n;
         }
-        return float(v);
+
+        // first-order renormalization, keeps |phasor| == 1 without a sqrt
+        const float g = 1.5f - 0.5f * (c * c + s * s);
+        car_cos_      = c * g;
+        car_sin_      = s * g;
     }
 
+  private:
     float                 sample_rate_;
-    float                 phase_, freqShiftHz_;
-    std::array<float,12>  coefs_, y1_;
+    float                 freqShiftHz_;
+    bool                  bypass_;
+    float                 mix_;      // shifted signal's share, 0 to 1
+    float                 mix_step_; // per sample while fading
+
+    // I/Q chains, current phasor and per-sample rotation
+    Hilbert<1>            hilbert_;
+    float                 car_cos_, car_sin_;
+    float                 rot_cos_, rot_sin_;
 };
 
 } // namespace daisysp
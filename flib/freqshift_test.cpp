@@ -0,0 +1,326 @@
+// freqshift_test.cpp
+// build: g++ -O2 -std=c++14 freqshift_test.cpp -o freqshift_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "freqshift.h"
+
+using daisysp::FrequencyShifter;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr     = 48000.f;
+static constexpr size_t kWarmup = 4800;
+static constexpr size_t kLen    = 48000;
+
+// The shifter as it was before ProcessBlock(): double-precision allpass
+// chains and sin/cos of a wrapped phase every sample. The reference for
+// sideband rejection and cost.
+class BaselineShifter
+{
+  public:
+    void Init(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        phase_       = 0.f;
+        shift_       = 0.f;
+        const double gamconst = (15.0 * M_PI) / sample_rate_;
+        constexpr double gamMul[12] = {
+            0.3609,  2.7412, 11.1573, 44.7581,
+           179.6242,798.4578, 1.2524,  5.5671,
+            22.3423,89.6271,364.7914,2770.1114
+        };
+        for (int i = 0; i < 12; i++) {
+            double g  = gamconst * gamMul[i];
+            coefs_[i] = float((g - 1.0) / (g + 1.0));
+            y1_[i]    = 0.f;
+        }
+    }
+
+    void SetShift(float hz) { shift_ = hz; }
+
+    float Process(float in)
+    {
+        float I = runHilbert(in, 0);
+        float Q = runHilbert(in, 6);
+        phase_ += (2.f * float(M_PI) * shift_) / sample_rate_;
+        if (phase_ >= 2.f * float(M_PI)) phase_ -= 2.f * float(M_PI);
+        if (phase_ < 0.f)               phase_ += 2.f * float(M_PI);
+        return I * std::cos(phase_) + Q * std::sin(phase_);
+    }
+
+  private:
+    float runHilbert(float x, int ofs)
+    {
+        double v = x;
+        for (int i = 0; i < 6; i++) {
+            double y0 = v - coefs_[ofs + i] * y1_[ofs + i];
+            double ay = coefs_[ofs + i] * y0 + y1_[ofs + i];
+            y1_[ofs + i] = float(y0);
+            v = ay;
+        }
+        return float(v);
+    }
+
+    float sample_rate_, phase_, shift_;
+    float coefs_[12], y1_[12];
+};
+
+// magnitude of a single DFT bin (Goertzel) at `hz`
+double goertzel(const std::vector<float>& x, double hz)
+{
+    double w = 2.0 * M_PI * hz / kSr;
+    double k = 2.0 * std::cos(w);
+    double s1 = 0.0, s2 = 0.0;
+    for (float v : x) {
+        double s0 = v + k * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    double re = s1 - s2 * std::cos(w);
+    double im = s2 * std::sin(w);
+    return std::sqrt(re * re + im * im) / x.size();
+}
+
+std::vector<float> sine(double hz, size_t n)
+{
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = 0.5f * (float)std::sin(2.0 * M_PI * hz * i / kSr);
+    return x;
+}
+
+// run the baseline (block 0) or ProcessBlock() over the signal, return
+// the steady-state part
+std::vector<float> render(const std::vector<float>& in, float shift, size_t block)
+{
+    FrequencyShifter fs;
+    fs.Init(kSr);
+    fs.SetShift(shift);
+    std::vector<float> out(in.size());
+    if (block == 0) {
+        BaselineShifter base;
+        base.Init(kSr);
+        base.SetShift(shift);
+        for (size_t i = 0; i < in.size(); i++)
+            out[i] = base.Process(in[i]);
+    } else {
+        for (size_t i = 0; i < in.size(); i += block) {
+            size_t n = std::min(block, in.size() - i);
+            fs.ProcessBlock(&in[i], &out[i], n);
+        }
+    }
+    return std::vector<float>(out.begin() + kWarmup, out.end());
+}
+
+// wanted sideband over image sideband, in dB
+double rejection_db(const std::vector<float>& y, double f0, double shift)
+{
+    return 20.0 * std::log10(goertzel(y, f0 + shift) / goertzel(y, f0 - shift));
+}
+
+// Test 1: sideband rejection of ProcessBlock, whatever the block size
+// (1 is what Process() runs), stays within 1 dB of the baseline.
+void test_sideband_rejection()
+{
+    std::cout << "\n== Test 1: sideband rejection vs the baseline ==\n";
+    const double freqs[]  = {200.0, 1000.0, 5000.0};
+    const float  shifts[] = {15.f, 150.f, -150.f};
+    const size_t blocks[] = {1, 2, 48};
+
+    for (double f0 : freqs) {
+        std::vector<float> in = sine(f0, kWarmup + kLen);
+        for (float shift : shifts) {
+            double ref = rejection_db(render(in, shift, 0), f0, shift);
+            for (size_t b : blocks) {
+                double blk = rejection_db(render(in, shift, b), f0, shift);
+                char msg[160];
+                std::snprintf(msg, sizeof(msg),
+                    "f0=%6.0f shift=%+5.0f block=%2zu: %.1f dB (ref %.1f dB)",
+                    f0, shift, b, blk, ref);
+                CHECK(blk > 30.0 && blk > ref - 1.0, msg);
+            }
+        }
+    }
+}
+
+// Test 2: the rotating phasor keeps its amplitude and sideband rejection
+// over a long run (60 s in blocks of 2).
+void test_long_run_drift()
+{
+    std::cout << "\n== Test 2: carrier drift over 60 s ==\n";
+    const double f0 = 1000.0, shift = 150.0;
+    std::vector<float> in = sine(f0, kLen);
+    FrequencyShifter fs;
+    fs.Init(kSr);
+    fs.SetShift((float)shift);
+
+    const size_t seconds = 60;
+    std::vector<float> first(kLen), last(kLen), scratch(kLen);
+    for (size_t sec = 0; sec < seconds; sec++) {
+        std::vector<float>& out = sec == 0 ? first : (sec == seconds - 1 ? last : scratch);
+        for (size_t i = 0; i < kLen; i += 2)
+            fs.ProcessBlock(&in[i], &out[i], 2);
+    }
+    first.erase(first.begin(), first.begin() + kWarmup);
+    last.erase(last.begin(), last.begin() + kWarmup);
+
+    double gain_db = 20.0 * std::log10(goertzel(last, f0 + shift) / goertzel(first, f0 + shift));
+    double rej     = rejection_db(last, f0, shift);
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "wanted sideband level change after 60 s = %+.4f dB", gain_db);
+    CHECK(std::fabs(gain_db) < 0.01, msg);
+    std::snprintf(msg, sizeof(msg), "rejection after 60 s = %.1f dB", rej);
+    CHECK(rej > 50.0, msg);
+}
+
+// Test 3: Process() and ProcessBlock() share their state: calls mixed on
+// one instance give what blocks alone do (to rounding: the carrier is
+// renormalized once per call), with no step where they change over.
+void test_mixed_calls()
+{
+    std::cout << "\n== Test 3: Process() and ProcessBlock() mixed ==\n";
+    std::vector<float> in = sine(1000.0, kLen);
+    std::vector<float> ref(kLen), mixed(kLen);
+    FrequencyShifter a, b;
+    a.Init(kSr);
+    b.Init(kSr);
+    a.SetShift(150.f);
+    b.SetShift(150.f);
+    for (size_t i = 0; i < kLen; i += 48)
+        a.ProcessBlock(&in[i], &ref[i], 48);
+    for (size_t i = 0; i < kLen; i += 48) {
+        if ((i / 48) % 2) {
+            b.ProcessBlock(&in[i], &mixed[i], 48);
+        } else {
+            for (size_t j = i; j < i + 48; j++)
+                mixed[j] = b.Process(in[j]);
+        }
+    }
+    float diff = 0.f;
+    for (size_t i = 0; i < kLen; i++)
+        diff = std::max(diff, std::fabs(mixed[i] - ref[i]));
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "alternating every 48 samples: off by at most %.2g", diff);
+    CHECK(diff < 1e-4f, msg);
+}
+
+// Test 4: the bypass crossfades both ways, in place, with no step larger
+// than the sine's own from one sample to the next, and skips the
+// allpasses (exact input) once it has faded in
+void test_bypass_fade()
+{
+    std::cout << "\n== Test 4: bypass crossfade ==\n";
+    std::vector<float> in = sine(1000.0, kLen), buf = in;
+    FrequencyShifter fs;
+    fs.Init(kSr);
+    fs.SetShift(150.f);
+    // on at 0.2 s, off at 0.4 s, on at 0.6 s and off again halfway in
+    const size_t flips[4] = {9600, 19200, 28800, 28800 + 96};
+    size_t       next     = 0;
+    size_t       dry_at   = 0;
+    for (size_t i = 0; i < kLen; i += 16) {
+        if (next < 4 && i >= flips[next])
+            fs.SetBypass(++next % 2 == 1);
+        fs.ProcessBlock(&buf[i], &buf[i], 16);
+        if (!dry_at && fs.IsBypassed())
+            dry_at = i + 16;
+    }
+
+    const float sine_step = 0.5f * (float)(2.0 * M_PI * 1150.0 / kSr);
+    float       step      = 0.f;
+    for (size_t i = kWarmup; i < kLen; i++)
+        step = std::max(step, std::fabs(buf[i] - buf[i - 1]));
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "largest step %.3f (the shifted sine's own: %.3f)", step, sine_step);
+    CHECK(step < 1.1f * sine_step, msg);
+    // the fade, a sample for rounding, and a chunk for where it ends
+    const size_t fade = (size_t)std::ceil(FrequencyShifter::kFadeMs * 0.001f * kSr) + 1;
+    std::snprintf(msg, sizeof(msg), "fully bypassed %zu samples after the switch (fade %zu)",
+                  dry_at - flips[0], fade);
+    CHECK(dry_at > flips[0] && dry_at <= flips[0] + fade + FrequencyShifter::kChunk, msg);
+    bool exact = true;
+    for (size_t i = dry_at; i < flips[1]; i++)
+        exact = exact && buf[i] == in[i];
+    CHECK(exact, "bypassed output is the input");
+    CHECK(!fs.IsBypassed(), "lifted again");
+}
+
+template <typename F>
+double ns_per(F&& run, size_t n)
+{
+    double best = 1e9;
+    for (int k = 0; k < 3; k++) { // best of three, the host's timing is noisy
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+    }
+    return best;
+}
+
+static volatile float sink; // keeps the timed loops from being optimized out
+
+// Test 5: cost per sample against the baseline, a sample at a time and
+// in blocks
+void test_cycles_per_sample()
+{
+    std::cout << "\n== Test 5: cost per sample ==\n";
+    std::vector<float> in = sine(1000.0, kLen);
+    std::vector<float> out(kLen);
+    FrequencyShifter fs;
+    fs.Init(kSr);
+    fs.SetShift(150.f);
+    BaselineShifter base;
+    base.Init(kSr);
+    base.SetShift(150.f);
+
+    const double ns_base = ns_per([&] {
+        for (size_t i = 0; i < kLen; i++)
+            out[i] = base.Process(in[i]);
+    }, kLen);
+    sink = out[kLen / 2];
+    const double ns_one = ns_per([&] {
+        for (size_t i = 0; i < kLen; i++)
+            out[i] = fs.Process(in[i]);
+    }, kLen);
+    sink = out[kLen / 2];
+    double ns_blk[2];
+    const size_t sizes[2] = {2, 48};
+    for (size_t k = 0; k < 2; k++) {
+        ns_blk[k] = ns_per([&] {
+            for (size_t i = 0; i < kLen; i += sizes[k])
+                fs.ProcessBlock(&in[i], &out[i], sizes[k]);
+        }, kLen);
+        sink = out[kLen / 2];
+    }
+    std::printf("baseline:          %6.2f ns/sample\n", ns_base);
+    std::printf("Process():         %6.2f ns/sample (%.2fx)\n", ns_one, ns_base / ns_one);
+    std::printf("ProcessBlock(2):   %6.2f ns/sample (%.2fx)\n", ns_blk[0], ns_base / ns_blk[0]);
+    std::printf("ProcessBlock(48):  %6.2f ns/sample (%.2fx)\n", ns_blk[1], ns_base / ns_blk[1]);
+    CHECK(ns_blk[1] < 0.5 * ns_base, "blocks of 48 cost under half the baseline");
+}
+
+int main()
+{
+    std::cout << "Running freqshift tests...\n";
+    test_sideband_rejection();
+    test_long_run_drift();
+    test_mixed_calls();
+    test_bypass_fade();
+    test_cycles_per_sample();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -6,6 +6,7 @@
 
 #include "daisysp.h"
 #include "ipoke.h"
+#include "arena.h"
 #include <array>
 
 using namespace daisy;
@@ -26,7 +27,7 @@ public:
     };
 
     void Init(float sample_rate, 
-         float* buffer, 
+         LazyBuffer* buffer, 
          size_t buf_frames, 
          size_t buf_chans) {
         sr_ = sample_rate;
@@ -135,11 +136,11 @@ public:
     AdEnv env_;
 
     float sr_;
-    float *buf_ = nullptr; // pointer to the buffer
+    LazyBuffer *buf_ = nullptr; // pointer to the buffer
     size_t frames_ = 0; // number of frames in the buffer
     size_t chans_ = 0; // number of channels in the buffer
 
-    Ipeek peeker_;
+    IpeekT<StoreRef<LazyBuffer>> peeker_;
     
     // playhead
     float pos_;
@@ -161,7 +162,7 @@ public:
     ~Grains() {}
 
     void Init(float sample_rate, 
-              float* buffer, 
+              LazyBuffer* buffer, 
               size_t buf_frames, 
               size_t buf_chans) {
         sr_ = sample_rate;
@@ -247,7 +248,7 @@ public:
 
 public:
     float sr_;
-    float *buf_;
+    LazyBuffer *buf_;
     size_t frames_;
     size_t chans_;
 
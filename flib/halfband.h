@@ -0,0 +1,179 @@
+#pragma once
+#ifndef HUGO_LIB_HALFBAND_H
+#define HUGO_LIB_HALFBAND_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+
+namespace daisysp
+{
+
+/**
+   @brief Polyphase IIR half-band filters for 2x resampling.
+
+   The half-band lowpass is the sum of two allpass chains running at the low
+   rate (Regalia / Mitra structure, as in Laurent de Soras' HIIR):
+   H(z) = 0.5 * (A0(z^2) + z^-1 A1(z^2)). Even coefficients go to path 0,
+   odd ones to path 1, and each path only ever runs at the low rate, so a
+   2x up or down step costs NumCoefs one-pole allpasses per low-rate sample.
+
+   Coefficients come from the elliptic design in HIIR's PolyphaseIir2Designer
+   for a given number of coefficients and normalized transition bandwidth
+   (fraction of the high rate, 0 < tbw < 0.5). Computed once in Init().
+*/
+namespace halfband
+{
+
+inline double ipowp(double x, long n)
+{
+    double z = 1.0;
+    while(n != 0)
+    {
+        if((n & 1) != 0)
+            z *= x;
+        n >>= 1;
+        x *= x;
+    }
+    return z;
+}
+
+/// Fill coefs[num_coefs] for the given transition bandwidth
+inline void Design(float* coefs, size_t num_coefs, double transition)
+{
+    // transition parameters k and q of the elliptic filter
+    double k = std::tan((1.0 - transition * 2.0) * M_PI / 4.0);
+    k *= k;
+    const double kksqrt = std::pow(1.0 - k * k, 0.25);
+    const double e      = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+    const double e2     = e * e;
+    const double e4     = e2 * e2;
+    const double q      = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+    const long order = (long)num_coefs * 2 + 1;
+    for(size_t index = 0; index < num_coefs; index++)
+    {
+        const double c = (double)index + 1.0;
+
+        double num = 0.0;
+        long   i   = 0;
+        double j   = 1.0;
+        double term;
+        do
+        {
+            term = ipowp(q, i * (i + 1)) * std::sin((i * 2 + 1) * c * M_PI / order) * j;
+            num += term;
+            j = -j;
+            ++i;
+        } while(std::fabs(term) > 1e-100);
+        num *= std::pow(q, 0.25);
+
+        double den = 0.0;
+        i          = 1;
+        j          = -1.0;
+        do
+        {
+            term = ipowp(q, i * i) * std::cos(i * 2 * c * M_PI / order) * j;
+            den += term;
+            j = -j;
+            ++i;
+        } while(std::fabs(term) > 1e-100);
+        den += 0.5;
+
+        const double ww   = num / den;
+        const double wwsq = ww * ww;
+        const double x    = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+        coefs[index]      = float((1.0 - x) / (1.0 + x));
+    }
+}
+
+/// The two allpass paths, state and coefficients
+template <size_t NumCoefs>
+struct Paths
+{
+    void Init(double transition)
+    {
+        Design(coefs, NumCoefs, transition);
+        Reset();
+    }
+
+    void Reset()
+    {
+        for(size_t i = 0; i < NumCoefs; i++)
+        {
+            x1[i] = 0.f;
+            y1[i] = 0.f;
+        }
+    }
+
+    /// run path 0 on a, path 1 on b
+    inline void Process(float& a, float& b)
+    {
+        for(size_t i = 0; i < NumCoefs; i += 2)
+        {
+            const float y0 = (a - y1[i]) * coefs[i] + x1[i];
+            x1[i]          = a;
+            y1[i]          = y0;
+            a              = y0;
+
+            if(i + 1 < NumCoefs)
+            {
+                const float y1b = (b - y1[i + 1]) * coefs[i + 1] + x1[i + 1];
+                x1[i + 1]       = b;
+                y1[i + 1]       = y1b;
+                b               = y1b;
+            }
+        }
+    }
+
+    float coefs[NumCoefs];
+    float x1[NumCoefs];
+    float y1[NumCoefs];
+};
+
+} // namespace halfband
+
+/** @brief 2x upsampler: one sample in, two out */
+template <size_t NumCoefs>
+class Upsampler2x
+{
+  public:
+    void Init(double transition) { paths_.Init(transition); }
+    void Reset() { paths_.Reset(); }
+
+    inline void Process(float in, float* out)
+    {
+        float a = in, b = in;
+        paths_.Process(a, b);
+        out[0] = a;
+        out[1] = b;
+    }
+
+  private:
+    halfband::Paths<NumCoefs> paths_;
+};
+
+/** @brief 2x downsampler: two samples in (oldest first), one out */
+template <size_t NumCoefs>
+class Downsampler2x
+{
+  public:
+    void Init(double transition) { paths_.Init(transition); }
+    void Reset() { paths_.Reset(); }
+
+    inline float Process(const float* in)
+    {
+        float a = in[1], b = in[0];
+        paths_.Process(a, b);
+        return 0.5f * (a + b);
+    }
+
+  private:
+    halfband::Paths<NumCoefs> paths_;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_HALFBAND_H
@@ -0,0 +1,193 @@
+#pragma once
+#ifndef HUGO_LIB_HILBERT_H
+#define HUGO_LIB_HILBERT_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+
+namespace daisysp
+{
+
+/**
+   @brief IIR Hilbert transformer (2 x 6 one-pole allpasses, SC FreqShift poles)
+          giving the I/Q pair of `Channels` inputs.
+
+   Mono runs its I and Q chains one after the other, six stages each,
+   spelled out so their state stays in registers. With more channels the
+   I and Q branches of every channel are "lanes" stored side by side
+   (structure of arrays), and each allpass stage runs across all lanes
+   before moving to the next. This is plain scalar code: whether the lanes
+   end up in SIMD registers is up to the compiler's autovectorizer.
+
+   On host (hilbert_test) spelling the mono chains out halves their cost
+   against the same chains written as loops; stereo's 4 lanes cost a
+   little less per channel than that; 8 lanes no longer fit in registers
+   and cost more per channel than 4. The M7 has no SIMD for floats:
+   measure there before relying on the lanes.
+
+   Channels = 1 -> I and Q chains (mono), 2 -> 4 lanes (stereo I/Q), ...
+*/
+template <size_t Channels>
+class Hilbert
+{
+  public:
+    Hilbert() {}
+    ~Hilbert() {}
+
+    static constexpr size_t kLanes  = 2 * Channels;
+    static constexpr size_t kStages = 6;
+
+    void Init(float sample_rate)
+    {
+        // (from SC: 15 * π / fs times a set of 12 multipliers,
+        //  first 6 for the I branch, last 6 for the Q branch)
+        const double gamconst = (15.0 * M_PI) / sample_rate;
+        constexpr double gamMul[2 * kStages] = {
+            0.3609,  2.7412, 11.1573, 44.7581,
+           179.6242,798.4578, 1.2524,  5.5671,
+            22.3423,89.6271,364.7914,2770.1114
+        };
+        for(size_t s = 0; s < kStages; s++)
+        {
+            const double gi = gamconst * gamMul[s];
+            const double gq = gamconst * gamMul[kStages + s];
+            for(size_t ch = 0; ch < Channels; ch++)
+            {
+                coefs_[s][ch]            = float((gi - 1.0) / (gi + 1.0));
+                coefs_[s][Channels + ch] = float((gq - 1.0) / (gq + 1.0));
+            }
+        }
+        Reset();
+    }
+
+    /// Clear the filter state
+    void Reset()
+    {
+        for(size_t s = 0; s < kStages; s++)
+            for(size_t l = 0; l < kLanes; l++)
+                z_[s][l] = 0.f;
+    }
+
+    /// One frame: in[Channels] -> out_i[Channels], out_q[Channels]
+    inline void Process(const float* in, float* out_i, float* out_q)
+    {
+        float v[kLanes];
+        Load(in, v);
+        Tick(v, coefs_, z_);
+        Store(v, out_i, out_q);
+    }
+
+    /// Planar block: in[ch][n] -> out_i[ch][n], out_q[ch][n]
+    void ProcessBlock(const float* const* in,
+                      float* const*       out_i,
+                      float* const*       out_q,
+                      size_t              size)
+    {
+        // run the block on local copies of the coefficients, state and
+        // channel pointers so they can live in registers (no aliasing with
+        // the output buffers)
+        float a[kStages][kLanes], z[kStages][kLanes];
+        CopyState(coefs_, a);
+        CopyState(z_, z);
+        const float* x[Channels];
+        float*       yi[Channels];
+        float*       yq[Channels];
+        for(size_t ch = 0; ch < Channels; ch++)
+        {
+            x[ch]  = in[ch];
+            yi[ch] = out_i[ch];
+            yq[ch] = out_q[ch];
+        }
+
+        float v[kLanes];
+        for(size_t n = 0; n < size; n++)
+        {
+            for(size_t ch = 0; ch < Channels; ch++)
+            {
+                v[ch]            = x[ch][n];
+                v[Channels + ch] = x[ch][n];
+            }
+            Tick(v, a, z);
+            for(size_t ch = 0; ch < Channels; ch++)
+            {
+                yi[ch][n] = v[ch];
+                yq[ch][n] = v[Channels + ch];
+            }
+        }
+
+        CopyState(z, z_);
+    }
+
+    /// Mono block
+    void ProcessBlock(const float* in, float* out_i, float* out_q, size_t size)
+    {
+        static_assert(Channels == 1, "mono ProcessBlock needs Channels == 1");
+        ProcessBlock(&in, &out_i, &out_q, size);
+    }
+
+  private:
+    /// All stages across all lanes. Lanes are independent, stages are not.
+    static inline void Tick(float* v, const float (*a)[kLanes], float (*z)[kLanes])
+    {
+        if(Channels == 1)
+        {
+            // spelled out, so the state stays in registers
+            for(size_t l = 0; l < kLanes; l++)
+            {
+                Stage(v[l], a[0][l], z[0][l]);
+                Stage(v[l], a[1][l], z[1][l]);
+                Stage(v[l], a[2][l], z[2][l]);
+                Stage(v[l], a[3][l], z[3][l]);
+                Stage(v[l], a[4][l], z[4][l]);
+                Stage(v[l], a[5][l], z[5][l]);
+            }
+            return;
+        }
+        for(size_t s = 0; s < kStages; s++)
+            for(size_t l = 0; l < kLanes; l++)
+                Stage(v[l], a[s][l], z[s][l]);
+    }
+
+    /// one first-order allpass
+    static inline void Stage(float& v, float a, float& z)
+    {
+        const float y0 = v - a * z;
+        v              = a * y0 + z;
+        z              = y0;
+    }
+
+    inline void Load(const float* in, float* v) const
+    {
+        for(size_t ch = 0; ch < Channels; ch++)
+        {
+            v[ch]            = in[ch];
+            v[Channels + ch] = in[ch];
+        }
+    }
+
+    inline void Store(const float* v, float* out_i, float* out_q) const
+    {
+        for(size_t ch = 0; ch < Channels; ch++)
+        {
+            out_i[ch] = v[ch];
+            out_q[ch] = v[Channels + ch];
+        }
+    }
+
+    static inline void CopyState(const float (*src)[kLanes], float (*dst)[kLanes])
+    {
+        for(size_t s = 0; s < kStages; s++)
+            for(size_t l = 0; l < kLanes; l++)
+                dst[s][l] = src[s][l];
+    }
+
+    float coefs_[kStages][kLanes];
+    float z_[kStages][kLanes];
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_HILBERT_H
@@ -18,13 +18,33 @@ inline float zapgremlins(float x) {
     return (absx > 1e-15f && absx < 1e15f) ? x : 0.f;
 }
 
-class Ipoke 
+/// a plain float array, as storage for Ipoke/Ipeek
+struct FlatStore
+{
+    FlatStore(float* buf = nullptr) : buf_(buf) {}
+    inline float Read(size_t i) const { return buf_[i]; }
+    inline float& Write(size_t i) { return buf_[i]; }
+    float* buf_;
+};
+
+/// any buffer with Read(i)/Write(i) (e.g. ChunkedBuffer), by pointer
+template <typename Buf>
+struct StoreRef
+{
+    StoreRef(Buf* buf = nullptr) : buf_(buf) {}
+    inline float Read(size_t i) const { return buf_->Read(i); }
+    inline float& Write(size_t i) { return buf_->Write(i); }
+    Buf* buf_;
+};
+
+template <typename Store>
+class IpokeT
 {
 public:
-    Ipoke() {}
-    ~Ipoke() {}
+    IpokeT() {}
+    ~IpokeT() {}
 
-    void Init(float* buffer, 
+    void Init(Store buffer, 
               size_t buf_frames, 
               size_t buf_chans) {
         buf_ = buffer;
@@ -33,8 +53,6 @@ public:
 
         values_.assign((size_t)chans_, 0.0f);
         coefficients_.assign((size_t)chans_, 0.0f);
-
-        assert(buf_ != nullptr);
     }
 
     void ResetIndex() {
@@ -78,11 +96,7 @@ public:
                 }
 
                 for (size_t chan = 0; chan < chans_; ++chan) {
-                    buf_[last_index_ * chans_ + chan] = zapgremlins(
-                        (float)
-                        (buf_[last_index_ * chans_ + chan] * overdub_ 
-                            + values_[chan])
-                    ); // write the avg value at the last index
+                    Mix(last_index_ * chans_ + chan, values_[chan]); // write the avg value at the last index
                 }
 
                 long step = indexl - last_index_;
@@ -127,9 +141,7 @@ public:
 private:
     void WriteAverageValue(long index){
         for (size_t chan = 0; chan < chans_; ++chan) {
-            buf_[index * chans_ + chan] =
-                zapgremlins(static_cast<float>((buf_[index * chans_ + chan]
-                    * overdub_) + (values_[chan] / num_accumulated_)));
+            Mix(index * chans_ + chan, values_[chan] / num_accumulated_);
             values_[chan] = 0.0f;
         }
     }
@@ -148,10 +160,7 @@ private:
         for (long i = start; i != end; i += step) {
             for (size_t chan = 0; chan < chans_; ++chan) {
                 if (interpolate_) values_[chan] += coefficients_[chan];
-                buf_[i * chans_ + chan] = zapgremlins(
-                    (float)
-                    (buf_[i * chans_ + chan] * overdub_ + values_[chan])
-                );
+                Mix(i * chans_ + chan, values_[chan]);
                 max_gaps_filled++;
             }
         }
@@ -160,6 +169,14 @@ private:
         }
     }
 
+    // buf * overdub + value (no read at overdub 0: a first pass only writes,
+    // so the buffer needn't be cleared first)
+    inline void Mix(size_t i, float value) {
+        buf_.Write(i) = zapgremlins(
+            overdub_ == 0.f ? value : buf_.Read(i) * overdub_ + value
+        );
+    }
+
     // debug variables
 public:
     long d_start_;
@@ -169,7 +186,7 @@ public:
 
 public:
     // buffer
-    float* buf_ = nullptr;
+    Store buf_;
     size_t frames_ = 0;
     size_t chans_ = 2;
 
@@ -187,19 +204,19 @@ public:
 };
 
 
-class Ipeek
+template <typename Store>
+class IpeekT
 {
 public:
-    Ipeek() {}
-    ~Ipeek() {}
+    IpeekT() {}
+    ~IpeekT() {}
 
-    void Init(float* buffer, 
+    void Init(Store buffer, 
               size_t buf_frames, 
               size_t buf_chans) {
         buf_ = buffer;
         frames_ = buf_frames;
         chans_ = buf_chans;
-        assert(buf_ != nullptr);
     }
 
     void Peek(float index, float* out) {
@@ -211,8 +228,8 @@ public:
             float a, b, frac;
             size_t i_idx = (size_t)index;
             frac         = index - i_idx;
-            a            = buf_[((i_idx    ) % frames_) * chans_ + chan];
-            b            = buf_[((i_idx + 1) % frames_) * chans_ + chan];
+            a            = buf_.Read(((i_idx    ) % frames_) * chans_ + chan);
+            b            = buf_.Read(((i_idx + 1) % frames_) * chans_ + chan);
             out[chan] = zapgremlins(a + (b - a) * frac);
         }
     }
@@ -249,10 +266,10 @@ public:
             else if (i_idx > frames_ - 1) i_idx = frames_ - 1, frac = 1.f;
             else frac = index - i_idx;
 
-            a = buf_[((i_idx - 1) % frames_) * chans_ + chan];
-            b = buf_[((i_idx    ) % frames_) * chans_ + chan];
-            c = buf_[((i_idx + 1) % frames_) * chans_ + chan];
-            d = buf_[((i_idx + 2) % frames_) * chans_ + chan];
+            a = buf_.Read(((i_idx - 1) % frames_) * chans_ + chan);
+            b = buf_.Read(((i_idx    ) % frames_) * chans_ + chan);
+            c = buf_.Read(((i_idx + 1) % frames_) * chans_ + chan);
+            d = buf_.Read(((i_idx + 2) % frames_) * chans_ + chan);
             cminusb = c - b;
 
             out[chan] = b + frac * (cminusb - 0.1666667f * (1.f - frac) * 
@@ -264,12 +281,15 @@ public:
 
 private:
     // buffer
-    float* buf_ = nullptr;
+    Store buf_;
     size_t frames_;
     size_t chans_;
     
 };
 
+using Ipoke = IpokeT<FlatStore>;
+using Ipeek = IpeekT<FlatStore>;
+
 } // namespace daisysp
 
 #endif // __cplusplus
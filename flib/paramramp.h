@@ -0,0 +1,174 @@
+#pragma once
+#ifndef HUGO_LIB_PARAMRAMP_H
+#define HUGO_LIB_PARAMRAMP_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+
+namespace daisysp
+{
+
+/**
+   @brief Control-rate parameter smoothing: a target becomes a linear
+          segment per audio block.
+
+   LINEAR: every new target is reached in the ramp time, in a straight
+   line (like daisysp::Line). EXPONENTIAL: the same glide as fonepole()
+   run every sample, advanced a whole block at a time (one multiply per
+   sample, so block and per-sample callers stay in step).
+
+   In a block loop, take Value() and the increment NextBlock(size) returns
+   and add it up per sample. Once the value lands on the target (within
+   the snap distance) it is settled: NextBlock() returns 0 straight away
+   and callers can skip the smoothing altogether (IsSettled()).
+
+   The value is kept as its distance from the target, so a glide stays
+   exact in float near large targets (delay times in samples) instead of
+   stalling short of them.
+*/
+class ParamRamp
+{
+  public:
+    ParamRamp() {}
+    ~ParamRamp() {}
+
+    enum class MODE
+    {
+        LINEAR,
+        EXPONENTIAL
+    };
+
+    /** time_ms: LINEAR, how long to reach a new target;
+        EXPONENTIAL, the glide's time constant */
+    void Init(float sample_rate, float time_ms, MODE mode, float value = 0.f)
+    {
+        sample_rate_ = sample_rate;
+        mode_        = mode;
+        target_      = value;
+        err_         = 0.f;
+        slope_       = 0.f;
+        snap_        = 1e-5f;
+        SetTimeMs(time_ms);
+    }
+
+    void SetTimeMs(float time_ms)
+    {
+        time_samps_ = fmaxf(1.f, time_ms * 0.001f * sample_rate_);
+        coeff_      = -expm1f(-1.f / time_samps_);
+    }
+
+    /// EXPONENTIAL: the per-sample fonepole() coefficient instead of a time
+    void SetCoefficient(float coeff) { coeff_ = coeff; }
+
+    /// distance from the target at which the value jumps onto it
+    void SetSnap(float snap) { snap_ = snap; }
+
+    void SetTarget(float target)
+    {
+        if(target == target_)
+            return;
+        err_ += target_ - target;
+        target_ = target;
+        if(mode_ == MODE::LINEAR)
+            slope_ = fabsf(err_) / time_samps_;
+        Snap();
+    }
+
+    /// jump to `value` (settled)
+    void SetValue(float value)
+    {
+        target_ = value;
+        err_    = 0.f;
+    }
+
+    float Value() const { return target_ + err_; }
+
+    float GetTarget() const { return target_; }
+
+    bool IsSettled() const { return err_ == 0.f; }
+
+    /// one sample, returns the new value
+    inline float Process()
+    {
+        if(err_ != 0.f)
+        {
+            if(mode_ == MODE::EXPONENTIAL)
+                err_ -= err_ * coeff_;
+            else
+                err_ = Toward0(err_, slope_);
+            Snap();
+        }
+        return target_ + err_;
+    }
+
+    /**
+       Advance by a block of `size` samples; returns the per-sample
+       increment that takes Value() from before the call to after it.
+    */
+    inline float NextBlock(size_t size)
+    {
+        if(err_ == 0.f)
+            return 0.f;
+        const float before = err_;
+        if(mode_ == MODE::EXPONENTIAL)
+        {
+            // not (1 - coeff_)^size: a different rounding than Process()
+            // drifts off it by a fair fraction of a sample on a long glide
+            for(size_t i = 0; i < size; i++)
+                err_ -= err_ * coeff_;
+        }
+        else
+        {
+            err_ = Toward0(err_, slope_ * size);
+        }
+        Snap();
+        return (err_ - before) / (float)size;
+    }
+
+    /// Fill out[] with this block's values (out[size - 1] == Value() after)
+    void Fill(float* out, size_t size)
+    {
+        float       v    = Value();
+        const float step = NextBlock(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            v += step;
+            out[i] = v;
+        }
+        out[size - 1] = Value();
+    }
+
+  private:
+    inline void Snap()
+    {
+        if(fabsf(err_) < snap_)
+            err_ = 0.f;
+    }
+
+    static inline float Toward0(float err, float amount)
+    {
+        if(err > 0.f)
+            return err > amount ? err - amount : 0.f;
+        return -err > amount ? err + amount : 0.f;
+    }
+
+    float sample_rate_;
+    MODE  mode_;
+
+    float target_;
+    float err_; // value - target
+    float snap_;
+
+    float time_samps_;
+    float slope_; // LINEAR: |step| per sample of the current segment
+
+    float coeff_; // EXPONENTIAL: per-sample coefficient (not stored as
+                  // 1 - coeff_, which rounds most of a small one away)
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_PARAMRAMP_H
@@ -0,0 +1,120 @@
+// paramramp_test.cpp
+// build: g++ -O2 -std=c++14 paramramp_test.cpp -o paramramp_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include "paramramp.h"
+
+using daisysp::ParamRamp;
+using MODE = ParamRamp::MODE;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float kSr = 48000.f;
+
+// Test 1: a linear ramp reaches its target in the ramp time, in a line
+void test_linear()
+{
+    std::cout << "\n== Test 1: linear ==\n";
+    ParamRamp r;
+    r.Init(kSr, 10.f, MODE::LINEAR, 0.f);
+    r.SetTarget(1.f);
+
+    float worst = 0.f;
+    size_t n = 0;
+    while (!r.IsSettled() && n < 1000) {
+        const float v = r.Process();
+        n++;
+        worst = std::fmax(worst, std::fabs(v - n / 480.f));
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "settled after %zu samples (10 ms = 480)", n);
+    CHECK(n >= 479 && n <= 481, msg);
+    std::snprintf(msg, sizeof(msg), "straight line within %.1e", worst);
+    CHECK(worst < 1e-4f, msg);
+    CHECK(r.Value() == 1.f, "lands on the target");
+}
+
+// Test 2: exponential mode is the glide fonepole() runs every sample, but
+// without fonepole()'s float rounding: near a large target its steps are
+// rounded to the target's grid (it wanders off the curve and then stalls
+// short of the target)
+void test_exponential()
+{
+    std::cout << "\n== Test 2: exponential vs fonepole ==\n";
+    const float coeff = 0.00007f, target = 48000.f;
+    ParamRamp r;
+    r.Init(kSr, 0.f, MODE::EXPONENTIAL, 0.f);
+    r.SetCoefficient(coeff);
+    r.SetTarget(target);
+
+    float ref = 0.f;
+    double exact = 0.0;
+    float worst_ref = 0.f, worst_exact = 0.f;
+    for (size_t i = 0; i < 48000 * 10; i++) {
+        ref += coeff * (target - ref); // fonepole
+        exact = target - target * std::pow(1.0 - coeff, (double)(i + 1));
+        const float v = r.Process();
+        if (i < 48000)
+            worst_ref = std::fmax(worst_ref, std::fabs(v - ref));
+        worst_exact = std::fmax(worst_exact, std::fabs(v - (float)exact));
+    }
+    std::printf("(fonepole is up to %.2f samples off in the first second)\n", worst_ref);
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "within %.3f samples of the true exponential", worst_exact);
+    CHECK(worst_exact < 0.05f, msg);
+    std::snprintf(msg, sizeof(msg), "fonepole stalls %.2f samples short, ramp lands", target - ref);
+    CHECK(r.IsSettled() && r.Value() == target, msg);
+}
+
+// Test 3: block segments end where the per-sample ramp does (up to float
+// rounding of one step vs four), and a settled ramp hands out nothing
+void test_blocks()
+{
+    std::cout << "\n== Test 3: NextBlock vs Process ==\n";
+    for (MODE mode : {MODE::LINEAR, MODE::EXPONENTIAL}) {
+        ParamRamp a, b;
+        a.Init(kSr, 50.f, mode, 2.f);
+        b.Init(kSr, 50.f, mode, 2.f);
+        float worst = 0.f;
+        for (size_t blk = 0; blk < 20000; blk++) {
+            if (blk == 0 || blk == 300) {
+                a.SetTarget(blk ? -1.f : 5.f);
+                b.SetTarget(blk ? -1.f : 5.f);
+            }
+            float       v    = b.Value();
+            const float step = b.NextBlock(4);
+            for (size_t i = 0; i < 4; i++) {
+                v += step;
+                a.Process();
+            }
+            worst = std::fmax(worst, std::fabs(a.Value() - b.Value()));
+            worst = std::fmax(worst, std::fabs(v - b.Value()));
+        }
+        char msg[96];
+        std::snprintf(msg, sizeof(msg), "%s: block ends within %.1e of per-sample",
+                      mode == MODE::LINEAR ? "linear     " : "exponential", worst);
+        CHECK(worst < 1e-3f, msg);
+        CHECK(b.IsSettled() && b.NextBlock(4) == 0.f, "settled ramp returns no step");
+    }
+}
+
+int main()
+{
+    std::cout << "Running param ramp tests...\n";
+    test_linear();
+    test_exponential();
+    test_blocks();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
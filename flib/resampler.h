@@ -0,0 +1,109 @@
+#pragma once
+#ifndef HUGO_LIB_RESAMPLER_H
+#define HUGO_LIB_RESAMPLER_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+
+namespace daisysp
+{
+
+/**
+   @brief Streaming sample-rate conversion of interleaved frames, by cubic
+          (4-point Hermite) interpolation.
+
+   Takes input and gives output in whatever pieces are at hand: Process()
+   consumes what it can and stops when either side runs out, keeping its
+   place in between. Output frame n is the input at n * in_rate / out_rate,
+   so 44.1 kHz material lines up with a 48 kHz loop.
+
+   Meant for moving whole files and loops (44.1 <-> 48 kHz), not pitch
+   effects: Hermite has no anti-aliasing filter, which is inaudible at
+   these ratios but would not be for big downward ones.
+*/
+template <size_t MaxChans = 2>
+class Resampler
+{
+  public:
+    Resampler() {}
+    ~Resampler() {}
+
+    void Init(float in_rate, float out_rate, size_t chans)
+    {
+        chans_ = chans < MaxChans ? chans : MaxChans;
+        step_  = (double)in_rate / (double)out_rate;
+        Reset();
+    }
+
+    /// start a new stream
+    void Reset()
+    {
+        for(size_t i = 0; i < 4 * MaxChans; i++)
+            hist_[i] = 0.f;
+        phase_ = 3.0; // three frames in before the first out: that one is in[0]
+    }
+
+    /**
+       Convert from `in` (in_frames) into `out` (room for max_out frames).
+       Returns frames written; *consumed: frames of `in` used up.
+    */
+    size_t Process(const float* in, size_t in_frames, float* out, size_t max_out, size_t* consumed)
+    {
+        size_t used = 0, made = 0;
+        while(made < max_out)
+        {
+            if(phase_ >= 1.0)
+            {
+                if(used == in_frames)
+                    break;
+                Push(in + used * chans_);
+                used++;
+                phase_ -= 1.0;
+                continue;
+            }
+            const float t = (float)phase_;
+            for(size_t c = 0; c < chans_; c++)
+            {
+                const float xm1 = hist_[c], x0 = hist_[MaxChans + c],
+                            x1 = hist_[2 * MaxChans + c], x2 = hist_[3 * MaxChans + c];
+                const float c1 = 0.5f * (x1 - xm1);
+                const float c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+                const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+                out[made * chans_ + c] = ((c3 * t + c2) * t + c1) * t + x0;
+            }
+            made++;
+            phase_ += step_;
+        }
+        if(consumed != nullptr)
+            *consumed = used;
+        return made;
+    }
+
+    /// output frames that `in_frames` of input make
+    size_t GetOutputFrames(size_t in_frames) const { return (size_t)((double)in_frames / step_ + 0.5); }
+
+    size_t GetChans() const { return chans_; }
+
+  private:
+    void Push(const float* frame)
+    {
+        for(size_t c = 0; c < chans_; c++)
+        {
+            hist_[c]                = hist_[MaxChans + c];
+            hist_[MaxChans + c]     = hist_[2 * MaxChans + c];
+            hist_[2 * MaxChans + c] = hist_[3 * MaxChans + c];
+            hist_[3 * MaxChans + c] = frame[c];
+        }
+    }
+
+    size_t chans_ = 1;
+    double step_  = 1.0; // input frames per output frame
+    double phase_ = 3.0; // where the next output sits past x0, in input frames
+    float  hist_[4 * MaxChans]; // x[-1], x[0], x[1], x[2], chans each
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_RESAMPLER_H
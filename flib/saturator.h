@@ -0,0 +1,157 @@
+#pragma once
+#ifndef HUGO_LIB_SATURATOR_H
+#define HUGO_LIB_SATURATOR_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include "halfband.h"
+
+namespace daisysp
+{
+
+/**
+   @brief SoftClip / SoftLimit with optional 2x or 4x oversampling.
+
+   The curve is run at the oversampled rate between polyphase IIR half-band
+   up/downsamplers, so the harmonics it makes above Nyquist are filtered
+   out instead of folding back. X1 is exactly daisysp's SoftClip/SoftLimit.
+
+   Stage 1 (base <-> 2x) is 8 coefficients with a 0.04 transition band,
+   flat to ~20 kHz @ 48k. Stage 2 (2x <-> 4x) only has to protect the
+   base band, so 4 coefficients with a wide transition are enough.
+*/
+class Saturator
+{
+  public:
+    Saturator() {}
+    ~Saturator() {}
+
+    enum class OVERSAMPLE
+    {
+        X1,
+        X2,
+        X4
+    };
+
+    enum class CURVE
+    {
+        SOFT_CLIP,
+        SOFT_LIMIT
+    };
+
+    void Init(OVERSAMPLE os = OVERSAMPLE::X2, CURVE curve = CURVE::SOFT_CLIP)
+    {
+        up1_.Init(kTransition1);
+        down1_.Init(kTransition1);
+        up2_.Init(kTransition2);
+        down2_.Init(kTransition2);
+        os_    = os;
+        curve_ = curve;
+    }
+
+    /// Clears the filters when the factor changes
+    void SetOversampling(OVERSAMPLE os)
+    {
+        if(os == os_)
+            return;
+        os_ = os;
+        Reset();
+    }
+
+    void SetCurve(CURVE curve) { curve_ = curve; }
+
+    OVERSAMPLE GetOversampling() const { return os_; }
+
+    void Reset()
+    {
+        up1_.Reset();
+        down1_.Reset();
+        up2_.Reset();
+        down2_.Reset();
+    }
+
+    inline float Process(float in)
+    {
+        switch(os_)
+        {
+            case OVERSAMPLE::X1: return Shape(in);
+            case OVERSAMPLE::X2: return Process2x(in);
+            case OVERSAMPLE::X4: return Process4x(in);
+        }
+        return in;
+    }
+
+    void ProcessBlock(const float* in, float* out, size_t size)
+    {
+        switch(os_)
+        {
+            case OVERSAMPLE::X1:
+                for(size_t i = 0; i < size; i++)
+                    out[i] = Shape(in[i]);
+                break;
+            case OVERSAMPLE::X2:
+                for(size_t i = 0; i < size; i++)
+                    out[i] = Process2x(in[i]);
+                break;
+            case OVERSAMPLE::X4:
+                for(size_t i = 0; i < size; i++)
+                    out[i] = Process4x(in[i]);
+                break;
+        }
+    }
+
+  private:
+    static constexpr size_t kCoefs1      = 8;
+    static constexpr size_t kCoefs2      = 4;
+    static constexpr double kTransition1 = 0.04;
+    static constexpr double kTransition2 = 0.125;
+
+    // same curves as daisysp::SoftLimit / SoftClip
+    inline float Shape(float x) const
+    {
+        if(curve_ == CURVE::SOFT_CLIP)
+        {
+            if(x < -3.0f)
+                return -1.0f;
+            if(x > 3.0f)
+                return 1.0f;
+        }
+        return x * (27.f + x * x) / (27.f + 9.f * x * x);
+    }
+
+    inline float Process2x(float in)
+    {
+        float x2[2];
+        up1_.Process(in, x2);
+        x2[0] = Shape(x2[0]);
+        x2[1] = Shape(x2[1]);
+        return down1_.Process(x2);
+    }
+
+    inline float Process4x(float in)
+    {
+        float x2[2], x4[4];
+        up1_.Process(in, x2);
+        up2_.Process(x2[0], &x4[0]);
+        up2_.Process(x2[1], &x4[2]);
+        for(size_t k = 0; k < 4; k++)
+            x4[k] = Shape(x4[k]);
+        x2[0] = down2_.Process(&x4[0]);
+        x2[1] = down2_.Process(&x4[2]);
+        return down1_.Process(x2);
+    }
+
+    Upsampler2x<kCoefs1>   up1_;
+    Downsampler2x<kCoefs1> down1_;
+    Upsampler2x<kCoefs2>   up2_;
+    Downsampler2x<kCoefs2> down2_;
+
+    OVERSAMPLE os_    = OVERSAMPLE::X2;
+    CURVE      curve_ = CURVE::SOFT_CLIP;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_SATURATOR_H
@@ -0,0 +1,171 @@
+// saturator_test.cpp
+// build: g++ -O2 -std=c++14 saturator_test.cpp -o saturator_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "saturator.h"
+
+using daisysp::Saturator;
+using OS = Saturator::OVERSAMPLE;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr     = 48000.f;
+static constexpr size_t kWarmup = 4800;
+static constexpr size_t kLen    = 48000;
+
+// magnitude of a single DFT bin (Goertzel) at `hz`
+double goertzel(const std::vector<float>& x, double hz)
+{
+    double w = 2.0 * M_PI * hz / kSr;
+    double k = 2.0 * std::cos(w);
+    double s1 = 0.0, s2 = 0.0;
+    for (float v : x) {
+        double s0 = v + k * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    double re = s1 - s2 * std::cos(w);
+    double im = s2 * std::sin(w);
+    return std::sqrt(re * re + im * im) / x.size();
+}
+
+std::vector<float> sine(double hz, float amp, size_t n)
+{
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = amp * (float)std::sin(2.0 * M_PI * hz * i / kSr);
+    return x;
+}
+
+std::vector<float> render(const std::vector<float>& in, OS os)
+{
+    Saturator sat;
+    sat.Init(os);
+    std::vector<float> out(in.size());
+    for (size_t i = 0; i < in.size(); i += 2)
+        sat.ProcessBlock(&in[i], &out[i], 2);
+    return std::vector<float>(out.begin() + kWarmup, out.end());
+}
+
+const char* name(OS os)
+{
+    return os == OS::X1 ? "X1" : (os == OS::X2 ? "X2" : "X4");
+}
+
+// Test 1: X1 is bit-exact SoftClip.
+void test_x1_matches_softclip()
+{
+    std::cout << "\n== Test 1: X1 == SoftClip ==\n";
+    Saturator sat;
+    sat.Init(OS::X1);
+    bool same = true;
+    for (int i = -4000; i <= 4000; i++) {
+        float x = i * 0.001f;
+        float ref = x < -3.f ? -1.f : (x > 3.f ? 1.f : x * (27.f + x * x) / (27.f + 9.f * x * x));
+        same &= sat.Process(x) == ref;
+    }
+    CHECK(same, "X1 output matches SoftClip over [-4, 4]");
+}
+
+// Test 2: small signals pass with unity gain up to 18 kHz.
+void test_passband()
+{
+    std::cout << "\n== Test 2: passband ==\n";
+    const double freqs[] = {100.0, 1000.0, 10000.0, 18000.0};
+    for (OS os : {OS::X2, OS::X4}) {
+        for (double f : freqs) {
+            std::vector<float> y = render(sine(f, 0.01f, kWarmup + kLen), os);
+            double gain_db = 20.0 * std::log10(goertzel(y, f) / 0.005);
+            char msg[96];
+            std::snprintf(msg, sizeof(msg), "%s f=%6.0f Hz: %+.3f dB", name(os), f, gain_db);
+            CHECK(std::fabs(gain_db) < 0.1, msg);
+        }
+    }
+}
+
+// Test 3: alias rejection. A hot 5 kHz sine makes odd harmonics; the ones
+// above Nyquist fold back onto non-harmonic frequencies. Report the
+// strongest folded component below 20 kHz relative to the fundamental.
+double worst_alias_db(const std::vector<float>& y, double f0)
+{
+    const double fund = goertzel(y, f0);
+    double worst = 0.0;
+    for (int h = 3; h <= 61; h += 2) {
+        double f = std::fmod(h * f0, kSr);
+        if (f > kSr / 2)
+            f = kSr - f;
+        if (h * f0 < kSr / 2 || f < 20.0 || f > 20000.0)
+            continue; // in band, on DC, or in the half-band transition
+        // skip the ones landing on a true harmonic
+        double r = std::fmod(f, f0);
+        if (r < 1.0 || f0 - r < 1.0)
+            continue;
+        worst = std::max(worst, goertzel(y, f));
+    }
+    return 20.0 * std::log10(worst / fund);
+}
+
+void test_alias_rejection()
+{
+    std::cout << "\n== Test 3: alias rejection (5 kHz, 2.0 peak) ==\n";
+    const double f0 = 5000.0;
+    std::vector<float> in = sine(f0, 2.0f, kWarmup + kLen);
+    double db[3];
+    int    k = 0;
+    for (OS os : {OS::X1, OS::X2, OS::X4}) {
+        db[k] = worst_alias_db(render(in, os), f0);
+        std::printf("%s: strongest alias %.1f dB\n", name(os), db[k]);
+        k++;
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "X2 rejects aliases by %.1f dB more than X1", db[0] - db[1]);
+    CHECK(db[1] < db[0] - 20.0, msg);
+    std::snprintf(msg, sizeof(msg), "X4 alias below -80 dB (%.1f dB)", db[2]);
+    CHECK(db[2] < -80.0, msg);
+}
+
+// Test 4: cost per sample at each factor (printed only, host timings).
+void test_cost()
+{
+    std::cout << "\n== Test 4: cost per sample (block of 2) ==\n";
+    std::vector<float> in = sine(1000.0, 1.5f, kLen);
+    std::vector<float> out(kLen);
+    for (OS os : {OS::X1, OS::X2, OS::X4}) {
+        Saturator sat;
+        sat.Init(os);
+        const int reps = 20;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; r++)
+            for (size_t i = 0; i < kLen; i += 2)
+                sat.ProcessBlock(&in[i], &out[i], 2);
+        auto t1 = std::chrono::steady_clock::now();
+        volatile float sink = out[kLen / 2];
+        (void)sink;
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (reps * kLen);
+        std::printf("%s: %6.2f ns/sample\n", name(os), ns);
+    }
+}
+
+int main()
+{
+    std::cout << "Running saturator tests...\n";
+    test_x1_matches_softclip();
+    test_passband();
+    test_alias_rejection();
+    test_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
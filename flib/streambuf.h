@@ -0,0 +1,350 @@
+#pragma once
+#ifndef HUGO_LIB_STREAMBUF_H
+#define HUGO_LIB_STREAMBUF_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include "arena.h"
+
+namespace daisysp
+{
+
+/// where a streamed loop lives: floats at a float offset; false on an error
+struct StreamFile
+{
+    void* ctx;
+    bool (*read)(void* ctx, size_t offset, float* dst, size_t n);
+    bool (*write)(void* ctx, size_t offset, const float* src, size_t n);
+};
+
+/**
+   @brief A buffer whose frames live in a file (an SD card, a file on the
+          host), with only a window of it in RAM, around the head.
+
+   The window is a few chunks of an arena ("slots"), each holding one page
+   of the file: a chunk's worth of frames. Read()/Write() are a
+   ChunkedBuffer's, watermark and all, and never wait: a page that isn't
+   in a slot reads as silence and drops writes, and counts as a miss.
+
+   Service(), from the main loop, keeps the slots on the page under the
+   head, the one behind it and as many ahead as the rate eats in
+   SetLatency() frames: while one page plays, the next ones are read in.
+   Pages that were written go back to the file before their slot is
+   reused. A jump (a skip to somewhere else in the loop) lands on pages
+   that aren't there: silence, until the next Service().
+
+   The audio interrupt can come in at any point of Service(), I/O or not:
+   a slot's samples only change while no page points at it, and a loaded
+   page is handed over with one store, so the audio side only ever sees
+   whole pages. Release() just drops the watermark, so the audio side
+   never touches the slots' bookkeeping at all.
+*/
+template <size_t MaxPages, size_t Slots = 8>
+class StreamedBuffer
+{
+  public:
+    StreamedBuffer() {}
+    ~StreamedBuffer() {}
+
+    static_assert(Slots < 128, "slot numbers are kept in an int8_t");
+
+    /// frames come and go: only the window around the head is in RAM
+    static constexpr bool kInMemory = false;
+
+    /// takes the slots out of the arena for good; Attach() a file next
+    void Init(ChunkArena* arena)
+    {
+        shift_     = arena->GetChunkFramesLog2();
+        size_log2_ = shift_;
+        while(((size_t)1 << (size_log2_ - shift_)) < arena->GetChans())
+            size_log2_++;
+        mask_ = ((size_t)1 << size_log2_) - 1;
+
+        num_slots_ = 0;
+        while(num_slots_ < Slots && (data_[num_slots_] = arena->Alloc()) != nullptr)
+            num_slots_++;
+        for(size_t s = 0; s < Slots; s++)
+        {
+            page_[s]  = kNoPage;
+            dirty_[s] = false;
+        }
+        for(size_t p = 0; p < MaxPages; p++)
+            slot_of_[p] = kNoSlot;
+
+        file_    = {nullptr, nullptr, nullptr};
+        limit_   = MaxPages;
+        latency_ = 4800;
+        pages_   = 0;
+        valid_   = 0;
+        misses_  = 0;
+    }
+
+    /// the file to stream through, and how many frames it may grow to
+    void Attach(StreamFile file, size_t max_frames)
+    {
+        file_  = file;
+        limit_ = max_frames >> shift_;
+        limit_ = limit_ < MaxPages ? limit_ : MaxPages;
+    }
+
+    /**
+       the longest the main loop may take to come back to Service(), I/O
+       included, in frames: read-ahead is this times the rate
+    */
+    void SetLatency(size_t frames) { latency_ = frames; }
+
+    /// make frames [0, frames) part of the loop; false past the file's limit
+    bool Reserve(size_t frames)
+    {
+        size_t pages = (frames + ((size_t)1 << shift_) - 1) >> shift_;
+        const bool ok = pages <= limit_;
+        pages         = ok ? pages : limit_;
+        if(pages > pages_)
+            pages_ = pages;
+        return ok;
+    }
+
+    /// forget the loop: everything reads as silence again
+    void Release()
+    {
+        pages_ = 0;
+        valid_ = 0;
+    }
+
+    size_t GetCapacityFrames() const { return pages_ << shift_; }
+
+    /// the most frames this buffer could ever hold
+    size_t GetMaxFrames() const { return MaxPages << shift_; }
+
+    /// floats written so far
+    size_t GetValid() const { return valid_; }
+
+    size_t GetPageFrames() const { return (size_t)1 << shift_; }
+    size_t GetNumSlots() const { return num_slots_; }
+
+    /// reads and writes that found their page out of RAM
+    size_t GetMisses() const { return misses_; }
+
+    inline float Read(size_t i) const
+    {
+        if(i >= valid_)
+            return 0.f;
+        const int8_t s = slot_of_[i >> size_log2_];
+        if(s == kNoSlot)
+        {
+            misses_ = misses_ + 1;
+            return 0.f;
+        }
+        return data_[s][i & mask_];
+    }
+
+    inline float& Write(size_t i)
+    {
+        const size_t p = i >> size_log2_;
+        if(p >= pages_)
+            return sink_;
+        const int8_t s = slot_of_[p];
+        if(s == kNoSlot || (i > valid_ && !ZeroTo(i)))
+        {
+            misses_ = misses_ + 1;
+            return sink_;
+        }
+        dirty_[s] = true;
+        if(i >= valid_)
+            valid_ = i + 1;
+        return data_[s][i & mask_];
+    }
+
+    void ReadSpan(size_t i, float* dst, size_t n) const
+    {
+        for(size_t j = 0; j < n; j++)
+            dst[j] = Read(i + j);
+    }
+
+    void WriteSpan(size_t i, const float* src, size_t n)
+    {
+        for(size_t j = 0; j < n; j++)
+            Write(i + j) = src[j];
+    }
+
+    /**
+       From the main loop, as often as it comes round: bring the pages
+       around frame `pos` in, for a head moving at `rate` frames per frame
+       over a loop of `loop_frames`, or into new pages while `growing` (a
+       first recording, which can stop and go back to the top any time).
+       Written pages go back to the file. False on an I/O error.
+    */
+    bool Service(float pos, float rate, size_t loop_frames, bool growing)
+    {
+        const size_t page_frames = (size_t)1 << shift_;
+        const size_t loop = growing ? limit_ : (loop_frames + page_frames) >> shift_;
+        const size_t head = pos > 0.f ? ((size_t)pos >> shift_) % (loop > 0 ? loop : 1) : 0;
+
+        // what should be in RAM, most urgent first
+        num_want_ = 0;
+        Want(head);
+        if(growing)
+            Want(0);
+        size_t       ahead = (size_t)(rate * (float)latency_) / page_frames + 1;
+        const size_t room  = num_slots_ > num_want_ + 1 ? num_slots_ - num_want_ - 1 : 0;
+        ahead              = ahead < room ? ahead : room;
+        for(size_t k = 1; k <= ahead; k++)
+        {
+            size_t p = head + k;
+            if(p >= loop)
+            {
+                if(growing)
+                    break;
+                p %= loop;
+            }
+            Want(p);
+        }
+        if(head > 0)
+            Want(head - 1);
+        else if(!growing && loop > 1)
+            Want(loop - 1);
+
+        bool ok = true;
+        for(size_t w = 0; w < num_want_ && ok; w++)
+        {
+            if(slot_of_[want_[w]] != kNoSlot)
+                continue;
+            const int s = Victim();
+            if(s < 0)
+                break;
+            ok = Load((size_t)s, want_[w]);
+        }
+        // written pages go back once the head has moved off them
+        for(size_t s = 0; s < num_slots_ && ok; s++)
+            if(dirty_[s] && page_[s] != head)
+                ok = Flush(s);
+        return ok;
+    }
+
+  private:
+    static constexpr int8_t kNoSlot = -1;
+    static constexpr size_t kNoPage = (size_t)-1;
+
+    void Want(size_t p)
+    {
+        if(p < limit_ && !Wanted(p) && num_want_ < Slots)
+            want_[num_want_++] = p;
+    }
+
+    bool Wanted(size_t p) const
+    {
+        for(size_t w = 0; w < num_want_; w++)
+            if(want_[w] == p)
+                return true;
+        return false;
+    }
+
+    /// a slot to load into: a free one, else a clean unwanted one, else a dirty one
+    int Victim() const
+    {
+        int dirty = -1;
+        for(size_t s = 0; s < num_slots_; s++)
+            if(page_[s] == kNoPage)
+                return (int)s;
+        for(size_t s = 0; s < num_slots_; s++)
+            if(!Wanted(page_[s]))
+            {
+                if(!dirty_[s])
+                    return (int)s;
+                if(dirty < 0)
+                    dirty = (int)s;
+            }
+        return dirty;
+    }
+
+    bool Load(size_t s, size_t p)
+    {
+        const size_t old = page_[s];
+        if(old != kNoPage)
+        {
+            if(dirty_[s] && !Flush(s))
+                return false;
+            slot_of_[old] = kNoSlot;
+            page_[s]      = kNoPage;
+        }
+        std::atomic_signal_fence(std::memory_order_seq_cst); // unmapped before it changes
+
+        // the file has everything below the watermark that isn't in a slot
+        const size_t start = p << size_log2_;
+        const size_t valid = valid_;
+        size_t       have  = valid > start ? valid - start : 0;
+        have               = have < mask_ + 1 ? have : mask_ + 1;
+        if(have > 0 && (file_.read == nullptr || !file_.read(file_.ctx, start, data_[s], have)))
+            return false;
+        memset(data_[s] + have, 0, (mask_ + 1 - have) * sizeof(float));
+
+        dirty_[s] = false;
+        page_[s]  = p;
+        std::atomic_signal_fence(std::memory_order_seq_cst); // filled before it's seen
+        slot_of_[p] = (int8_t)s;
+        return true;
+    }
+
+    bool Flush(size_t s)
+    {
+        if(file_.write == nullptr)
+            return false;
+        dirty_[s] = false; // a write from here on marks it again
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        if(!file_.write(file_.ctx, page_[s] << size_log2_, data_[s], mask_ + 1))
+        {
+            dirty_[s] = true;
+            return false;
+        }
+        return true;
+    }
+
+    /// zero [valid_, i) for a write above the watermark; false if a page of it is out
+    bool ZeroTo(size_t i)
+    {
+        for(size_t p = valid_ >> size_log2_; p <= (i >> size_log2_); p++)
+            if(slot_of_[p] == kNoSlot)
+                return false;
+        while(valid_ < i)
+        {
+            const size_t p     = valid_ >> size_log2_;
+            const size_t start = valid_ & mask_;
+            const size_t end   = p == (i >> size_log2_) ? (i & mask_) : mask_ + 1;
+            memset(data_[slot_of_[p]] + start, 0, (end - start) * sizeof(float));
+            dirty_[slot_of_[p]] = true;
+            valid_              = valid_ + (end - start);
+        }
+        return true;
+    }
+
+    size_t shift_     = 0; // frames per page, log2
+    size_t size_log2_ = 0; // floats per page, log2
+    size_t mask_      = 0;
+
+    StreamFile file_    = {nullptr, nullptr, nullptr};
+    size_t     limit_   = MaxPages; // pages the file may grow to
+    size_t     latency_ = 4800;
+
+    float*          data_[Slots];
+    size_t          num_slots_ = 0;
+    volatile size_t page_[Slots];  // what each slot holds (set by Service() only)
+    volatile bool   dirty_[Slots]; // written since it was loaded or flushed
+    volatile int8_t slot_of_[MaxPages]; // where each page is, if anywhere
+
+    size_t want_[Slots];
+    size_t num_want_ = 0;
+
+    volatile size_t pages_  = 0; // capacity, pages
+    volatile size_t valid_  = 0; // watermark, floats
+    mutable volatile size_t misses_ = 0;
+    float sink_;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_STREAMBUF_H
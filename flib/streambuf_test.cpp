@@ -0,0 +1,176 @@
+// streambuf_test.cpp
+// StreamedBuffer: a 10 minute loop recorded into a file and played back
+// through 8 pages of RAM, at 1x and 4x, with every file access taking
+// 20 ms of audio time; and misses counted when read-ahead is too short.
+// build: g++ -O2 -std=c++14 streambuf_test.cpp -o streambuf_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "streambuf.h"
+
+using namespace daisysp;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr size_t kLog2   = 14;
+static constexpr size_t kSlots  = 8;
+static constexpr size_t kFrames = 48000 * 600;
+
+using Buffer = StreamedBuffer<2048, kSlots>; // up to 11.6 min
+
+// A file where every access takes `latency` frames: the audio keeps going
+// meanwhile, as the interrupt does on the Daisy while the main loop waits
+// on the SD card.
+struct Disk
+{
+    FILE*                       f;
+    size_t                      latency;
+    std::function<void(size_t)> audio;
+    size_t                      reads = 0, writes = 0;
+};
+
+static bool disk_read(void* ctx, size_t offset, float* dst, size_t n)
+{
+    Disk* d = (Disk*)ctx;
+    d->audio(d->latency);
+    d->reads++;
+    return std::fseek(d->f, (long)(offset * 4), SEEK_SET) == 0 && std::fread(dst, 4, n, d->f) == n;
+}
+
+static bool disk_write(void* ctx, size_t offset, const float* src, size_t n)
+{
+    Disk* d = (Disk*)ctx;
+    d->audio(d->latency);
+    d->writes++;
+    return std::fseek(d->f, (long)(offset * 4), SEEK_SET) == 0 && std::fwrite(src, 4, n, d->f) == n;
+}
+
+static float sig(size_t i)
+{
+    return (float)(int32_t)((uint32_t)i * 2654435761u) * (1.f / 2147483648.f);
+}
+
+struct Rig
+{
+    std::vector<float>    mem  = std::vector<float>(kSlots << kLog2);
+    std::vector<uint16_t> list = std::vector<uint16_t>(kSlots + 1);
+    ChunkArena            arena;
+    Buffer                buf;
+    Disk                  disk;
+    void Init(size_t latency)
+    {
+        arena.Init(mem.data(), mem.size(), kLog2, 1, list.data(), list.size());
+        buf.Init(&arena);
+        disk.f       = std::tmpfile();
+        disk.latency = latency;
+        buf.Attach({&disk, disk_read, disk_write}, kFrames + (2 << kLog2));
+    }
+};
+
+// record sig() over `frames`, a first take, main loop every 5 ms
+void record(Rig& r, size_t frames)
+{
+    size_t pos = 0;
+    r.disk.audio = [&](size_t n) {
+        for (size_t k = 0; k < n && pos < frames; k++, pos++) {
+            r.buf.Reserve(pos + 2);
+            r.buf.Write(pos) = sig(pos);
+        }
+    };
+    while (pos < frames) {
+        r.buf.Service((float)pos, 1.f, pos, true);
+        r.disk.audio(240);
+    }
+}
+
+// play a loop of `frames` from the top at `rate` for `out` frames, main
+// loop every 5 ms, and busy elsewhere for `stall` frames once a second;
+// true if every frame read back as written
+bool play(Rig& r, size_t frames, double rate, size_t out, size_t stall = 0)
+{
+    double pos  = 0.0;
+    size_t done = 0;
+    bool   same = true;
+    r.disk.audio = [&](size_t n) {
+        for (size_t k = 0; k < n && done < out; k++, done++) {
+            const size_t i = (size_t)pos;
+            same = r.buf.Read(i) == sig(i) && same;
+            pos += rate;
+            if (pos >= frames)
+                pos -= frames;
+        }
+    };
+    const size_t latency = r.disk.latency; // cued up at the top first: a jump misses
+    r.disk.latency       = 0;
+    r.buf.Service(0.f, (float)rate, frames, false);
+    r.disk.latency = latency;
+    for (size_t it = 1; done < out; it++) {
+        r.buf.Service((float)pos, (float)rate, frames, false);
+        r.disk.audio(240);
+        if (it % 200 == 0)
+            r.disk.audio(stall);
+    }
+    return same;
+}
+
+// Test 1: 10 minutes in, through 8 pages of RAM, and back out at 1x and 4x
+void test_long_loop()
+{
+    std::cout << "\n== Test 1: a 10 minute loop ==\n";
+    static Rig r;
+    r.Init(960); // 20 ms an access: a slow SD card
+    record(r, kFrames);
+    CHECK(r.buf.GetMisses() == 0 && r.buf.GetValid() == kFrames, "recorded without a miss");
+
+    CHECK(play(r, kFrames, 1.0, kFrames), "played back at 1x, every frame as written");
+    CHECK(play(r, kFrames, 4.0, 48000 * 60), "a minute at 4x, across the loop point");
+    std::printf("%.0f s loop, %.1f s of it in RAM; %zu page writes, %zu reads\n", kFrames / 48000.0,
+                (double)(r.buf.GetNumSlots() * r.buf.GetPageFrames()) / 48000.0, r.disk.writes,
+                r.disk.reads);
+    CHECK(r.buf.GetMisses() == 0, "no misses either way");
+    std::fclose(r.disk.f);
+}
+
+// Test 2: a main loop that goes off for 250 ms once a second, at 4x:
+// read-ahead for a 5 ms loop falls behind, and says so; read-ahead for
+// the stall keeps up
+void test_misses()
+{
+    std::cout << "\n== Test 2: read-ahead and rate ==\n";
+    static Rig r;
+    r.Init(960);
+    record(r, 48000 * 60);
+
+    r.buf.SetLatency(240);
+    play(r, 48000 * 60, 4.0, 48000 * 20, 12000);
+    const size_t misses = r.buf.GetMisses();
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "read-ahead for 5 ms: %zu misses counted", misses);
+    CHECK(misses > 0, msg);
+
+    r.buf.SetLatency(12000 + 2 * 960 + 240); // the stall, a load and a write back, the loop
+    CHECK(play(r, 48000 * 60, 4.0, 48000 * 20, 12000) && r.buf.GetMisses() == misses,
+          "read-ahead for 250 ms at 4x: none");
+    std::fclose(r.disk.f);
+}
+
+int main()
+{
+    std::cout << "Running streamed buffer tests...\n";
+    test_long_loop();
+    test_misses();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -0,0 +1,257 @@
+#pragma once
+#ifndef HUGO_LIB_SUMMARY_H
+#define HUGO_LIB_SUMMARY_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+
+namespace daisysp
+{
+
+/**
+   @brief Min, max and RMS of a record buffer at 256, 4k and 64k frames a
+          cell, kept up to date by the writes themselves.
+
+   Each write widens the min/max of the cells above it and moves their sum
+   of squares by new² - old², three levels of a compare or two and a
+   multiply-add. An overwritten extreme can't be taken back that way, so
+   when the head moves off a 256 frame cell that cell is rescanned (256
+   reads for 256 writes) and the two cells above it are rebuilt from their
+   16 children. Only the cell under the head can read wider than it is.
+
+   Query() answers any range from the coarsest cells that fit in it and at
+   most 15 cells a side on each finer level: a few dozen cells, however
+   long the range, where a scan would read every sample. Ranges are
+   rounded out to whole 256 frame cells.
+
+   Writes and rescans all happen on the writing side (the audio
+   interrupt); the main loop only ever reads cells.
+*/
+template <typename Buf>
+class SummaryPyramid
+{
+  public:
+    SummaryPyramid() {}
+    ~SummaryPyramid() {}
+
+    static constexpr size_t kLevels    = 3;
+    static constexpr size_t kCellLog2  = 8; // 256 frames
+    static constexpr size_t kFanLog2   = 4; // 16 cells make the next one up
+    static constexpr size_t kFan       = (size_t)1 << kFanLog2;
+
+    struct Cell
+    {
+        float min, max, sumsq;
+    };
+
+    /// what a range holds
+    struct Stats
+    {
+        float  min = 0.f, max = 0.f, sumsq = 0.f;
+        size_t frames = 0, chans = 1; // what it covers (whole cells)
+        float  Peak() const { return fmaxf(-min, max); }
+        float  Rms() const
+        {
+            return frames > 0 ? sqrtf(sumsq / (float)(frames * chans)) : 0.f;
+        }
+    };
+
+    /// cells needed for a buffer of `frames`, all levels
+    static constexpr size_t CellsFor(size_t frames)
+    {
+        return Count(frames, 0) + Count(frames, 1) + Count(frames, 2);
+    }
+
+    /**
+       buf: the buffer summarized, `frames` of `chans` (a power of two)
+       floats; cells: room for CellsFor(frames), cleared here (a buffer
+       nothing has been written to reads as silence).
+    */
+    void Init(const Buf* buf, size_t frames, size_t chans, Cell* cells, size_t num_cells)
+    {
+        buf_       = buf;
+        frames_    = frames;
+        chans_     = chans;
+        chan_log2_ = 0;
+        while(((size_t)1 << chan_log2_) < chans)
+            chan_log2_++;
+        for(size_t l = 0, off = 0; l < kLevels; l++)
+        {
+            count_[l] = Count(frames, l);
+            level_[l] = cells + off;
+            off += count_[l];
+        }
+        if(num_cells < CellsFor(frames))
+            frames_ = count_[0] = count_[1] = count_[2] = 0; // summarize nothing
+        Clear();
+    }
+
+    /// the buffer has been cleared: every cell is silence
+    void Clear()
+    {
+        for(size_t l = 0; l < kLevels; l++)
+            if(count_[l] > 0)
+                memset(level_[l], 0, count_[l] * sizeof(Cell));
+        open_ = kNone;
+    }
+
+    /// float `i` of the buffer goes from `old` to `x` (before it's stored)
+    inline void Update(size_t i, float old, float x)
+    {
+        size_t c = i >> (chan_log2_ + kCellLog2);
+        if(c >= count_[0])
+            return;
+        if(c != open_)
+        {
+            Settle();
+            open_ = c;
+        }
+        const float d = x * x - old * old;
+        for(size_t l = 0; l < kLevels; l++, c >>= kFanLog2)
+        {
+            Cell& cell = level_[l][c];
+            cell.min   = x < cell.min ? x : cell.min;
+            cell.max   = x > cell.max ? x : cell.max;
+            cell.sumsq += d;
+        }
+    }
+
+    /**
+       the head has stopped (or jumped): make the cell it was on exact.
+       From the writing side, like Update().
+    */
+    void Settle()
+    {
+        if(open_ == kNone)
+            return;
+        size_t c = open_;
+        open_    = kNone;
+
+        // rescan the bottom cell
+        const size_t begin = (c << kCellLog2) << chan_log2_;
+        size_t       end   = ((c + 1) << kCellLog2) << chan_log2_;
+        end                = end < (frames_ << chan_log2_) ? end : frames_ << chan_log2_;
+        const float x0     = buf_->Read(begin);
+        Cell        cell   = {x0, x0, 0.f};
+        for(size_t i = begin; i < end; i++)
+        {
+            const float x = buf_->Read(i);
+            cell.min      = x < cell.min ? x : cell.min;
+            cell.max      = x > cell.max ? x : cell.max;
+            cell.sumsq += x * x;
+        }
+        level_[0][c] = cell;
+
+        // and rebuild the ones above from their children
+        for(size_t l = 1; l < kLevels; l++)
+        {
+            c                 = c >> kFanLog2;
+            const size_t from = c << kFanLog2;
+            size_t       to   = from + kFan;
+            to                = to < count_[l - 1] ? to : count_[l - 1];
+            Cell up           = level_[l - 1][from];
+            up.sumsq          = 0.f;
+            for(size_t k = from; k < to; k++)
+                Merge(up, level_[l - 1][k]);
+            level_[l][c] = up;
+        }
+    }
+
+    /// what frames [begin, end) hold, rounded out to whole 256 frame cells
+    Stats Query(size_t begin, size_t end) const
+    {
+        Stats s;
+        s.chans = chans_;
+        end     = end < frames_ ? end : frames_;
+        if(begin >= end)
+            return s;
+        size_t lo = begin >> kCellLog2;
+        size_t hi = (end + (1 << kCellLog2) - 1) >> kCellLog2;
+        const size_t last = (hi << kCellLog2) < frames_ ? hi << kCellLog2 : frames_;
+        s.frames          = last - (lo << kCellLog2);
+
+        Cell acc = {INFINITY, -INFINITY, 0.f};
+        for(size_t l = 0; lo < hi; l++)
+        {
+            if(l + 1 == kLevels)
+            {
+                while(lo < hi)
+                    Merge(acc, level_[l][lo++]);
+                break;
+            }
+            // the ragged ends on this level, then up a level
+            while(lo < hi && (lo & (kFan - 1)) != 0)
+                Merge(acc, level_[l][lo++]);
+            while(lo < hi && (hi & (kFan - 1)) != 0)
+                Merge(acc, level_[l][--hi]);
+            lo >>= kFanLog2;
+            hi >>= kFanLog2;
+        }
+        s.min   = acc.min;
+        s.max   = acc.max;
+        s.sumsq = acc.sumsq;
+        return s;
+    }
+
+    /// the cells of a level, for drawing: `level` 0 is 256 frames a cell
+    const Cell* GetCells(size_t level) const { return level_[level]; }
+    size_t      GetNumCells(size_t level) const { return count_[level]; }
+
+  private:
+    static constexpr size_t kNone = (size_t)-1;
+
+    static constexpr size_t Count(size_t frames, size_t level)
+    {
+        return (frames + ((size_t)1 << (kCellLog2 + kFanLog2 * level)) - 1)
+               >> (kCellLog2 + kFanLog2 * level);
+    }
+
+    static inline void Merge(Cell& a, const Cell& b)
+    {
+        a.min = b.min < a.min ? b.min : a.min;
+        a.max = b.max > a.max ? b.max : a.max;
+        a.sumsq += b.sumsq;
+    }
+
+    const Buf* buf_       = nullptr;
+    size_t     frames_    = 0;
+    size_t     chans_     = 1;
+    size_t     chan_log2_ = 0;
+    Cell*      level_[kLevels];
+    size_t     count_[kLevels] = {0, 0, 0};
+    size_t     open_           = kNone; // the bottom cell under the head
+};
+
+/// an Ipoke store writing into a buffer and its SummaryPyramid
+template <typename Buf>
+struct SummaryStore
+{
+    /// a write on its way in: tells the pyramid what it replaces
+    struct Ref
+    {
+        SummaryPyramid<Buf>* sum;
+        size_t               i;
+        float&               x;
+        inline Ref&          operator=(float v)
+        {
+            sum->Update(i, x, v);
+            x = v;
+            return *this;
+        }
+        inline operator float() const { return x; }
+    };
+
+    SummaryStore(Buf* buf = nullptr, SummaryPyramid<Buf>* sum = nullptr) : buf_(buf), sum_(sum) {}
+    inline float Read(size_t i) const { return buf_->Read(i); }
+    inline Ref   Write(size_t i) { return {sum_, i, buf_->Write(i)}; }
+    Buf*                 buf_;
+    SummaryPyramid<Buf>* sum_;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_SUMMARY_H
@@ -0,0 +1,232 @@
+// summary_test.cpp
+// SummaryPyramid: kept right by Ipoke's writes (varispeed, overdubs,
+// quieter takes over louder ones), what it adds to every written sample,
+// and range queries against a scan of the samples.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../DaisySP/Source summary_test.cpp
+//       ../DaisySP/build/libdaisysp.a -o summary_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "arena.h"
+#include "ipoke.h"
+#include "summary.h"
+
+using namespace daisysp;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+using Summary = SummaryPyramid<LazyBuffer>;
+
+static constexpr size_t kFrames = 48000 * 10; // the glitch pedal's buffer
+static constexpr size_t kChans  = 2;
+
+struct Rig
+{
+    std::vector<float>         mem   = std::vector<float>(kFrames * kChans);
+    std::vector<Summary::Cell> cells = std::vector<Summary::Cell>(Summary::CellsFor(kFrames));
+    LazyBuffer                 buf;
+    Summary                    sum;
+    IpokeT<SummaryStore<LazyBuffer>> poker;
+    void Init()
+    {
+        buf.Init(mem.data(), mem.size());
+        sum.Init(&buf, kFrames, kChans, cells.data(), cells.size());
+        poker.Init({&buf, &sum}, kFrames, kChans);
+    }
+};
+
+static float noise(uint32_t& s)
+{
+    s = s * 1664525u + 1013904223u;
+    return (float)(int32_t)s * (1.f / 2147483648.f);
+}
+
+// a pass of the head over the whole buffer at `rate`, `gain` times noise
+void pass(Rig& r, float rate, float gain, float overdub, uint32_t seed)
+{
+    r.poker.SetOverdub(overdub);
+    r.poker.ResetIndex();
+    float in[kChans];
+    for (float pos = 0.f; pos < (float)kFrames; pos += rate) {
+        for (size_t c = 0; c < kChans; c++)
+            in[c] = gain * noise(seed);
+        r.poker.Poke(pos, in);
+    }
+    r.poker.Poke(-1.f, in);
+    r.sum.Settle();
+}
+
+// the same thing the slow way, over the same whole cells
+Summary::Stats scan(const LazyBuffer& buf, size_t begin, size_t end)
+{
+    begin = begin >> Summary::kCellLog2 << Summary::kCellLog2;
+    end   = std::min(kFrames, (end + 255) >> Summary::kCellLog2 << Summary::kCellLog2);
+    Summary::Stats s;
+    s.chans  = kChans;
+    s.frames = end - begin;
+    s.min    = INFINITY;
+    s.max    = -INFINITY;
+    double sq = 0.0;
+    for (size_t i = begin * kChans; i < end * kChans; i++) {
+        const float x = buf.Read(i);
+        s.min = std::min(s.min, x);
+        s.max = std::max(s.max, x);
+        sq += (double)x * x;
+    }
+    s.sumsq = (float)sq;
+    return s;
+}
+
+bool same(const Summary::Stats& a, const Summary::Stats& b)
+{
+    return a.frames == b.frames && a.min == b.min && a.max == b.max
+           && std::fabs(a.Rms() - b.Rms()) <= 1e-3f * b.Rms() + 1e-7f;
+}
+
+// random ranges, short and long; true if every one matches a scan
+bool all_match(Rig& r, size_t queries)
+{
+    uint32_t seed = 7;
+    bool     ok   = true;
+    for (size_t q = 0; q < queries; q++) {
+        const size_t a = (size_t)(noise(seed) * 0.5f * kFrames + 0.5f * kFrames);
+        size_t       n = (size_t)std::fabs(noise(seed) * kFrames);
+        if (q % 3 == 0)
+            n = n / 1000; // short ones too
+        ok = same(r.sum.Query(a, a + n + 1), scan(r.buf, a, a + n + 1)) && ok;
+    }
+    return ok && same(r.sum.Query(0, kFrames), scan(r.buf, 0, kFrames));
+}
+
+// Test 1: the pyramid follows what's in the buffer
+void test_tracking()
+{
+    std::cout << "\n== Test 1: kept up to date by Ipoke's writes ==\n";
+    static Rig r;
+    r.Init();
+    Summary::Stats empty = r.sum.Query(0, kFrames);
+    CHECK(empty.Peak() == 0.f && empty.Rms() == 0.f, "nothing written: silence");
+
+    pass(r, 1.f, 0.9f, 0.f, 1);
+    CHECK(all_match(r, 200), "a take at 1x: every range matches a scan");
+    pass(r, 1.37f, 0.5f, 0.7f, 2);
+    CHECK(all_match(r, 200), "an overdub at 1.37x (gaps filled): still");
+    pass(r, 0.6f, 0.01f, 0.f, 3);
+    CHECK(all_match(r, 200), "a quiet take at 0.6x over a loud one: the peaks come down");
+    CHECK(r.sum.Query(0, kFrames).Peak() <= 0.01f, "and the whole buffer reads quiet");
+
+    // a loud burst in the middle of the quiet take
+    r.poker.SetOverdub(0.f);
+    r.poker.ResetIndex();
+    const float loud[kChans] = {0.8f, -0.8f};
+    for (size_t i = 200000; i < 200100; i++)
+        r.poker.Poke((float)i, loud);
+    r.poker.Poke(-1.f, loud);
+    CHECK(r.sum.Query(199000, 201000).Peak() >= 0.8f, "a burst shows in a range around it, head still on it");
+    CHECK(r.sum.Query(0, 190000).Peak() <= 0.01f && r.sum.Query(210000, kFrames).Peak() <= 0.01f,
+          "and not on either side");
+    r.sum.Settle();
+    CHECK(all_match(r, 200), "settled: every range matches a scan");
+
+    r.buf.Clear();
+    r.sum.Clear();
+    CHECK(r.sum.Query(0, kFrames).Peak() == 0.f, "cleared: silence again");
+}
+
+template <typename F>
+double ns_per(F&& run, size_t n)
+{
+    double best = 1e9;
+    for (int k = 0; k < 3; k++) { // best of three, the host's timing is noisy
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+    }
+    return best;
+}
+
+// Test 2: what keeping it up to date costs a written sample
+void test_update_cost()
+{
+    std::cout << "\n== Test 2: cost per written sample ==\n";
+    static Rig r;
+    r.Init();
+    IpokeT<StoreRef<LazyBuffer>> plain;
+    plain.Init(&r.buf, kFrames, kChans);
+    plain.SetOverdub(0.5f);
+    r.poker.SetOverdub(0.5f);
+
+    std::vector<float> in(kFrames * kChans);
+    uint32_t           seed = 11;
+    for (auto& x : in)
+        x = 0.5f * noise(seed);
+    const double without = ns_per([&] {
+        plain.ResetIndex();
+        for (size_t i = 0; i < kFrames; i++)
+            plain.Poke((float)i, &in[i * kChans]);
+    }, kFrames * kChans);
+    const double with = ns_per([&] {
+        r.poker.ResetIndex();
+        for (size_t i = 0; i < kFrames; i++)
+            r.poker.Poke((float)i, &in[i * kChans]);
+    }, kFrames * kChans);
+    std::printf("Ipoke: %.2f ns per sample, %.2f with the summary (+%.2f)\n", without, with,
+                with - without);
+    CHECK(with - without < 20.0, "the summary adds a few ns to a written sample");
+}
+
+static volatile float sink; // keeps the timed loops from being optimized out
+
+// Test 3: queries against a scan
+void test_query_cost()
+{
+    std::cout << "\n== Test 3: range queries ==\n";
+    static Rig r;
+    r.Init();
+    pass(r, 1.f, 0.5f, 0.f, 5);
+
+    const size_t lengths[] = {4800, 48000, kFrames - 1000};
+    for (size_t len : lengths) {
+        const size_t n   = 2000;
+        float        acc = 0.f;
+        const double tq  = ns_per([&] {
+            for (size_t q = 0; q < n; q++)
+                acc += r.sum.Query(q * 97 % 1000, q * 97 % 1000 + len).Rms();
+        }, n);
+        const size_t m  = std::max<size_t>(1, n * 4800 / len / 10);
+        const double ts = ns_per([&] {
+            for (size_t q = 0; q < m; q++)
+                acc += scan(r.buf, q * 97 % 1000, q * 97 % 1000 + len).Rms();
+        }, m);
+        sink = acc;
+        char msg[128];
+        std::snprintf(msg, sizeof(msg), "%.2f s: query %.0f ns, scan %.0f ns (%.0fx)", len / 48000.0,
+                      tq, ts, ts / tq);
+        CHECK(tq * 10.0 < ts, msg);
+    }
+}
+
+int main()
+{
+    std::cout << "Running summary pyramid tests...\n";
+    test_tracking();
+    test_update_cost();
+    test_query_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -0,0 +1,271 @@
+#pragma once
+#ifndef HUGO_LIB_TIMELINE_H
+#define HUGO_LIB_TIMELINE_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace daisysp
+{
+
+/**
+   @brief A binary timeline of time-stamped control events.
+
+   Layout (little-endian, as on both the Daisy and the host):
+
+       TimelineHeader   16 bytes
+       TimelineEvent[]   8 bytes each, sorted by time
+
+   Times are in samples from the start of the run, so a replay applies
+   every event on the sample it happened on. Only changes are stored: a
+   knob that isn't turned costs nothing.
+
+   The events are read in place: TimelineReader points into the bytes it
+   is given (a buffer, or a memory-mapped file on host) without copying.
+*/
+
+struct TimelineHeader
+{
+    char     magic[4];    // "CTLN"
+    uint16_t version;     // kTimelineVersion
+    uint16_t event_size;  // sizeof(TimelineEvent)
+    float    sample_rate; // of the event times
+    uint32_t count;       // events that follow
+};
+
+struct TimelineEvent
+{
+    enum TYPE : uint8_t
+    {
+        KNOB,       ///< value: 0..65535 for 0..1
+        SWITCH,     ///< value: the new position (an edge)
+        FOOTSWITCH, ///< value: a FOOTSWITCH_ACTION
+    };
+
+    enum FOOTSWITCH_ACTION : uint16_t
+    {
+        RELEASE,
+        PRESS,
+        HOLD, ///< still down after the hold time
+    };
+
+    uint32_t time;  ///< sample
+    uint8_t  type;  ///< TYPE
+    uint8_t  id;    ///< which knob / switch / footswitch (from 0)
+    uint16_t value;
+
+    float Knob() const { return value * (1.f / 65535.f); }
+};
+
+static constexpr uint16_t kTimelineVersion = 1;
+
+static_assert(sizeof(TimelineHeader) == 16, "timeline header layout");
+static_assert(sizeof(TimelineEvent) == 8, "timeline event layout");
+
+/**
+   Writes a timeline into a caller-owned buffer. The header's count is
+   kept current, so the buffer is a valid timeline after every Add().
+*/
+class TimelineWriter
+{
+  public:
+    TimelineWriter() {}
+    ~TimelineWriter() {}
+
+    /// buf must be 4-byte aligned; false if it can't hold the header
+    bool Init(void* buf, size_t size, float sample_rate)
+    {
+        buf_      = static_cast<uint8_t*>(buf);
+        capacity_ = size < sizeof(TimelineHeader)
+                        ? 0
+                        : (size - sizeof(TimelineHeader)) / sizeof(TimelineEvent);
+        count_    = 0;
+        last_     = 0;
+        if(size < sizeof(TimelineHeader))
+            return false;
+
+        TimelineHeader h;
+        memcpy(h.magic, "CTLN", 4);
+        h.version     = kTimelineVersion;
+        h.event_size  = sizeof(TimelineEvent);
+        h.sample_rate = sample_rate;
+        h.count       = 0;
+        memcpy(buf_, &h, sizeof(h));
+        return true;
+    }
+
+    /// false when full, or if `e` is earlier than the last event
+    bool Add(const TimelineEvent& e)
+    {
+        if(count_ >= capacity_ || (count_ > 0 && e.time < last_))
+            return false;
+        memcpy(buf_ + sizeof(TimelineHeader) + count_ * sizeof(TimelineEvent), &e, sizeof(e));
+        count_++;
+        last_ = e.time;
+        memcpy(buf_ + offsetof(TimelineHeader, count), &count_, sizeof(count_));
+        return true;
+    }
+
+    bool Knob(uint32_t time, uint8_t id, float value)
+    {
+        value = value < 0.f ? 0.f : (value > 1.f ? 1.f : value);
+        return Add({time, TimelineEvent::KNOB, id, (uint16_t)(value * 65535.f + 0.5f)});
+    }
+
+    bool Switch(uint32_t time, uint8_t id, bool on)
+    {
+        return Add({time, TimelineEvent::SWITCH, id, (uint16_t)on});
+    }
+
+    bool Footswitch(uint32_t time, uint8_t id, TimelineEvent::FOOTSWITCH_ACTION action)
+    {
+        return Add({time, TimelineEvent::FOOTSWITCH, id, action});
+    }
+
+    size_t GetCount() const { return count_; }
+
+    /// bytes written so far (what to save)
+    size_t GetSize() const
+    {
+        return sizeof(TimelineHeader) + count_ * sizeof(TimelineEvent);
+    }
+
+  private:
+    uint8_t* buf_      = nullptr;
+    size_t   capacity_ = 0;
+    uint32_t count_    = 0;
+    uint32_t last_     = 0;
+};
+
+/**
+   A read-only view of a timeline in memory. Nothing is copied: events()
+   points into the bytes passed to Init(), which must outlive the reader.
+*/
+class TimelineReader
+{
+  public:
+    TimelineReader() {}
+    ~TimelineReader() {}
+
+    /// false if the bytes aren't a (complete, 4-byte aligned) timeline
+    bool Init(const void* data, size_t size)
+    {
+        events_ = nullptr;
+        count_  = 0;
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        if(size < sizeof(TimelineHeader) || reinterpret_cast<uintptr_t>(bytes) % 4)
+            return false;
+        const TimelineHeader* h = reinterpret_cast<const TimelineHeader*>(bytes);
+        if(memcmp(h->magic, "CTLN", 4) != 0 || h->version != kTimelineVersion
+           || h->event_size != sizeof(TimelineEvent)
+           || h->count > (size - sizeof(TimelineHeader)) / sizeof(TimelineEvent))
+            return false;
+
+        sample_rate_ = h->sample_rate;
+        count_       = h->count;
+        events_ = reinterpret_cast<const TimelineEvent*>(bytes + sizeof(TimelineHeader));
+        return true;
+    }
+
+    float GetSampleRate() const { return sample_rate_; }
+    size_t GetCount() const { return count_; }
+    const TimelineEvent* events() const { return events_; }
+    const TimelineEvent& operator[](size_t i) const { return events_[i]; }
+
+    /// time of the last event (0 if empty)
+    uint32_t GetEndTime() const { return count_ ? events_[count_ - 1].time : 0; }
+
+    /// index of the first event at or after `time`
+    size_t Find(uint32_t time) const
+    {
+        size_t lo = 0, hi = count_;
+        while(lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            if(events_[mid].time < time)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+  private:
+    const TimelineEvent* events_      = nullptr;
+    size_t               count_       = 0;
+    float                sample_rate_ = 0.f;
+};
+
+/**
+   Replays a timeline into a block-based process, sample-accurately: blocks
+   are split wherever an event falls, so apply(event) runs right before the
+   sample the event is stamped with.
+
+       TimelinePlayer player;
+       player.Init(reader);
+       player.Render(len, 48,
+                     [&](const TimelineEvent& e) { ... },
+                     [&](uint32_t time, size_t size) { ... });
+*/
+class TimelinePlayer
+{
+  public:
+    TimelinePlayer() {}
+    ~TimelinePlayer() {}
+
+    void Init(const TimelineReader& reader)
+    {
+        reader_ = &reader;
+        Seek(0);
+    }
+
+    /// continue from `time` (events before it are skipped, not applied)
+    void Seek(uint32_t time)
+    {
+        time_ = time;
+        next_ = reader_->Find(time);
+    }
+
+    uint32_t GetTime() const { return time_; }
+
+    bool Done() const { return next_ >= reader_->GetCount(); }
+
+    /**
+       Render `len` samples from the current time, in blocks of at most
+       max_block (cut short at events).
+    */
+    template <typename Apply, typename Process>
+    void Render(size_t len, size_t max_block, Apply&& apply, Process&& process)
+    {
+        const uint32_t end = time_ + (uint32_t)len;
+        while(time_ < end)
+        {
+            const TimelineEvent* ev = reader_->events();
+            while(next_ < reader_->GetCount() && ev[next_].time <= time_)
+                apply(ev[next_++]);
+
+            uint32_t stop = end;
+            if(next_ < reader_->GetCount() && ev[next_].time < stop)
+                stop = ev[next_].time;
+            if(stop - time_ > max_block)
+                stop = time_ + (uint32_t)max_block;
+
+            process(time_, (size_t)(stop - time_));
+            time_ = stop;
+        }
+    }
+
+  private:
+    const TimelineReader* reader_ = nullptr;
+    size_t                next_   = 0;
+    uint32_t              time_   = 0;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_TIMELINE_H
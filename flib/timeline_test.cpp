@@ -0,0 +1,162 @@
+// timeline_test.cpp
+// Control event timelines: a round trip through a memory-mapped file,
+// sample-accurate replay, and what a run costs to store.
+// build: g++ -O2 -std=c++14 timeline_test.cpp -o timeline_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "timeline.h"
+
+using daisysp::TimelineEvent;
+using daisysp::TimelineWriter;
+using daisysp::TimelineReader;
+using daisysp::TimelinePlayer;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float kSr = 48000.f;
+
+// Test 1: written to a file and memory-mapped back, the reader sees the
+// same events, in the mapping itself
+void test_mmap()
+{
+    std::cout << "\n== Test 1: file round trip ==\n";
+    std::vector<uint32_t> buf(256);
+    TimelineWriter w;
+    CHECK(w.Init(buf.data(), buf.size() * 4, kSr), "writer init");
+    w.Knob(0, 2, 0.25f);
+    w.Switch(10, 1, true);
+    w.Footswitch(480, 0, TimelineEvent::PRESS);
+    w.Footswitch(480 + 14400, 0, TimelineEvent::HOLD);
+    w.Knob(20000, 5, 1.f);
+
+    char path[] = "/tmp/timeline_testXXXXXX";
+    const int fd = mkstemp(path);
+    CHECK(fd >= 0 && write(fd, buf.data(), w.GetSize()) == (ssize_t)w.GetSize(), "written to a file");
+    void* map = mmap(nullptr, w.GetSize(), PROT_READ, MAP_PRIVATE, fd, 0);
+    CHECK(map != MAP_FAILED, "mapped");
+
+    TimelineReader r;
+    CHECK(r.Init(map, w.GetSize()), "reader accepts the mapping");
+    CHECK(r.events() == (const TimelineEvent*)((const char*)map + 16), "events read in place");
+    CHECK(r.GetCount() == 5 && r.GetSampleRate() == kSr && r.GetEndTime() == 20000, "header");
+    CHECK(r[0].type == TimelineEvent::KNOB && r[0].id == 2 && std::fabs(r[0].Knob() - 0.25f) < 1e-4f,
+          "knob event");
+    CHECK(r[1].type == TimelineEvent::SWITCH && r[1].value == 1, "switch edge");
+    CHECK(r[3].type == TimelineEvent::FOOTSWITCH && r[3].value == TimelineEvent::HOLD, "footswitch hold");
+    CHECK(r.Find(480) == 2 && r.Find(481) == 3 && r.Find(30000) == 5, "Find()");
+
+    CHECK(!r.Init(map, w.GetSize() - 1), "truncated file rejected");
+    munmap(map, w.GetSize());
+    close(fd);
+    unlink(path);
+
+    buf[0] = 0;
+    CHECK(!r.Init(buf.data(), w.GetSize()), "bad magic rejected");
+
+    TimelineWriter small;
+    uint32_t tiny[4 + 2 * 2];
+    small.Init(tiny, sizeof(tiny), kSr);
+    CHECK(small.Knob(5, 0, 0.f) && !small.Knob(4, 0, 0.f), "out of order event refused");
+    CHECK(small.Knob(5, 0, 0.f) && !small.Knob(6, 0, 0.f), "full writer refuses");
+}
+
+// Test 2: replayed through blocks of 48, every event lands on its sample
+void test_sample_accurate()
+{
+    std::cout << "\n== Test 2: sample-accurate replay ==\n";
+    std::vector<uint32_t> buf(64);
+    TimelineWriter w;
+    w.Init(buf.data(), buf.size() * 4, kSr);
+    const uint32_t at[]  = {0, 137, 138, 500, 901};
+    const float    val[] = {0.25f, 0.5f, 1.f, 0.75f, 0.f};
+    for (size_t i = 0; i < 5; i++)
+        w.Knob(at[i], 0, val[i]);
+
+    TimelineReader r;
+    r.Init(buf.data(), w.GetSize());
+    TimelinePlayer player;
+    player.Init(r);
+
+    const size_t len = 1000;
+    std::vector<float> out(len);
+    float gain = 1.f;
+    size_t blocks = 0;
+    player.Render(len, 48,
+                  [&](const TimelineEvent& e) { gain = e.Knob(); },
+                  [&](uint32_t t, size_t n) {
+                      for (size_t i = 0; i < n; i++)
+                          out[t + i] = gain; // a gain on DC
+                      blocks++;
+                  });
+
+    bool exact = true;
+    for (size_t i = 0; i < len; i++) {
+        size_t k = 0;
+        while (k + 1 < 5 && at[k + 1] <= i)
+            k++;
+        exact = exact && std::fabs(out[i] - val[k]) < 1e-4f;
+    }
+    CHECK(exact, "each value starts on its event's sample");
+    std::printf("(%zu blocks for %zu samples)\n", blocks, len);
+
+    player.Seek(600);
+    gain = -1.f;
+    player.Render(400, 48, [&](const TimelineEvent& e) { gain = e.Knob(); },
+                  [&](uint32_t t, size_t n) {
+                      for (size_t i = 0; i < n; i++)
+                          out[t + i] = gain;
+                  });
+    CHECK(out[600] == -1.f && out[900] == -1.f && out[901] == 0.f, "Seek() skips earlier events");
+}
+
+// Test 3: a ten minute run with a few gestures, stored as events vs as
+// state snapshots every 2-sample block
+void test_size()
+{
+    std::cout << "\n== Test 3: storage ==\n";
+    const uint32_t len = (uint32_t)kSr * 600;
+    std::vector<uint32_t> buf(1 << 16);
+    TimelineWriter w;
+    w.Init(buf.data(), buf.size() * 4, kSr);
+
+    // six knobs set once, one swept for 5 s (knob values change every
+    // 10 ms block of the sweep), four switch flips, a footswitch press
+    for (uint8_t k = 0; k < 6; k++)
+        w.Knob(0, k, 0.5f);
+    for (uint32_t t = 0; t < (uint32_t)kSr * 5; t += 480)
+        w.Knob((uint32_t)kSr * 60 + t, 1, t / (kSr * 5));
+    for (uint32_t i = 0; i < 4; i++)
+        w.Switch((uint32_t)kSr * (120 + 60 * i), 2, i % 2 == 0);
+    w.Footswitch((uint32_t)kSr * 400, 1, TimelineEvent::PRESS);
+    w.Footswitch((uint32_t)kSr * 401, 1, TimelineEvent::RELEASE);
+
+    const double snapshots = (len / 2.0) * (6 * sizeof(float) + 4 * sizeof(bool));
+    std::printf("events: %zu bytes, snapshots: %.0f MB (%.0fx)\n", w.GetSize(), snapshots / 1e6,
+                snapshots / w.GetSize());
+    CHECK(w.GetSize() < 8192, "ten minutes in under 8 KB");
+}
+
+int main()
+{
+    std::cout << "Running timeline tests...\n";
+    test_mmap();
+    test_sample_accurate();
+    test_size();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
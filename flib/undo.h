@@ -0,0 +1,292 @@
+#pragma once
+#ifndef HUGO_LIB_UNDO_H
+#define HUGO_LIB_UNDO_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include "arena.h"
+
+namespace daisysp
+{
+
+/**
+   @brief Undo levels for a buffer that gets written over in place (a
+          looper's overdubs), keeping only the pages that were touched.
+
+   Between Begin() and End(), the first write to each page (512 floats)
+   saves what was there, into chunks from the same arena. The saved pages
+   are logged as runs of consecutive pages, so a level costs memory in
+   proportion to what was written over, not to the buffer.
+
+   Undo() and Redo() swap a level's pages with the buffer's, a few pages
+   per Process() call, so neither they nor the saving (one page at a time,
+   as writes reach it) ever take long on the audio thread. A level that
+   can't be saved whole (the arena ran out) is dropped rather than kept
+   half done.
+*/
+template <typename Live, size_t MaxChunks, size_t Levels = 2>
+class UndoLog
+{
+  public:
+    UndoLog() {}
+    ~UndoLog() {}
+
+    using Buffer = ChunkedBuffer<MaxChunks>; // where saved pages go
+
+    static constexpr size_t kPageLog2   = 9; // 512 floats a page
+    static constexpr size_t kPage       = (size_t)1 << kPageLog2;
+    static constexpr size_t kMaxRegions = 64; // runs of pages, per level
+
+    void Init(ChunkArena* arena, Live* live)
+    {
+        live_  = live;
+        chans_ = arena->GetChans();
+        for(size_t i = 0; i < Levels; i++)
+        {
+            layers_[i].pages.Init(arena);
+            layers_[i].Reset();
+            stack_[i] = &layers_[i];
+        }
+        num_undo_ = num_redo_ = 0;
+        open_     = false;
+        job_      = nullptr;
+    }
+
+    /**
+       start saving what gets written over, as a new level: drops anything
+       to redo, and the oldest level when they're all in use. Not while
+       Busy().
+    */
+    void Begin()
+    {
+        DropRedo();
+        if(num_undo_ == Levels)
+        {
+            Layer* oldest = stack_[0];
+            oldest->Reset();
+            for(size_t i = 1; i < Levels; i++)
+                stack_[i - 1] = stack_[i];
+            stack_[Levels - 1] = oldest;
+            num_undo_--;
+        }
+        stack_[num_undo_++]->Reset();
+        open_      = true;
+        last_page_ = kNoPage;
+    }
+
+    /// stop saving (the level stays, to undo)
+    void End() { open_ = false; }
+
+    /// float i of the buffer is about to be written
+    inline void Touch(size_t i)
+    {
+        const size_t page = i >> kPageLog2;
+        if(open_ && page != last_page_)
+            Save(page);
+    }
+
+    /// start undoing the newest level; false if there's none, or busy
+    bool Undo()
+    {
+        if(Busy() || num_undo_ == 0)
+            return false;
+        End();
+        StartJob(stack_[num_undo_ - 1], true);
+        return true;
+    }
+
+    /// start redoing the last level undone; false if there's none, or busy
+    bool Redo()
+    {
+        if(Busy() || num_redo_ == 0)
+            return false;
+        StartJob(stack_[num_undo_], false);
+        return true;
+    }
+
+    /// swap up to `pages` pages of a pending undo/redo, once per block
+    void Process(size_t pages)
+    {
+        while(job_ != nullptr && pages-- > 0)
+        {
+            const Region& r    = job_->regions[job_region_];
+            const size_t  live = (r.first + job_page_) << kPageLog2;
+            const size_t  kept = job_slot_ << kPageLog2;
+            live_->ReadSpan(live, a_, kPage);
+            job_->pages.ReadSpan(kept, b_, kPage);
+            live_->WriteSpan(live, b_, kPage);
+            job_->pages.WriteSpan(kept, a_, kPage);
+
+            job_slot_++;
+            if(++job_page_ == r.count)
+            {
+                job_page_ = 0;
+                if(++job_region_ == job_->num_regions)
+                    FinishJob();
+            }
+        }
+    }
+
+    /// an undo or redo is under way
+    bool Busy() const { return job_ != nullptr; }
+
+    /// what gets written over is being saved
+    bool IsOpen() const { return open_; }
+
+    /// forget every level (the buffer is being cleared)
+    void Clear()
+    {
+        job_  = nullptr;
+        open_ = false;
+        for(size_t i = 0; i < Levels; i++)
+            layers_[i].Reset();
+        num_undo_ = num_redo_ = 0;
+    }
+
+    size_t GetNumUndo() const { return num_undo_; }
+    size_t GetNumRedo() const { return num_redo_; }
+
+    /// pages saved, over every level
+    size_t GetSavedPages() const
+    {
+        size_t n = 0;
+        for(size_t i = 0; i < Levels; i++)
+            n += layers_[i].num_pages;
+        return n;
+    }
+
+    /// arena memory held, in frames
+    size_t GetMemoryFrames() const
+    {
+        size_t n = 0;
+        for(size_t i = 0; i < Levels; i++)
+            n += layers_[i].pages.GetCapacityFrames();
+        return n;
+    }
+
+  private:
+    static constexpr size_t kNoPage = (size_t)-1;
+
+    struct Region
+    {
+        size_t first, count; // pages of the buffer
+    };
+
+    struct Layer
+    {
+        Buffer pages; // what was there, page after page in region order
+        Region regions[kMaxRegions];
+        size_t num_regions;
+        size_t num_pages;
+
+        void Reset()
+        {
+            pages.Release();
+            num_regions = 0;
+            num_pages   = 0;
+        }
+    };
+
+    void Save(size_t page)
+    {
+        last_page_ = page;
+        Layer* l   = stack_[num_undo_ - 1];
+        for(size_t r = 0; r < l->num_regions; r++)
+            if(page - l->regions[r].first < l->regions[r].count)
+                return; // saved already this level
+
+        if(((page + 1) << kPageLog2) > live_->GetCapacityFrames() * chans_)
+            return; // past the buffer: nothing there to lose
+
+        Region*    tail   = l->num_regions > 0 ? &l->regions[l->num_regions - 1] : nullptr;
+        const bool extend = tail != nullptr && tail->first + tail->count == page;
+        if((!extend && l->num_regions == kMaxRegions)
+           || !l->pages.Reserve(((l->num_pages + 1) << kPageLog2) / chans_))
+        {
+            // can't keep this level whole: give it up, and its memory back
+            l->Reset();
+            num_undo_--;
+            open_ = false;
+            return;
+        }
+
+        live_->ReadSpan(page << kPageLog2, a_, kPage);
+        l->pages.WriteSpan(l->num_pages << kPageLog2, a_, kPage);
+        if(extend)
+            tail->count++;
+        else
+            l->regions[l->num_regions++] = {page, 1};
+        l->num_pages++;
+    }
+
+    void StartJob(Layer* l, bool undo)
+    {
+        job_        = l;
+        job_undo_   = undo;
+        job_region_ = 0;
+        job_page_   = 0;
+        job_slot_   = 0;
+        if(l->num_regions == 0)
+            FinishJob(); // nothing was written over
+    }
+
+    void FinishJob()
+    {
+        if(job_undo_)
+        {
+            num_undo_--;
+            num_redo_++;
+        }
+        else
+        {
+            num_undo_++;
+            num_redo_--;
+        }
+        job_ = nullptr;
+    }
+
+    void DropRedo()
+    {
+        for(size_t i = num_undo_; i < num_undo_ + num_redo_; i++)
+            stack_[i]->Reset();
+        num_redo_ = 0;
+    }
+
+    Live*   live_  = nullptr;
+    size_t  chans_ = 1;
+
+    Layer  layers_[Levels];
+    Layer* stack_[Levels]; // levels to undo, oldest first, then ones to redo
+    size_t num_undo_ = 0;
+    size_t num_redo_ = 0;
+
+    bool   open_      = false;
+    size_t last_page_ = kNoPage;
+
+    Layer* job_ = nullptr; // the level being swapped in or out
+    bool   job_undo_;
+    size_t job_region_, job_page_, job_slot_;
+
+    float a_[kPage], b_[kPage]; // a page each way
+};
+
+/// an Ipoke store writing into a buffer through an UndoLog
+template <typename Buf, typename Log>
+struct UndoStore
+{
+    UndoStore(Buf* buf = nullptr, Log* log = nullptr) : buf_(buf), log_(log) {}
+    inline float Read(size_t i) const { return buf_->Read(i); }
+    inline float& Write(size_t i)
+    {
+        log_->Touch(i);
+        return buf_->Write(i);
+    }
+    Buf* buf_;
+    Log* log_;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_UNDO_H
@@ -5,7 +5,10 @@
 #ifdef __cplusplus
 
 
+#include <cmath>
+#include <cstddef>
 #include "daisysp.h"
+#include "paramramp.h"
 
 
 namespace daisysp
@@ -34,6 +37,14 @@ class VibratoEngine
         sample_rate_ = sample_rate;
         del_.Init();
         feedback_ = .2f;
+
+        // same glides as fonepole(x, target, 0.00007f) every sample
+        depth_.Init(sample_rate_, 0.f, ParamRamp::MODE::EXPONENTIAL, 0.f);
+        depth_.SetCoefficient(0.00007f);
+        delay_.Init(sample_rate_, 0.f, ParamRamp::MODE::EXPONENTIAL, 0.f);
+        delay_.SetCoefficient(0.00007f);
+        mix_.Init(sample_rate_, 0.f, ParamRamp::MODE::EXPONENTIAL, 1.f);
+        mix_.SetCoefficient(0.00007f);
         SetDelayMs(40.f);
 
         lfo_.Init(sample_rate);
@@ -41,38 +52,96 @@ class VibratoEngine
         lfo_.Reset();
         lfo_.SetFreq(0.5f); // 0.5 Hz
 
-
+        // ProcessBlock() LFO: phasor at phase 0, same rate as lfo_
+        lfo_cos_ = 1.f;
+        lfo_sin_ = 0.f;
+        SetLfoFreq(0.5f);
+        SetVoices(1);
     }
 
     float Process(float in)
     {
-        fonepole(depth_, depth_target_, 0.00007f);
-        // depth_ = depth_target_;
-        this->SetDelayMs(max_delay_ms_ * depth_);
-        
-        fonepole(delay_, delay_target_, 0.00007f);
+        const float depth = depth_.Process();
+        this->SetDelayMs(max_delay_ms_ * depth);
+
+        const float delay = delay_.Process();
 
-        float lfo_sig = linlin(lfo_.Process(), -1.f, 1.f, 0.f, depth_) * delay_;
+        if(IsIdle())
+        {
+            del_.Write(in);
+            return in;
+        }
+
+        float lfo_sig = linlin(lfo_.Process(), -1.f, 1.f, 0.f, depth) * delay;
         
         // smooth delay time
         del_.SetDelay(lfo_sig);
         float out = del_.Read();
         del_.Write(in + out * feedback_);
 
-        fonepole(mix_, mix_target_, 0.00007f);
-        mix_ = fclamp(mix_, 0.f, 1.f); // clamp mix to 0-1
-        out = mix_ * out + (1.0f - mix_) * in; // mix input and output
+        const float mix = mix_.Process();
+        out = mix * out + (1.0f - mix) * in; // mix input and output
         return out;
     }
 
     void SetLfoDepth(float depth)
     {
-        depth_target_ = depth;
+        depth_.SetTarget(depth);
     }
 
     void SetLfoFreq(float freq)
     {
         lfo_.SetFreq(freq);
+
+        const double w = (2.0 * M_PI * freq) / sample_rate_;
+        rot_cos_       = float(std::cos(w));
+        rot_sin_       = float(std::sin(w));
+    }
+
+    /**
+       Number of taps ProcessBlock() reads from the delay line (1 to
+       kMaxVoices). Their LFOs are spread evenly over one cycle; even voices
+       go left, odd voices right (a single voice goes to both).
+    */
+    void SetVoices(size_t voices)
+    {
+        voices_ = voices < 1 ? 1 : (voices > kMaxVoices ? kMaxVoices : voices);
+
+        const size_t n_left  = (voices_ + 1) / 2;
+        const size_t n_right = voices_ == 1 ? 1 : voices_ / 2;
+        for(size_t v = 0; v < voices_; v++)
+        {
+            const double offset = (2.0 * M_PI * v) / voices_;
+            voice_cos_[v]       = float(std::cos(offset));
+            voice_sin_[v]       = float(std::sin(offset));
+            const bool left     = (v % 2 == 0);
+            const bool right    = (v % 2 == 1) || voices_ == 1;
+            voice_gain_l_[v]    = left ? 1.f / n_left : 0.f;
+            voice_gain_r_[v]    = right ? 1.f / n_right : 0.f;
+        }
+    }
+
+    size_t GetVoices() const { return voices_; }
+
+    /**
+       Stereo chorus: every voice is a tap on the one delay line, so an
+       extra voice costs one interpolated read and no extra memory or
+       smoothing. The LFOs are made a block at a time from one rotating
+       phasor (each voice is a fixed rotation of it); the mean of the voices
+       is fed back. With one voice both outputs equal Process(). Keeps its
+       own LFO state: use either this or Process() on a given instance.
+    */
+    void ProcessBlock(const float* in, float* out_l, float* out_r, size_t size)
+    {
+        while(size > 0)
+        {
+            const size_t n = size < kMaxBlock ? size : kMaxBlock;
+            ProcessChunk(in, out_l, out_r, n);
+            in += n;
+            out_l += n;
+            out_r += n;
+            size -= n;
+        }
     }
 
     void SetDelay(float delay)
@@ -84,8 +153,7 @@ class VibratoEngine
     void SetDelayMs(float ms)
     {
         ms = fmax(.04f, ms);
-        // delay_ = ms * .001f * sample_rate_;
-        delay_target_ = ms * 0.001f * sample_rate_;
+        delay_.SetTarget(ms * 0.001f * sample_rate_);
     }
 
     void SetFeedback(float feedback)
@@ -95,29 +163,112 @@ class VibratoEngine
 
     void SetMix(float mix)
     {
-        mix_target_ = fclamp(mix, 0.f, 1.f);
+        mix_.SetTarget(fclamp(mix, 0.f, 1.f));
     }
 
+    /**
+       Fully dry (mix faded to 0): the output is the input, so the LFO and
+       the reads are skipped. The line is still written (without feedback)
+       and the glides keep moving, so a fade back in starts from a full
+       line of recent input.
+    */
+    bool IsIdle() const { return mix_.IsSettled() && mix_.Value() == 0.f; }
+
+    static constexpr size_t kMaxVoices = 6;
+
   private:
+    void ProcessChunk(const float* in, float* out_l, float* out_r, size_t size)
+    {
+        if(IsIdle())
+        {
+            depth_.NextBlock(size);
+            this->SetDelayMs(max_delay_ms_ * depth_.Value());
+            delay_.NextBlock(size);
+            for(size_t i = 0; i < size; i++)
+            {
+                del_.Write(in[i]);
+                out_l[i] = out_r[i] = in[i];
+            }
+            return;
+        }
+
+        // the voices' LFOs for the whole block (Oscillator's default amp: 0.5)
+        float lfo[kMaxVoices][kMaxBlock];
+        float c = lfo_cos_;
+        float s = lfo_sin_;
+        for(size_t i = 0; i < size; i++)
+        {
+            for(size_t v = 0; v < voices_; v++)
+                lfo[v][i] = 0.5f * (s * voice_cos_[v] + c * voice_sin_[v]);
+
+            const float cn = c * rot_cos_ - s * rot_sin_;
+            s              = s * rot_cos_ + c * rot_sin_;
+            c              = cn;
+        }
+        const float g = 1.5f - 0.5f * (c * c + s * s);
+        lfo_cos_      = c * g;
+        lfo_sin_      = s * g;
+
+        // smoothing is shared by all voices, one segment per block (the
+        // delay follows the depth where this block's depth segment ends)
+        float       depth      = depth_.Value();
+        const float depth_step = depth_.NextBlock(size);
+        this->SetDelayMs(max_delay_ms_ * depth_.Value());
+        float       delay      = delay_.Value();
+        const float delay_step = delay_.NextBlock(size);
+        float       mix        = mix_.Value();
+        const float mix_step   = mix_.NextBlock(size);
+
+        const float fb_scale = feedback_ / voices_;
+        for(size_t i = 0; i < size; i++)
+        {
+            depth += depth_step;
+            delay += delay_step;
+            mix += mix_step;
+
+            // linlin(lfo, -1, 1, 0, depth) * delay
+            const float scale = 0.5f * depth * delay;
+
+            float sum = 0.f, l = 0.f, r = 0.f;
+            for(size_t v = 0; v < voices_; v++)
+            {
+                const float tap = del_.Read((lfo[v][i] + 1.f) * scale);
+                sum += tap;
+                l += tap * voice_gain_l_[v];
+                r += tap * voice_gain_r_[v];
+            }
+            del_.Write(in[i] + sum * fb_scale);
+
+            out_l[i] = mix * l + (1.0f - mix) * in[i];
+            out_r[i] = mix * r + (1.0f - mix) * in[i];
+        }
+    }
+
+    static constexpr size_t kMaxBlock = 48;
+
     float sample_rate_;
     static constexpr int32_t kDelayLength = 2400; // 50ms @ 48kHz
 
     float feedback_ = 0.f;
-    float delay_ = 0.f;
-    float delay_target_ = 0.f; // target delay length (in samples)
-
-    float depth_ = 0.f;         // current depth
-    float depth_target_ = 0.f; // target depth
+    ParamRamp delay_; // delay length (in samples)
+    ParamRamp depth_;
 
     float max_delay_ms_ = 50.f; // max delay time in ms
 
     Oscillator lfo_;
 
+    // ProcessBlock(): LFO phasor, per-sample rotation, and each voice's
+    // phase offset (as a rotation) and pan gains
+    float  lfo_cos_, lfo_sin_;
+    float  rot_cos_, rot_sin_;
+    size_t voices_;
+    float  voice_cos_[kMaxVoices], voice_sin_[kMaxVoices];
+    float  voice_gain_l_[kMaxVoices], voice_gain_r_[kMaxVoices];
+
     DelayLine<float, kDelayLength> del_;
 
 
-    float mix_ = 1.0f; // mix level, 0.0 - 1.0
-    float mix_target_ = 1.0f; // target mix level, 0.0 - 1.0
+    ParamRamp mix_; // mix level, 0.0 - 1.0
 };
 
 } // namespace daisysp
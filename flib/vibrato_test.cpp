@@ -0,0 +1,234 @@
+// vibrato_test.cpp
+// VibratoEngine::ProcessBlock: one voice matches Process(), the voices'
+// LFO phases and stereo split, what each extra voice costs, and the dry
+// fast path.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../DaisySP/Source vibrato_test.cpp
+//       ../DaisySP/build/libdaisysp.a -o vibrato_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "vibrato.h"
+
+using daisysp::VibratoEngine;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr     = 48000.f;
+static constexpr size_t kSettle = 48000 * 5; // let the depth glide land
+static constexpr size_t kBlock  = 2;
+
+std::vector<float> noise(size_t len)
+{
+    std::vector<float> x(len);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        x[i] = 0.5f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+    }
+    return x;
+}
+
+// ~2.93 Hz: a phase increment of 2^-14, which Oscillator's float phase
+// accumulates exactly (at other rates it drifts from the true rate by up
+// to ~1e-3, and the phasor doesn't)
+static constexpr float kLfoHz = kSr / 16384.f;
+
+void setup(VibratoEngine& vib, size_t voices, float feedback)
+{
+    vib.Init(kSr);
+    vib.SetLfoDepth(0.5f);
+    vib.SetLfoFreq(kLfoHz);
+    vib.SetFeedback(feedback);
+    vib.SetVoices(voices);
+}
+
+// Test 1: a single voice is the per-sample engine, on both sides. The
+// phasor and sinf() round differently (a few thousandths of a sample of
+// tap position), and the delay glide follows the depth per block rather
+// than per sample; white noise hears both as well under 1% of its peak.
+void test_one_voice()
+{
+    std::cout << "\n== Test 1: one voice vs Process() ==\n";
+    const size_t len = kSettle + 48000;
+    std::vector<float> in = noise(len), ref(len), l(len), r(len);
+
+    VibratoEngine a, b;
+    setup(a, 1, 0.5f);
+    setup(b, 1, 0.5f);
+    for (size_t i = 0; i < len; i++)
+        ref[i] = a.Process(in[i]);
+    for (size_t i = 0; i < len; i += kBlock)
+        b.ProcessBlock(&in[i], &l[i], &r[i], kBlock);
+
+    float err = 0.f, peak = 0.f, lr = 0.f;
+    for (size_t i = 0; i < len; i++) {
+        err  = std::max(err, std::fabs(ref[i] - l[i]));
+        peak = std::max(peak, std::fabs(ref[i]));
+        lr   = std::max(lr, std::fabs(l[i] - r[i]));
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "max error %.2e (peak %.2f)", err, peak);
+    CHECK(err < 1e-2f * peak, msg);
+    CHECK(lr == 0.f, "left == right");
+}
+
+// delay (samples) each output heard, from a ramp input (linear interp
+// reads a ramp exactly: out = x[i - d])
+void ramp_delays(size_t voices, std::vector<float>& dl, std::vector<float>& dr)
+{
+    const size_t len   = kSettle + 48000;
+    const float  slope = 1e-4f;
+    VibratoEngine vib;
+    setup(vib, voices, 0.f);
+
+    std::vector<float> in(len), l(len), r(len);
+    for (size_t i = 0; i < len; i++)
+        in[i] = slope * (float)i - 20.f; // centred on 0 for precision
+    for (size_t i = 0; i < len; i += kBlock)
+        vib.ProcessBlock(&in[i], &l[i], &r[i], kBlock);
+
+    dl.clear();
+    dr.clear();
+    for (size_t i = kSettle; i < len; i++) {
+        dl.push_back((in[i] - l[i]) / slope);
+        dr.push_back((in[i] - r[i]) / slope);
+    }
+}
+
+// Test 2: voices are spread evenly over the LFO cycle. Two voices are in
+// antiphase (their delays sum to a constant); four voices put two
+// antiphase pairs on each side, so each side's average delay is flat.
+void test_spread()
+{
+    std::cout << "\n== Test 2: LFO phase spread and stereo split ==\n";
+    std::vector<float> dl, dr;
+
+    ramp_delays(2, dl, dr);
+    auto sum   = std::minmax_element(dl.begin(), dl.end());
+    float lo = 1e9f, hi = -1e9f, swing = *sum.second - *sum.first;
+    for (size_t i = 0; i < dl.size(); i++) {
+        lo = std::min(lo, dl[i] + dr[i]);
+        hi = std::max(hi, dl[i] + dr[i]);
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "2 voices: L swings %.1f samples, L + R within %.3f", swing, hi - lo);
+    CHECK(swing > 100.f && hi - lo < 0.1f, msg);
+
+    ramp_delays(4, dl, dr);
+    auto l = std::minmax_element(dl.begin(), dl.end());
+    auto r = std::minmax_element(dr.begin(), dr.end());
+    std::snprintf(msg, sizeof(msg), "4 voices: each side's delay flat within %.3f / %.3f",
+                  *l.second - *l.first, *r.second - *r.first);
+    CHECK(*l.second - *l.first < 0.1f && *r.second - *r.first < 0.1f, msg);
+}
+
+template <typename F>
+double ns_per_sample(F&& run, size_t len)
+{
+    double best = 1e9;
+    for (int k = 0; k < 3; k++) { // best of three, the host's timing is noisy
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / len);
+    }
+    return best;
+}
+
+// Test 3: an extra voice costs a read and its mix, well under a second engine
+void test_cost()
+{
+    std::cout << "\n== Test 3: cost per voice (block " << kBlock << ") ==\n";
+    const size_t len = 48000 * 5;
+    std::vector<float> in = noise(len), l(len), r(len);
+
+    VibratoEngine vib;
+    setup(vib, 1, 0.3f);
+    const double engine = ns_per_sample([&] {
+        for (size_t i = 0; i < len; i++)
+            l[i] = vib.Process(in[i]);
+    }, len);
+    std::printf("Process():  %6.2f ns/sample\n", engine);
+
+    double ns[VibratoEngine::kMaxVoices + 1];
+    for (size_t n = 1; n <= VibratoEngine::kMaxVoices; n++) {
+        setup(vib, n, 0.3f);
+        ns[n] = ns_per_sample([&] {
+            for (size_t i = 0; i < len; i += kBlock)
+                vib.ProcessBlock(&in[i], &l[i], &r[i], kBlock);
+        }, len);
+        std::printf("%zu voice%s:   %6.2f ns/sample (+%5.2f)\n", n, n > 1 ? "s" : " ", ns[n],
+                    n > 1 ? ns[n] - ns[n - 1] : 0.0);
+    }
+    const size_t n      = VibratoEngine::kMaxVoices;
+    const double per    = (ns[n] - ns[1]) / (n - 1);
+    std::printf("per extra voice: %5.2f ns/sample (%.0f%% of one engine)\n", per, 100.0 * per / engine);
+    CHECK(per < 0.5 * engine, "an extra voice costs under half an engine");
+}
+
+// Test 4: faded fully dry (cenote's depth < 0.1), the output is the input
+// and the LFO and reads are skipped
+void test_dry()
+{
+    std::cout << "\n== Test 4: dry fast path ==\n";
+    const size_t warmup = kSettle, len = 48000 * 4;
+    std::vector<float> in = noise(warmup + len), l(warmup + len), r(warmup + len);
+
+    double ns[2][2]; // [dry][block]
+    bool   idle = true, same = true;
+    for (int dry = 0; dry < 2; dry++) {
+        for (int block = 0; block < 2; block++) {
+            VibratoEngine vib;
+            setup(vib, 1, 0.3f);
+            vib.SetMix(dry ? 0.f : 1.f);
+            for (size_t i = 0; i < warmup; i++)
+                l[i] = vib.Process(in[i]);
+            if (dry)
+                idle = idle && vib.IsIdle();
+            ns[dry][block] = ns_per_sample([&] {
+                if (block)
+                    for (size_t i = warmup; i < warmup + len; i += kBlock)
+                        vib.ProcessBlock(&in[i], &l[i], &r[i], kBlock);
+                else
+                    for (size_t i = warmup; i < warmup + len; i++)
+                        l[i] = vib.Process(in[i]);
+            }, len);
+            if (dry)
+                for (size_t i = warmup; i < warmup + len; i++)
+                    same = same && l[i] == in[i] && (!block || r[i] == in[i]);
+        }
+    }
+    CHECK(idle, "idle once faded out");
+    CHECK(same, "dry output is the input");
+    std::printf("Process():        wet %6.2f, dry %6.2f ns/sample (%.1fx)\n", ns[0][0], ns[1][0],
+                ns[0][0] / ns[1][0]);
+    std::printf("ProcessBlock(%zu):  wet %6.2f, dry %6.2f ns/sample (%.1fx)\n", kBlock, ns[0][1],
+                ns[1][1], ns[0][1] / ns[1][1]);
+    // wall-clock ratios are printed; only the order is checked
+    CHECK(ns[1][0] < ns[0][0] && ns[1][1] < ns[0][1], "dry costs less than wet");
+}
+
+int main()
+{
+    std::cout << "Running vibrato tests...\n";
+    test_one_voice();
+    test_spread();
+    test_cost();
+    test_dry();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -0,0 +1,369 @@
+#pragma once
+#ifndef HUGO_LIB_WAV_H
+#define HUGO_LIB_WAV_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "resampler.h"
+
+namespace daisysp
+{
+
+/**
+   @brief Streaming WAV export and import, a bounded piece per Step().
+
+   Nothing here blocks for a whole file: the writer and the importer move
+   at most kWavStepFrames frames per Step(), so a main loop (or a host
+   thread) can save or load a loop a little at a time while the audio
+   callback runs untouched. Bytes go through a WavSink / come from a
+   WavSource: a file, an SD card, a serial port, a buffer.
+
+   Export is 32-bit float (lossless for the float buffers it comes from).
+   Import takes 16-, 24- and 32-bit PCM and 32-bit float, mono or stereo,
+   at any rate: it's resampled on the way in, and mixed down or spread to
+   the buffer's channels.
+
+   Little-endian, as on both the Daisy and the host.
+*/
+
+/// where exported bytes go; returns the bytes taken (fewer is an error)
+struct WavSink
+{
+    void*  ctx;
+    size_t (*write)(void* ctx, const void* data, size_t size);
+};
+
+/// where imported bytes come from; returns the bytes read (fewer: the end)
+struct WavSource
+{
+    void*  ctx;
+    size_t (*read)(void* ctx, void* data, size_t size);
+};
+
+static constexpr size_t kWavStepFrames = 256; // frames per Step(), at most
+static constexpr size_t kWavMaxChans   = 2;
+
+/**
+   Writes `frames` frames from anything with Read(i) (i = frame * chans +
+   chan: a ChunkedBuffer, a LazyBuffer, ...) as a float WAV.
+*/
+class WavWriter
+{
+  public:
+    WavWriter() {}
+    ~WavWriter() {}
+
+    /// sends the header; false if the sink refused it or chans is too many
+    bool Init(WavSink sink, uint32_t sample_rate, uint16_t chans, uint32_t frames)
+    {
+        sink_   = sink;
+        chans_  = chans;
+        frames_ = frames;
+        done_   = 0;
+        failed_ = chans == 0 || chans > kWavMaxChans;
+        if(failed_)
+            return false;
+
+        const uint32_t data_size = frames * chans * 4;
+        uint8_t        h[44];
+        memcpy(h, "RIFF", 4);
+        Put32(h + 4, 36 + data_size);
+        memcpy(h + 8, "WAVEfmt ", 8);
+        Put32(h + 16, 16);
+        Put16(h + 20, 3); // IEEE float
+        Put16(h + 22, chans);
+        Put32(h + 24, sample_rate);
+        Put32(h + 28, sample_rate * chans * 4);
+        Put16(h + 32, chans * 4);
+        Put16(h + 34, 32);
+        memcpy(h + 36, "data", 4);
+        Put32(h + 40, data_size);
+        failed_ = sink_.write(sink_.ctx, h, sizeof(h)) != sizeof(h);
+        return !failed_;
+    }
+
+    /// write up to max_frames more; returns the frames written
+    template <typename Src>
+    size_t Step(const Src& src, size_t max_frames = kWavStepFrames)
+    {
+        if(failed_)
+            return 0;
+        size_t n = frames_ - done_;
+        n        = n < max_frames ? n : max_frames;
+        n        = n < kWavStepFrames ? n : kWavStepFrames;
+        const size_t len = n * chans_;
+        for(size_t i = 0; i < len; i++)
+            buf_[i] = src.Read(done_ * chans_ + i);
+        if(sink_.write(sink_.ctx, buf_, len * sizeof(float)) != len * sizeof(float))
+        {
+            failed_ = true;
+            return 0;
+        }
+        done_ += n;
+        return n;
+    }
+
+    bool   Done() const { return done_ == frames_ && !failed_; }
+    bool   Failed() const { return failed_; }
+    size_t GetFramesDone() const { return done_; }
+
+  private:
+    static void Put16(uint8_t* p, uint16_t v) { memcpy(p, &v, 2); }
+    static void Put32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+
+    WavSink sink_;
+    size_t  chans_  = 1;
+    size_t  frames_ = 0;
+    size_t  done_   = 0;
+    bool    failed_ = false;
+    float   buf_[kWavStepFrames * kWavMaxChans];
+};
+
+/**
+   Reads a WAV's header, then its frames as floats, as they're asked for.
+*/
+class WavReader
+{
+  public:
+    WavReader() {}
+    ~WavReader() {}
+
+    /// reads up to the start of the samples; false if it's not a WAV this takes
+    bool Init(WavSource src)
+    {
+        src_    = src;
+        done_   = 0;
+        frames_ = 0;
+        uint8_t h[16];
+        if(!Get(h, 12) || memcmp(h, "RIFF", 4) != 0 || memcmp(h + 8, "WAVE", 4) != 0)
+            return false;
+
+        bool have_fmt = false;
+        while(Get(h, 8))
+        {
+            uint32_t size;
+            memcpy(&size, h + 4, 4);
+            const uint32_t padded = size + (size & 1);
+            if(memcmp(h, "fmt ", 4) == 0 && size >= 16)
+            {
+                if(!Get(h, 16))
+                    return false;
+                uint16_t format, bits;
+                memcpy(&format, h, 2);
+                memcpy(&chans_, h + 2, 2);
+                memcpy(&rate_, h + 4, 4);
+                memcpy(&bits, h + 14, 2);
+                uint32_t rest = padded - 16;
+                if(format == 0xFFFE && size >= 26) // extensible: the real format follows
+                {
+                    if(!Get(h, 10))
+                        return false;
+                    memcpy(&format, h + 8, 2);
+                    rest -= 10;
+                }
+                if(!Skip(rest))
+                    return false;
+                bytes_ = bits / 8;
+                float_ = format == 3;
+                have_fmt = (format == 1 && (bits == 16 || bits == 24 || bits == 32))
+                           || (format == 3 && bits == 32);
+                if(!have_fmt || chans_ == 0 || chans_ > kWavMaxChans)
+                    return false;
+            }
+            else if(memcmp(h, "data", 4) == 0)
+            {
+                if(!have_fmt)
+                    return false;
+                frames_ = size / (bytes_ * chans_);
+                return true;
+            }
+            else if(!Skip(padded))
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /// up to max_frames (kWavStepFrames at most) into out; 0 at the end
+    size_t Read(float* out, size_t max_frames)
+    {
+        size_t n = frames_ - done_;
+        n        = n < max_frames ? n : max_frames;
+        n        = n < kWavStepFrames ? n : kWavStepFrames;
+        const size_t len = n * chans_;
+        const size_t got = src_.read(src_.ctx, raw_, len * bytes_) / (bytes_ * chans_);
+        for(size_t i = 0; i < got * chans_; i++)
+            out[i] = Sample(raw_ + i * bytes_);
+        done_ = got < n ? frames_ : done_ + got; // a short file ends here
+        return got;
+    }
+
+    uint32_t GetSampleRate() const { return rate_; }
+    size_t   GetChans() const { return chans_; }
+    size_t   GetFrames() const { return frames_; }
+    bool     Done() const { return done_ == frames_; }
+
+  private:
+    bool Get(uint8_t* p, size_t n) { return src_.read(src_.ctx, p, n) == n; }
+
+    bool Skip(uint32_t n)
+    {
+        while(n > 0)
+        {
+            const size_t k = n < sizeof(raw_) ? n : sizeof(raw_);
+            if(!Get(raw_, k))
+                return false;
+            n -= k;
+        }
+        return true;
+    }
+
+    float Sample(const uint8_t* p) const
+    {
+        if(float_)
+        {
+            float f;
+            memcpy(&f, p, 4);
+            return f;
+        }
+        switch(bytes_)
+        {
+            case 2:
+            {
+                int16_t s;
+                memcpy(&s, p, 2);
+                return s * (1.f / 32768.f);
+            }
+            case 3:
+            {
+                const int32_t s = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16
+                                            | (uint32_t)p[2] << 24);
+                return (float)(s >> 8) * (1.f / 8388608.f);
+            }
+            default:
+            {
+                int32_t s;
+                memcpy(&s, p, 4);
+                return (float)s * (1.f / 2147483648.f);
+            }
+        }
+    }
+
+    WavSource src_;
+    uint16_t  chans_  = 1;
+    uint32_t  rate_   = 48000;
+    size_t    bytes_  = 4;
+    bool      float_  = true;
+    size_t    frames_ = 0;
+    size_t    done_   = 0;
+    uint8_t   raw_[kWavStepFrames * kWavMaxChans * 4];
+};
+
+/**
+   Loads a WAV into anything with Write(i) (i = frame * chans + chan),
+   resampled to `rate` and mixed down (or spread) to `chans`.
+*/
+class WavImporter
+{
+  public:
+    WavImporter() {}
+    ~WavImporter() {}
+
+    bool Init(WavSource src, float rate, size_t chans)
+    {
+        out_chans_ = chans < kWavMaxChans ? chans : kWavMaxChans;
+        done_      = 0;
+        in_len_ = in_pos_ = 0;
+        flushed_          = false;
+        if(!reader_.Init(src))
+            return false;
+        src_.Init((float)reader_.GetSampleRate(), rate, reader_.GetChans());
+        frames_ = src_.GetOutputFrames(reader_.GetFrames());
+        return true;
+    }
+
+    /// frames the import makes (reserve this many before the first Step())
+    size_t GetFrames() const { return frames_; }
+
+    size_t GetFileSampleRate() const { return reader_.GetSampleRate(); }
+
+    /// write up to max_frames more into dst; returns the frames written
+    template <typename Dst>
+    size_t Step(Dst& dst, size_t max_frames = kWavStepFrames)
+    {
+        size_t n = frames_ - done_;
+        n        = n < max_frames ? n : max_frames;
+        n        = n < kWavStepFrames ? n : kWavStepFrames;
+
+        size_t made = 0;
+        while(made < n)
+        {
+            if(in_pos_ == in_len_)
+            {
+                in_pos_ = 0;
+                in_len_ = reader_.Read(in_, kWavStepFrames);
+                if(in_len_ == 0 && !flushed_)
+                {
+                    // two frames of silence bring the last ones out
+                    for(size_t i = 0; i < 2 * kWavMaxChans; i++)
+                        in_[i] = 0.f;
+                    in_len_  = 2;
+                    flushed_ = true;
+                }
+                if(in_len_ == 0)
+                    break;
+            }
+            size_t       used;
+            const size_t k = src_.Process(in_ + in_pos_ * src_.GetChans(), in_len_ - in_pos_,
+                                          out_, n - made, &used);
+            in_pos_ += used;
+            for(size_t f = 0; f < k; f++)
+                Put(dst, done_ + made + f, out_ + f * src_.GetChans());
+            made += k;
+        }
+        if(made < n) // the file was short: pad with silence
+            for(; made < n; made++)
+            {
+                const float zero[kWavMaxChans] = {};
+                Put(dst, done_ + made, zero);
+            }
+        done_ += made;
+        return made;
+    }
+
+    bool Done() const { return done_ == frames_; }
+
+  private:
+    template <typename Dst>
+    void Put(Dst& dst, size_t frame, const float* in)
+    {
+        const size_t in_chans = src_.GetChans();
+        if(in_chans == out_chans_)
+            for(size_t c = 0; c < out_chans_; c++)
+                dst.Write(frame * out_chans_ + c) = in[c];
+        else if(in_chans > out_chans_) // stereo to mono
+            dst.Write(frame) = 0.5f * (in[0] + in[1]);
+        else // mono to stereo
+            for(size_t c = 0; c < out_chans_; c++)
+                dst.Write(frame * out_chans_ + c) = in[0];
+    }
+
+    WavReader                 reader_;
+    Resampler<kWavMaxChans>   src_;
+    size_t                    out_chans_ = 1;
+    size_t                    frames_    = 0;
+    size_t                    done_      = 0;
+    float                     in_[kWavStepFrames * kWavMaxChans];
+    size_t                    in_len_ = 0, in_pos_ = 0;
+    bool                      flushed_ = false;
+    float                     out_[kWavStepFrames * kWavMaxChans];
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_WAV_H
@@ -0,0 +1,301 @@
+#pragma once
+#ifndef HUGO_LIB_WSOLA_H
+#define HUGO_LIB_WSOLA_H
+
+#ifdef __cplusplus
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "ipoke.h"
+
+namespace daisysp
+{
+
+/**
+   @brief WSOLA time-stretch of a loop: tempo and pitch set apart.
+
+   Grains of 1024 frames, a new one every 512, each faded in over one hop
+   while the last fades out (sin²/cos², so they always sum to one). A
+   grain reads the loop at the pitch rate; where it starts moves at the
+   tempo. Each grain starts within ±256 frames of where the tempo puts it,
+   at the offset whose first 256 frames best match what the grain before
+   would have gone on to play (normalized cross-correlation, at half rate),
+   so the two line up through the crossfade.
+
+   The search for the next grain runs while the current one plays, in
+   equal slices: every frame either reads 8 frames of the loop or tries
+   kLanes offsets side by side. Offsets are independent lanes (as in
+   Hilbert), so the inner loop vectorizes on host and keeps several
+   multiply-add chains going on the M7. Whatever the signal, a frame costs
+   at most kLanes * kCorr (256) multiply-adds, and the search is done in
+   Schedule() frames, inside a hop.
+*/
+template <typename Store>
+class WsolaT
+{
+  public:
+    WsolaT() {}
+    ~WsolaT() {}
+
+    static constexpr size_t kGrain  = 1024; // frames
+    static constexpr size_t kHop    = kGrain / 2;
+    static constexpr size_t kDecim  = 2;   // the search runs at half rate
+    static constexpr size_t kCorr   = 128; // compared, decimated (256 frames)
+    static constexpr size_t kSearch = 128; // either way, decimated (256 frames)
+    static constexpr size_t kLanes  = 2;   // offsets tried per frame
+    static constexpr size_t kGather = 4;   // decimated samples read per frame
+
+    static constexpr size_t kCand = 2 * kSearch + kCorr; // candidates' span, decimated
+    static constexpr size_t kLags = 2 * kSearch + 1;
+
+    /// frames a search takes: reading, then correlating
+    static constexpr size_t Schedule()
+    {
+        return (kCorr + kCand + kGather - 1) / kGather + (kLags + kLanes - 1) / kLanes;
+    }
+    static_assert(Schedule() < kHop, "the search has to be done before the next grain");
+
+    void Init(Store store, size_t frames, size_t chans)
+    {
+        store_ = store;
+        peek_.Init(store, frames, chans);
+        chans_ = chans;
+        a_.assign(chans, 0.f);
+        b_.assign(chans, 0.f);
+        rot_c_ = cosf(HALFPI_F / kHop);
+        rot_s_ = sinf(HALFPI_F / kHop);
+        for(size_t j = 0; j < kCand + kLanes; j++)
+            cand_[j] = 0.f;
+        Reset();
+    }
+
+    /// stop at once
+    void Reset()
+    {
+        running_  = false;
+        draining_ = false;
+        state_    = Search::IDLE;
+    }
+
+    /**
+       take over from a plain read at `pos`: the first grain fades in
+       over what that read goes on to play, so there's no seam
+    */
+    void Start(float pos, size_t loop)
+    {
+        ana_      = Wrap(pos, (float)loop);
+        cur_      = ana_; // goes out as the first grain comes in, at the same place
+        running_  = true;
+        draining_ = false;
+        state_    = Search::IDLE;
+        Fade(kHop); // the next frame starts a grain
+    }
+
+    /**
+       hand back to a plain read: no new grains, and once the last one is
+       faded in, GetPosition() is where it reads next
+    */
+    void Stop() { draining_ = true; }
+
+    /// the loop position moved: the next grain starts there, unaligned
+    void Jump(float pos, size_t loop)
+    {
+        const float l = (float)loop;
+        if(draining_)
+            cur_ = Wrap(pos, l); // the read carrying on jumps
+        ana_   = Wrap(pos, l);
+        state_ = Search::IDLE;
+    }
+
+    bool IsRunning() const { return running_; }
+    bool IsDraining() const { return draining_; }
+
+    /// where the loop is at (the tempo's), or where a plain read carries on
+    float GetPosition() const { return draining_ || !running_ ? cur_ : ana_; }
+
+    /**
+       one frame of `loop` into out, grains reading at `inc` frames per
+       frame, the loop moving at `tempo` (while IsRunning())
+    */
+    void Process(float* out, size_t loop, float inc, float tempo)
+    {
+        const float l = (float)loop;
+        if(k_ == kHop)
+            NextGrain(l, inc, tempo);
+
+        peek_.Peek(cur_, a_.data());
+        peek_.Peek(prev_, b_.data());
+        const float w = sn_ * sn_;
+        for(size_t c = 0; c < chans_; c++)
+            out[c] = b_[c] + w * (a_[c] - b_[c]);
+
+        cur_  = Wrap(cur_ + inc, l);
+        prev_ = Wrap(prev_ + inc, l);
+        if(!draining_)
+            ana_ = Wrap(ana_ + tempo, l);
+        const float cs = cs_ * rot_c_ - sn_ * rot_s_;
+        sn_            = sn_ * rot_c_ + cs_ * rot_s_;
+        cs_            = cs;
+        k_++;
+
+        SearchStep(loop);
+        if(k_ == kHop && draining_)
+        {
+            // cur_ is faded all the way in: it's the plain read from here
+            running_  = false;
+            draining_ = false;
+            state_    = Search::IDLE;
+        }
+    }
+
+  private:
+    enum class Search
+    {
+        IDLE,
+        GATHER,
+        CORRELATE,
+        DONE,
+    };
+
+    static inline float Wrap(float x, float l)
+    {
+        if(l <= 0.f)
+            return 0.f;
+        while(x >= l)
+            x -= l;
+        while(x < 0.f)
+            x += l;
+        return x;
+    }
+
+    /// the phasor the crossfade is drawn from, `k` frames into a hop
+    void Fade(size_t k)
+    {
+        k_  = k;
+        cs_ = k == kHop ? 0.f : 1.f;
+        sn_ = k == kHop ? 1.f : 0.f;
+    }
+
+    void NextGrain(float l, float inc, float tempo)
+    {
+        Fade(0);
+        prev_ = cur_;
+        cur_  = ana_;
+        if(state_ == Search::DONE)
+            cur_ = Wrap(ana_ + ((float)best_ - (float)kSearch) * kDecim, l);
+
+        // look for the one after this: what this grain plays a hop on,
+        // against the stretch of loop around where the tempo will be
+        ref_at_  = (long)floorf(Wrap(cur_ + kHop * inc, l));
+        cand_at_ = (long)floorf(Wrap(ana_ + kHop * tempo - (float)(kSearch * kDecim), l));
+        filled_  = 0;
+        energy_  = 0.f;
+        lag_     = 0;
+        best_    = kSearch;
+        score_   = -INFINITY;
+        state_   = Search::GATHER;
+    }
+
+    void SearchStep(size_t loop)
+    {
+        if(state_ == Search::GATHER)
+        {
+            for(size_t n = 0; n < kGather && filled_ < kCorr + kCand; n++, filled_++)
+            {
+                if(filled_ < kCorr)
+                {
+                    ref_[filled_] = Decimated(ref_at_ + (long)(filled_ * kDecim), loop);
+                }
+                else
+                {
+                    const size_t j = filled_ - kCorr;
+                    cand_[j]       = Decimated(cand_at_ + (long)(j * kDecim), loop);
+                    if(j < kCorr)
+                        energy_ += cand_[j] * cand_[j];
+                }
+            }
+            if(filled_ == kCorr + kCand)
+                state_ = Search::CORRELATE;
+        }
+        else if(state_ == Search::CORRELATE)
+        {
+            float xc[kLanes];
+            Correlate(ref_, cand_ + lag_, xc);
+            for(size_t l = 0; l < kLanes && lag_ < kLags; l++, lag_++)
+            {
+                const float score = xc[l] / sqrtf(energy_ + 1e-9f);
+                if(score > score_)
+                {
+                    score_ = score;
+                    best_  = lag_;
+                }
+                // slide the candidate's energy on a sample
+                const float out = cand_[lag_], in = cand_[lag_ + kCorr];
+                energy_         = fmaxf(energy_ - out * out + in * in, 0.f);
+            }
+            if(lag_ == kLags)
+                state_ = Search::DONE;
+        }
+    }
+
+    /// kLanes correlations at once: lane l is ref against cand from l on
+    static inline void Correlate(const float* ref, const float* cand, float* xc)
+    {
+        float even[kLanes], odd[kLanes];
+        for(size_t l = 0; l < kLanes; l++)
+            even[l] = odd[l] = 0.f;
+        for(size_t j = 0; j < kCorr; j += 2)
+        {
+            for(size_t l = 0; l < kLanes; l++)
+                even[l] += ref[j] * cand[j + l];
+            for(size_t l = 0; l < kLanes; l++)
+                odd[l] += ref[j + 1] * cand[j + 1 + l];
+        }
+        for(size_t l = 0; l < kLanes; l++)
+            xc[l] = even[l] + odd[l];
+    }
+
+    /// frames [at, at + kDecim) of the loop, every channel, averaged
+    float Decimated(long at, size_t loop)
+    {
+        float x = 0.f;
+        for(size_t d = 0; d < kDecim; d++)
+        {
+            const size_t f = (size_t)(at + (long)d) % loop;
+            for(size_t c = 0; c < chans_; c++)
+                x += store_.Read(f * chans_ + c);
+        }
+        return x * (1.f / kDecim);
+    }
+
+    Store         store_;
+    IpeekT<Store> peek_;
+    size_t        chans_ = 1;
+
+    bool  running_  = false;
+    bool  draining_ = false;
+    float ana_      = 0.f; // where the tempo has the loop
+    float cur_      = 0.f; // the grain fading in, read position
+    float prev_     = 0.f; // the grain fading out
+    size_t k_       = 0;   // frames into the hop
+    float  cs_ = 1.f, sn_ = 0.f, rot_c_ = 1.f, rot_s_ = 0.f;
+
+    std::vector<float> a_, b_;
+
+    // the search for the next grain's offset
+    Search state_   = Search::IDLE;
+    long   ref_at_  = 0, cand_at_ = 0;
+    size_t filled_  = 0;
+    size_t lag_     = 0;
+    size_t best_    = kSearch;
+    float  score_   = 0.f;
+    float  energy_  = 0.f;
+    float  ref_[kCorr];
+    float  cand_[kCand + kLanes]; // room for the last lanes to run over
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_WSOLA_H
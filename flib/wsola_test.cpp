@@ -0,0 +1,234 @@
+// wsola_test.cpp
+// WsolaT: tempo without pitch and pitch without tempo, grains that line
+// up (against the same grains dropped where the tempo puts them), taking
+// over from and handing back to a plain read, and what the worst frame
+// of the correlation search costs.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../DaisySP/Source wsola_test.cpp
+//       ../DaisySP/build/libdaisysp.a -o wsola_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "wsola.h"
+
+using namespace daisysp;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+using Stretch = WsolaT<FlatStore>;
+
+static constexpr float  kSr   = 48000.f;
+static constexpr size_t kLoop = 48000 * 4;
+
+std::vector<float> sine(float freq)
+{
+    std::vector<float> x(kLoop + 4); // a little past the end for the interpolation
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = sinf(TWOPI_F * freq * (float)i / kSr);
+    return x;
+}
+
+struct Measure
+{
+    float freq;     // from upward zero crossings
+    float min_rms;  // the quietest two periods
+    float max_step; // biggest sample to sample jump
+};
+
+Measure measure(const std::vector<float>& y, float freq)
+{
+    const size_t win = (size_t)(2.f * kSr / freq + 0.5f);
+    Measure m = {0.f, 1e9f, 0.f};
+    size_t  up = 0, first = 0, last = 0;
+    for (size_t i = 1; i < y.size(); i++) {
+        if (y[i - 1] < 0.f && y[i] >= 0.f) {
+            first = up == 0 ? i : first;
+            last  = i;
+            up++;
+        }
+        m.max_step = std::max(m.max_step, std::fabs(y[i] - y[i - 1]));
+    }
+    m.freq = up > 1 ? (float)(up - 1) * kSr / (float)(last - first) : 0.f;
+    for (size_t i = 0; i + win <= y.size(); i += 64) {
+        float sq = 0.f;
+        for (size_t j = i; j < i + win; j++)
+            sq += y[j] * y[j];
+        m.min_rms = std::min(m.min_rms, sqrtf(sq / win));
+    }
+    return m;
+}
+
+// `frames` stretched out of x from frame 0; `unaligned`: every grain where
+// the tempo puts it, as if there were no search
+std::vector<float> stretch(std::vector<float>& x, float inc, float tempo, size_t frames,
+                           bool unaligned = false, float* moved = nullptr)
+{
+    static Stretch w;
+    w.Init(FlatStore(x.data()), x.size(), 1);
+    w.Start(0.f, kLoop);
+    std::vector<float> y(frames);
+    float              at = 0.f, travelled = 0.f;
+    for (size_t i = 0; i < frames; i++) {
+        if (unaligned && i % Stretch::kHop == 0)
+            w.Jump(w.GetPosition(), kLoop);
+        w.Process(&y[i], kLoop, inc, tempo);
+        float d = w.GetPosition() - at;
+        travelled += d < 0.f ? d + kLoop : d;
+        at = w.GetPosition();
+    }
+    if (moved)
+        *moved = travelled;
+    return y;
+}
+
+// Test 1: half and double tempo, same pitch; grains that line up
+void test_tempo()
+{
+    std::cout << "\n== Test 1: tempo, not pitch ==\n";
+    auto x = sine(220.f);
+    const float own = TWOPI_F * 220.f / kSr; // the sine's own biggest step
+    for (float tempo : {0.5f, 0.75f, 2.f}) {
+        float moved;
+        Measure m = measure(stretch(x, 1.f, tempo, 96000, false, &moved), 220.f);
+        char msg[160];
+        std::snprintf(msg, sizeof(msg), "tempo %.2f: %.1f Hz, %.2f s of loop in 2 s, quietest %.3f, step %.4f",
+                      tempo, m.freq, moved / kSr, m.min_rms, m.max_step);
+        CHECK(std::fabs(m.freq - 220.f) < 2.f && std::fabs(moved - tempo * 96000.f) < 2.f
+                  && m.min_rms > 0.69f && m.max_step < 1.5f * own,
+              msg);
+    }
+    Measure m = measure(stretch(x, 1.f, 0.75f, 96000, true), 220.f);
+    char msg[128];
+    std::snprintf(msg, sizeof(msg), "the same grains unaligned: quietest %.3f, they cancel", m.min_rms);
+    CHECK(m.min_rms < 0.6f, msg);
+}
+
+// Test 2: a fifth up at the recorded tempo
+void test_pitch()
+{
+    std::cout << "\n== Test 2: pitch, not tempo ==\n";
+    auto x = sine(220.f);
+    float moved;
+    const float inc = powf(2.f, 7.f / 12.f);
+    Measure m = measure(stretch(x, inc, 1.f, 96000, false, &moved), 220.f * inc);
+    char msg[128];
+    std::snprintf(msg, sizeof(msg), "up a fifth: %.1f Hz, %.2f s of loop in 2 s, quietest %.3f",
+                  m.freq, moved / kSr, m.min_rms);
+    CHECK(std::fabs(m.freq - 220.f * inc) < 3.f && std::fabs(moved - 96000.f) < 2.f && m.min_rms > 0.69f,
+          msg);
+}
+
+// Test 3: a plain read, stretched for a while, then plain again: no seams
+void test_handover()
+{
+    std::cout << "\n== Test 3: on and off ==\n";
+    auto x = sine(220.f);
+    static Stretch w;
+    w.Init(FlatStore(x.data()), x.size(), 1);
+    IpeekT<FlatStore> peek;
+    peek.Init(FlatStore(x.data()), x.size(), 1);
+
+    std::vector<float> y;
+    float pos = 0.f, o;
+    for (size_t i = 0; i < 10000; i++, pos += 1.f) {
+        peek.Peek(pos, &o);
+        y.push_back(o);
+    }
+    w.Start(pos, kLoop);
+    for (size_t i = 0; i < 20000; i++) {
+        w.Process(&o, kLoop, 1.f, 0.6f);
+        y.push_back(o);
+    }
+    w.Stop();
+    size_t drain = 0;
+    while (w.IsRunning()) {
+        w.Process(&o, kLoop, 1.f, 0.6f);
+        y.push_back(o);
+        drain++;
+    }
+    for (pos = w.GetPosition(); y.size() < 40000; pos += 1.f) {
+        peek.Peek(pos, &o);
+        y.push_back(o);
+    }
+    Measure m = measure(y, 220.f);
+    char msg[128];
+    std::snprintf(msg, sizeof(msg), "handed back in %zu frames; step %.4f, quietest %.3f", drain,
+                  m.max_step, m.min_rms);
+    CHECK(drain <= Stretch::kHop && m.max_step < 1.5f * TWOPI_F * 220.f / kSr && m.min_rms > 0.69f, msg);
+}
+
+static volatile float sink; // keeps the timed frames from being optimized out
+
+// Test 4: the most a frame costs is a slice of the search, whatever the signal
+void test_cost()
+{
+    std::cout << "\n== Test 4: the worst frame ==\n";
+    std::vector<float> x(kLoop + 4);
+    uint32_t s = 1;
+    for (auto& v : x) {
+        s = s * 1664525u + 1013904223u;
+        v = (float)(int32_t)s * (1.f / 2147483648.f);
+    }
+    static Stretch w;
+    w.Init(FlatStore(x.data()), x.size(), 1);
+    w.Start(0.f, kLoop);
+
+    // the time of each frame of the hop, best of three runs of 64 hops
+    const size_t hops = 64;
+    std::vector<double> best(Stretch::kHop, 1e9);
+    float o, acc = 0.f;
+    for (size_t k = 0; k < Stretch::kHop; k++) // in step with the hops
+        w.Process(&o, kLoop, 1.1f, 0.8f);
+    for (int run = 0; run < 3; run++) {
+        std::vector<double> t(Stretch::kHop, 0.0);
+        for (size_t h = 0; h < hops; h++)
+            for (size_t k = 0; k < Stretch::kHop; k++) {
+                auto t0 = std::chrono::steady_clock::now();
+                w.Process(&o, kLoop, 1.1f, 0.8f);
+                auto t1 = std::chrono::steady_clock::now();
+                t[k] += std::chrono::duration<double, std::nano>(t1 - t0).count();
+                acc += o;
+            }
+        for (size_t k = 0; k < Stretch::kHop; k++)
+            best[k] = std::min(best[k], t[k] / hops);
+    }
+    sink = acc;
+    const size_t sched = Stretch::Schedule();
+    double worst = 0.0, search = 0.0, plain = 0.0;
+    for (size_t k = 0; k < Stretch::kHop; k++) {
+        worst = std::max(worst, best[k]);
+        if (k > sched + 1)
+            plain += best[k] / (Stretch::kHop - sched - 2);
+    }
+    for (size_t k = 0; k <= sched + 1; k++)
+        search += best[k] - plain;
+    std::printf("a frame: %.0f ns playing, %.0f ns at worst (%zu multiply-adds); "
+                "the whole search at once: %.1f us\n",
+                plain, worst, Stretch::kLanes * Stretch::kCorr, search * 0.001);
+    CHECK(worst < plain + search / 8.0, "spread out, the worst frame is a small slice of the search");
+    CHECK(worst < 2000.0, "and a few hundred ns on host");
+}
+
+int main()
+{
+    std::cout << "Running WSOLA tests...\n";
+    test_tempo();
+    test_pitch();
+    test_handover();
+    test_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
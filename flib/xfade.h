@@ -5,6 +5,7 @@
 #ifdef __cplusplus
 
 #include "daisysp.h"
+#include "paramramp.h"
 
 namespace daisysp
 {
@@ -26,17 +27,34 @@ public:
     void Init(float sr, float ramp_time_ms)
     {
         sr_ = sr;
-        
-        ramp_time_ms_ = ramp_time_ms;
-        ramp_.Init(sr_);
-        ramp_.Start(0.0f, 0.0f, ramp_time_ms_);
+
+        val_ = 0.0f;
+        ramp_.Init(sr_, ramp_time_ms, ParamRamp::MODE::LINEAR, val_);
 
         SetCrossfadeType(TYPE::EQ_POWER); // default to power crossfade
     }
 
     float Process(const float sig_a, const float sig_b) {
-        val_ = ramp_.Process(&ramp_finished_);
+        // the weights only change while the ramp moves
+        if (!ramp_.IsSettled()) {
+            val_ = ramp_.Process();
+            UpdateWeights();
+        }
+
+        return sig_a * wa_ + sig_b * wb_;
+    }
+
+    void SetCrossfadeType(TYPE type) { 
+        type_ = type; 
+        UpdateWeights();
+    }
+    
+    void SetCrossfade(float x) { 
+        ramp_.SetTarget(x);
+    }
 
+private:
+    void UpdateWeights() {
         if (type_ == TYPE::EQ_GAIN) {
             wa_ = 1 - val_;
             wb_ = val_;
@@ -53,21 +71,8 @@ public:
                 wb_ = 1.0f;
             }
         }
-
-        return sig_a * wa_ + sig_b * wb_;
-    }
-
-    void SetCrossfadeType(TYPE type) { 
-        type_ = type; 
-    }
-    
-    void SetCrossfade(float x) { 
-        if (x != val_) {
-            ramp_.Start(val_, x, ramp_time_ms_ / 1000.0f); 
-        }
     }
 
-private:
     // config
     float sr_;
     TYPE type_;
@@ -78,9 +83,7 @@ private:
     float wb_;
 
     // ramp (to avoid clicks)
-    Line ramp_;
-    uint8_t ramp_finished_;
-    float ramp_time_ms_;
+    ParamRamp ramp_;
 };
 
 } // namespace daisysp
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef HUGO_LIB_ZEROCROSS_H
+#define HUGO_LIB_ZEROCROSS_H
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include "arena.h"
+
+namespace daisysp
+{
+
+/**
+   @brief Where a recording crosses zero going up, kept as it's recorded,
+          for landing loop ends and jumps where they won't click.
+
+   Frames are grouped in buckets of 128; each bucket keeps its first and
+   last upward crossing, two floats, in chunks of an arena (1/64th of what
+   the recording itself takes). Push() is a compare per frame and a write
+   or two per crossing; a lookup reads a few buckets either side, never
+   the recording.
+*/
+template <size_t MaxChunks>
+class ZeroCrossIndex
+{
+  public:
+    ZeroCrossIndex() {}
+    ~ZeroCrossIndex() {}
+
+    static constexpr size_t kBucketLog2 = 7; // 128 frames
+    static constexpr size_t kBucket     = (size_t)1 << kBucketLog2;
+
+    void Init(ChunkArena* arena)
+    {
+        chans_ = arena->GetChans();
+        buf_.Init(arena);
+        Reset();
+    }
+
+    /// forget every crossing, and give the memory back
+    void Reset()
+    {
+        buf_.Release();
+        prev_ = 0.f;
+    }
+
+    /**
+       frames [0, frames) are being recorded over: forget their crossings,
+       and Push() them again from frame 0
+    */
+    void Restart(size_t frames)
+    {
+        for(size_t i = 0; i < 2 * ((frames + kBucket - 1) >> kBucketLog2); i++)
+            if(buf_.Read(i) != 0.f)
+                buf_.Write(i) = 0.f;
+        prev_ = 0.f;
+    }
+
+    /// frame `frame` of a recording moving forward is x
+    inline void Push(size_t frame, float x)
+    {
+        if(prev_ < 0.f && x >= 0.f)
+            Mark(frame);
+        prev_ = x;
+    }
+
+    /// the last crossing at or before `frame`, up to `dist` back; `frame` if none
+    size_t AtOrBefore(size_t frame, size_t dist) const
+    {
+        const size_t lo = frame > dist ? frame - dist : 0;
+        for(size_t b = frame >> kBucketLog2;; b--)
+        {
+            const size_t first = Get(b, 0), last = Get(b, 1);
+            if(last != kNone && last <= frame)
+                return last >= lo ? last : frame;
+            if(first != kNone && first <= frame)
+                return first >= lo ? first : frame;
+            if(b == 0 || (b << kBucketLog2) <= lo)
+                return frame;
+        }
+    }
+
+    /// the first crossing at or after `frame`, up to `dist` on; `frame` if none
+    size_t AtOrAfter(size_t frame, size_t dist) const
+    {
+        const size_t hi = frame + dist;
+        for(size_t b = frame >> kBucketLog2;; b++)
+        {
+            const size_t first = Get(b, 0), last = Get(b, 1);
+            if(first != kNone && first >= frame)
+                return first <= hi ? first : frame;
+            if(last != kNone && last >= frame)
+                return last <= hi ? last : frame;
+            if(((b + 1) << kBucketLog2) > hi)
+                return frame;
+        }
+    }
+
+    /// the crossing nearest `frame`, up to `dist` either way; `frame` if none
+    size_t Nearest(size_t frame, size_t dist) const
+    {
+        const size_t before = AtOrBefore(frame, dist);
+        const size_t after  = AtOrAfter(frame, dist);
+        if(before == frame)
+            return after;
+        if(after == frame)
+            return before;
+        return frame - before <= after - frame ? before : after;
+    }
+
+    /// arena memory held, in frames
+    size_t GetMemoryFrames() const { return buf_.GetCapacityFrames(); }
+
+  private:
+    static constexpr size_t kNone = (size_t)-1;
+
+    // a bucket is two floats, first and last crossing, as offset + 1: the
+    // buffer reads 0 where nothing was written
+    size_t Get(size_t b, size_t which) const
+    {
+        const float off = buf_.Read(2 * b + which);
+        return off > 0.f ? (b << kBucketLog2) + (size_t)off - 1 : kNone;
+    }
+
+    void Mark(size_t frame)
+    {
+        const size_t b   = frame >> kBucketLog2;
+        const float  off = (float)(frame & (kBucket - 1)) + 1.f;
+        if(!buf_.Reserve((2 * b + 1 + chans_) / chans_))
+            return; // out of memory: this stretch goes without
+        if(buf_.Read(2 * b) == 0.f)
+            buf_.Write(2 * b) = off;
+        buf_.Write(2 * b + 1) = off;
+    }
+
+    ChunkedBuffer<MaxChunks> buf_;
+    size_t                   chans_ = 1;
+    float                    prev_  = 0.f;
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // HUGO_LIB_ZEROCROSS_H
@@ -10,6 +10,8 @@
 #include "fmath.h"
 #include "xfade.h"
 #include "taptempo.h"
+#include "blocklimiter.h"
+#include "dirty.h"
 
 #define BUF_SIZE (48000 * 10)  // 10 seconds of audio at 48kHz
 #define CHANS 1                // mono :(
@@ -56,6 +58,15 @@ enum KNOB {
 // manager for shift-functions for knobs
 ShiftKnobManager skm;
 
+// knob jitter below this isn't a change
+constexpr static float kKnobHysteresis = 0.002f;
+Hysteresis knob_hyst[KNOB_LAST];
+
+// engine setters run only when their arguments change
+DirtyCounter setter_stats;
+Dirty<float, float, float, float, float, float, float, bool, float> dirty_glitch_params;
+Dirty<float> dirty_filter_freq;
+
 // tap tempo
 TapTempo tap_tempo;
 
@@ -64,10 +75,12 @@ GlitchEngine glitch;
 
 // xfade
 Xfade xfade;
-Limiter limiter;
+BlockLimiter limiter;
 
 // our buffer, for the glitch engine
 float DSY_SDRAM_BSS buf[BUF_SIZE * CHANS];
+// its min/max/RMS summary (24 kB)
+GlitchEngine::Summary::Cell summary_cells[GlitchEngine::Summary::CellsFor(BUF_SIZE)];
 
 // **************************************************
 // SETTINGS
@@ -178,12 +191,12 @@ bool tapped = false;
 void controlBlock() {
     // process the shift knob manager
     std::array<float, 8> hw_knobs;
-    hw_knobs[0] = knob_glitch_dur.Value();
-    hw_knobs[1] = knob_glitch_spread.Value();
-    hw_knobs[2] = knob_pitch.Value();
-    hw_knobs[3] = knob_rskip.Value();
-    hw_knobs[4] = knob_level.Value();
-    hw_knobs[5] = knob_env.Value();
+    hw_knobs[0] = knob_hyst[0].Process(knob_glitch_dur.Value());
+    hw_knobs[1] = knob_hyst[1].Process(knob_glitch_spread.Value());
+    hw_knobs[2] = knob_hyst[2].Process(knob_pitch.Value());
+    hw_knobs[3] = knob_hyst[3].Process(knob_rskip.Value());
+    hw_knobs[4] = knob_hyst[4].Process(knob_level.Value());
+    hw_knobs[5] = knob_hyst[5].Process(knob_env.Value());
     hw_knobs[6] = 0.0f; // unused
     hw_knobs[7] = 0.0f; // unused
     
@@ -285,22 +298,28 @@ void controlBlock() {
         GlitchEngine::PitchSpreadType::PITCH_SPREAD_RAND : 
         GlitchEngine::PitchSpreadType::PITCH_SPREAD_OCTAVES
     );
-    glitch.SetGlitchParams(
-        /*glitch_dur=*/ glitch_dur,
-        /*rskip=*/ rskip,
-        /*glitch_spread=*/ glitch_spread,
-        /*pitch=*/ pitch,
-        /*pitch_spread=*/ pitch_spread,
-        /*level=*/ 1.0,
-        /*env_atk_amt=*/ env_atk_amt,
-        /*freeze=*/ !sw3, // freeze the buffer if the footswitch is pressed
-        /*overlap=*/ overlap // overlap is a percentage of the glitch duration,
-    );
+    if (dirty_glitch_params.Changed(glitch_dur, rskip, glitch_spread, pitch, pitch_spread,
+                                    1.0f, env_atk_amt, !sw3, overlap)) {
+        glitch.SetGlitchParams(
+            /*glitch_dur=*/ glitch_dur,
+            /*rskip=*/ rskip,
+            /*glitch_spread=*/ glitch_spread,
+            /*pitch=*/ pitch,
+            /*pitch_spread=*/ pitch_spread,
+            /*level=*/ 1.0,
+            /*env_atk_amt=*/ env_atk_amt,
+            /*freeze=*/ !sw3, // freeze the buffer if the footswitch is pressed
+            /*overlap=*/ overlap // overlap is a percentage of the glitch duration,
+        );
+    }
 
 
-    // configure filter
-    filter.SetRes(0.6f);
-    filter.SetFreq(linlin(skm.GetShiftValue(KNOB_LEVEL), 0.0, 1.0, 100.0, 8000.0f));
+    // configure filter (res is set once in init())
+    {
+        float filter_freq = linlin(skm.GetShiftValue(KNOB_LEVEL), 0.0, 1.0, 100.0, 8000.0f);
+        if (dirty_filter_freq.Changed(filter_freq))
+            filter.SetFreq(filter_freq);
+    }
 
 
     // TRIGGER GLITCH!
@@ -378,6 +397,10 @@ float s_in[CHANS]; // input signal
 float s_out[CHANS]; // output signal
 float glitch_out[CHANS]; // glitch output
 
+// one block of mono samples, so the limiter runs once per block
+float block_in[BLOCK_SIZE];
+float block_glitch[BLOCK_SIZE];
+
 void callback(
     AudioHandle::InterleavingInputBuffer  in,
     AudioHandle::InterleavingOutputBuffer out,
@@ -389,26 +412,29 @@ void callback(
     controlBlock();
     // Save(); // save settings if needed
 
-    for(size_t i = 0; i < size; i += 2)
-    {    
-        // MONO!
-        s_in[0] = in[i];
-        // s_out[0] = 0.f; // initialize output to zero
-            
-        // Process the glitch engine
-        glitch.ProcessFrame(s_in, glitch_out);
+    for(size_t start = 0; start < size; start += 2 * BLOCK_SIZE)
+    {
+        size_t frames = std::min((size_t)BLOCK_SIZE, (size - start) / 2);
+
+        for(size_t j = 0; j < frames; j++)
+        {
+            // MONO!
+            s_in[0] = in[start + 2 * j];
+            block_in[j] = s_in[0];
 
-        // if (skm.GetShiftValue(KNOB_LEVEL) < 0.97f) {
-        glitch_out[0] = filter.Process(glitch_out[0] * 12.0f);// MONO!!! add a little boost pre-filter
-        // }
+            // Process the glitch engine
+            glitch.ProcessFrame(s_in, glitch_out);
 
-        limiter.ProcessBlock(glitch_out, CHANS, 1.0);
+            block_glitch[j] = filter.Process(glitch_out[0] * 12.0f); // MONO!!! add a little boost pre-filter
+        }
 
-        s_out[0] = xfade.Process(s_in[0], glitch_out[0]);
+        limiter.ProcessBlock(block_glitch, frames, 0.7f);
 
-        out[i] = s_out[0];
-        // out[i] = s_in[0] + glitch_out[0];
-        // out[i] = sample; // copy the input sample to the output buffer
+        for(size_t j = 0; j < frames; j++)
+        {
+            s_out[0] = xfade.Process(block_in[j], block_glitch[j]);
+            out[start + 2 * j] = s_out[0];
+        }
     }
 }
 
@@ -472,16 +498,22 @@ void init() {
 
 
     // Set samplerate for your processing like so:
-    glitch.Init(sr, buf, BUF_SIZE, CHANS);
+    glitch.Init(sr, buf, BUF_SIZE, CHANS, summary_cells, GlitchEngine::Summary::CellsFor(BUF_SIZE));
     hw.seed.PrintLine("Initialized glitch engine with buffer size %d and %d channels", BUF_SIZE, CHANS);
     
     xfade.Init(sr, 10.0f);
     xfade.SetCrossfadeType(Xfade::TYPE::ASYMMETRIC_MIX); // default to power crossfade
     hw.seed.PrintLine("Initialized xfade with %d channels", CHANS);
 
-    limiter.Init();
+    limiter.Init(sr, /*threshold=*/ 0.7f, /*release_ms=*/ 100.0f);
 
     filter.Init(sr);
+    filter.SetRes(0.6f);
+
+    for (Hysteresis& h : knob_hyst)
+        h.Init(kKnobHysteresis);
+    dirty_glitch_params.Init(&setter_stats);
+    dirty_filter_freq.Init(&setter_stats);
 
 }
 // **************************************************
@@ -506,6 +538,7 @@ int main(void)
         // if (i % 2 == 0) {
         hw.seed.PrintLine("---------------");
         glitch.PrintDebugState(hw);
+        hw.seed.PrintLine("Setters: %d called, %d skipped", setter_stats.calls, setter_stats.skipped);
         hw.seed.PrintLine("");
         hw.seed.PrintLine("");
     }
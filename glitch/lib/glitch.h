@@ -8,6 +8,7 @@
 #include "grain.h"
 #include "daisysp.h"
 #include "ipoke.h"
+#include "summary.h"
 #include <array>
 #include "window.h"
 
@@ -115,26 +116,33 @@ public:
     GlitchEngine() {}
     ~GlitchEngine() {}
 
+    using Summary = SummaryPyramid<LazyBuffer>;
+
+    /// summary_cells: room for Summary::CellsFor(buf_frames), or none to go without
     void Init(float sample_rate, 
               float* buffer, 
               size_t buf_frames, 
-              size_t buf_chans) {
+              size_t buf_chans,
+              Summary::Cell* summary_cells = nullptr,
+              size_t num_summary_cells = 0) {
         sr_ = sample_rate;
         assert(buffer != nullptr); // make sure the buffer is not null
         buf_ = buffer;
         frames_ = buf_frames;
         chans_ = buf_chans;
 
-        poker_.Init(buf_, buf_frames, buf_chans);
+        // not cleared: reads past what's been recorded are silent
+        store_.Init(buf_, frames_ * chans_);
+        summary_.Init(&store_, frames_, chans_, summary_cells, num_summary_cells);
+        poker_.Init({&store_, &summary_}, buf_frames, buf_chans);
         poker_.SetOverdub(0.0f);
-        grains_.Init(sr_, buffer, buf_frames, buf_chans);
+        grains_.Init(sr_, &store_, buf_frames, buf_chans);
         pattern_.Init(16);
         clock_.Init(1.f / (glitch_dur_ * 0.001f), sr_);
 
         window_.Init(sr_);
         window_.BeginFadeIn(kWindowFadeMs);
 
-        std::fill(buf_, buf_ + (frames_ * chans_), 0.f);
         sig_.assign(1 * chans_, 0.f); // a single frame buffer.
     }
 
@@ -237,8 +245,15 @@ public:
                 glitch_start_pos_ = WrapPos(wpos_ - ((duration * 0.001f) * sr_ * rate));
             }
             // apply spread to the start position // (only to the past as to not go out of bounds)
+            // a few more tries if it lands on silence
             float start_pos = glitch_start_pos_;
-            start_pos = WrapPos(start_pos - (frames_ * mem_) + (randf(-spread_, 0.f) * frames_ * mem_));
+            const size_t span = (size_t)((duration * 0.001f) * sr_ * rate);
+            for (int tries = 0; tries < kStartTries; tries++) {
+                start_pos = WrapPos(glitch_start_pos_ - (frames_ * mem_) + (randf(-spread_, 0.f) * frames_ * mem_));
+                if (spread_ <= 0.f || !IsSilent(start_pos, span)) {
+                    break;
+                }
+            }
             // END CALCULATE start_pos
 
             // decide if we should skip this grain based on rskip probability
@@ -357,6 +372,40 @@ public:
         PITCH_SPREAD_OCTAVES,
     };
 
+    /// the buffer as a flat one starting at the oldest frame (to save it)
+    struct History {
+        const LazyBuffer *buf;
+        size_t start, size; // floats
+        float Read(size_t i) const {
+            i += start;
+            return buf->Read(i < size ? i : i - size);
+        }
+    };
+
+    History GetHistory() const {
+        return {&store_, (size_t)wpos_ * chans_, frames_ * chans_};
+    }
+
+    size_t GetFrames() const { return frames_; }
+
+    /// min/max/RMS of the buffer, for drawing it or finding the quiet parts
+    const Summary& GetSummary() const { return summary_; }
+
+    /// nothing louder than -60 dB in `frames` from `pos` on (wrapping); false without a summary
+    bool IsSilent(float pos, size_t frames) const {
+        const size_t begin = (size_t)pos;
+        const size_t end = begin + frames;
+        Summary::Stats s = summary_.Query(begin, end);
+        float peak = s.Peak();
+        size_t covered = s.frames;
+        if (end > frames_) {
+            s = summary_.Query(0, end - frames_);
+            peak = fmaxf(peak, s.Peak());
+            covered += s.frames;
+        }
+        return covered > 0 && peak < kSilence;
+    }
+
     void SetPitchSpreadType(PitchSpreadType type) {
         if (type != pitch_spread_type_) {
             pitch_spread_type_ = type;
@@ -368,6 +417,7 @@ public:
 private:
     float sr_;
     float *buf_;
+    LazyBuffer store_; // buf_, zeroed as it's first written
     size_t frames_;
     size_t chans_;
 
@@ -376,7 +426,8 @@ private:
 
     std::vector<float> sig_; // signal buffer for processing
 
-    Ipoke poker_;
+    Summary summary_; // kept up to date by poker_'s writes
+    IpokeT<SummaryStore<LazyBuffer>> poker_;
     Grains grains_; // grains for glitching
     Metro clock_; // grain clock
     size_t clock_idx_ = 0;
@@ -406,6 +457,8 @@ private:
 
     Window window_;
     static constexpr float kWindowFadeMs = 50.f; // fade in the window over 50ms
+    static constexpr float kSilence = 0.001f; // -60 dB
+    static constexpr int kStartTries = 4; // grain starts to try before settling for silence
 }; 
 
 } // namespace daisysp
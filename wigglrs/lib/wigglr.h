@@ -4,17 +4,78 @@
 
 #ifdef __cplusplus
 
+#include <atomic>
+#include <type_traits>
 #include "daisysp.h"
 #include "ipoke.h"
+#include "arena.h"
+#include "undo.h"
+#include "streambuf.h"
+#include "zerocross.h"
+#include "wsola.h"
+#include "bounce.h"
 
 namespace daisysp
 {
 
-class Wigglr 
+/**
+   A looper whose memory comes from a ChunkArena shared with other
+   loopers: the first pass grows into the arena chunk by chunk, and Clear()
+   hands the chunks back. Recording stops (and the loop plays) when the
+   arena runs out. The last overdubs can be undone and redone: each keeps
+   only the pages it wrote over, in the same arena.
+
+   Buf is where the loop lives: a ChunkedBuffer (Wigglr), or a
+   StreamedBuffer (StreamedWigglr), for loops longer than RAM, kept in a
+   file with a window of it in the arena. A streamed loop needs Service()
+   from the main loop, and keeps no undo (the pages to swap back aren't
+   in RAM).
+
+   With SetSnapFrames(), stopping the first take waits for the input to
+   cross zero going up, so the loop ends on a crossing and the input after
+   it carries on from frame 0. The take is indexed by its upward crossings
+   as it's recorded: a jump waits for the output to cross zero going up
+   and lands on the crossing nearest where it was sent. Overdubs don't
+   update the index.
+
+   With SetStretch(), the loop plays time-stretched (WSOLA) after the
+   first take's fade: SetTempo() sets how fast it goes round and the rate
+   only sets the pitch. Overdubs go in where the stretched loop is at.
+   Turning it on or off crossfades over one grain hop.
+
+   With SetBounce(), a loop left at another pitch than its own is
+   rendered again at that pitch (LoopBounce, a windowed sinc) into spare
+   arena memory, by Bounce() from the main loop. Once that's done the loop
+   swaps to the render, crossfading over 256 frames, and plays it at rate
+   1, a frame a read. The take it came from is kept while the render
+   plays: the next bounce starts from it, going back to its pitch swaps
+   straight back to it, and an overdub (into the render) lets it go. A
+   swap forgets the undo levels. Streamed loops don't bounce.
+
+   What a bounce may hold of the shared arena, besides the loop playing,
+   is capped by SetBounceBudget() (none until it's set), so it can't eat
+   into another loop's record time unasked. A bounce that doesn't fit
+   isn't tried again until the pitch, the budget or the arena's free
+   memory has changed.
+*/
+template <typename Buf = ChunkedBuffer<512>>
+class WigglrT 
 {
 public:
-    Wigglr() {}
-    ~Wigglr() {}
+    WigglrT() {}
+    ~WigglrT() {}
+
+    static constexpr size_t kUndoChunks  = 512; // of the arena's, per undo level
+    static constexpr size_t kIndexChunks = 64;  // for the zero crossings
+    using Buffer = Buf;
+    using Undo   = UndoLog<Buffer, kUndoChunks, 2>;
+    using Stretch = WsolaT<StoreRef<Buffer>>;
+
+    static constexpr size_t kBounceSettle = 12000; // frames the rate holds before a bounce
+    static constexpr size_t kBounceFade   = 256;   // frames a swap crossfades over
+
+    static constexpr size_t kUndoPages  = 2;  // swapped every kUndoFrames frames,
+    static constexpr size_t kUndoFrames = 48; // whichever of ProcessFrame()/ProcessBlock() runs
 
     enum class State
     {
@@ -24,20 +85,29 @@ public:
         REC_DUB,
     };
 
-    void Init(float sr, float *buf, size_t frames, size_t chans) {
+    void Init(float sr, ChunkArena* arena) {
         sr_ = sr;
-        buf_ = buf;
-        frames_ = frames;
-        chans_ = chans;
+        arena_ = arena;
+        buf_.Init(arena);
+        frames_ = buf_.GetMaxFrames();
+        chans_ = arena->GetChans();
 
         rate_st_line_.Init(sr);
-        peeker_.Init(buf_, frames_, chans_);
-        poker_.Init(buf_, frames_, chans_);
+        peeker_.Init(&buf_, frames_, chans_);
+        undo_.Init(arena, &buf_);
+        poker_.Init(UndoStore<Buffer, Undo>(&buf_, &undo_), frames_, chans_);
+        wsola_.Init(&buf_, frames_, chans_);
+        if (Buffer::kInMemory) {
+            spare_.Init(arena);
+            orig_.Init(arena);
+        }
+        crossings_.Init(arena);
         state_ = State::EMPTY;
 
         // sig_ = new float[chans_]();
         sig_.assign((size_t)chans_, 0.0f);
-        InitBuff();
+        fade_.assign((size_t)chans_, 0.0f);
+        win_end_ = WindowVal((kWindowSamps - 1) * kWindowFactor);
     }
 
     void SetLevel(float level) {
@@ -45,15 +115,16 @@ public:
     }
 
     float GetRateSemitones() const {
-        return rate_st_;
+        return base_st_ + rate_st_;
     }
 
     float GetTargetRateSemitones() const {
-        return rate_st_line_.GetEnd();
+        return base_st_ + rate_st_line_.GetEnd();
     }
 
     void SetRateSemitones(float target_rate_semitones) {
-        rate_st_line_.Start(rate_st_, target_rate_semitones, rate_slew_ms_ * 0.001f);
+        // from the pitch the loop playing was bounced to
+        rate_st_line_.Start(rate_st_, target_rate_semitones - base_st_, rate_slew_ms_ * 0.001f);
     }
 
     void SetRateSlewMs(float rate_slew_ms) {
@@ -64,7 +135,95 @@ public:
         overdub_ = fmin(fmax(overdub, 0.f), 1.f); // clamp between 0 and 1
     }
 
+    /// play time-stretched: tempo from SetTempo(), pitch from the rate
+    void SetStretch(bool stretch) {
+        stretch_ = stretch;
+    }
+
+    bool GetStretch() const {
+        return stretch_;
+    }
+
+    /// how fast a stretched loop goes round, 1 as recorded (0.25 to 4)
+    void SetTempo(float tempo) {
+        tempo_ = fclamp(tempo, 0.25f, 4.f);
+    }
+
+    float GetTempo() const {
+        return tempo_;
+    }
+
+    /**
+       render a loop again at the pitch it's left at, for Bounce() to do
+       from the main loop, and play that at rate 1 (in-memory loops)
+    */
+    void SetBounce(bool bounce) {
+        bounce_on_ = bounce;
+    }
+
+    bool GetBounce() const {
+        return bounce_on_;
+    }
+
+    /**
+       frames of arena memory a bounce may hold besides the loop playing:
+       the render, and the take kept under it. 0 (the default) lets none
+       start.
+    */
+    void SetBounceBudget(size_t frames) {
+        bounce_budget_  = frames;
+        bounce_blocked_ = false; // worth another try
+    }
+
+    size_t GetBounceBudget() const {
+        return bounce_budget_;
+    }
+
+    /**
+       from the main loop: render up to `frames` more of a bounce that's
+       due. False if there's none going.
+    */
+    bool Bounce(size_t frames) {
+        if (bounce_ != BounceState::RENDER) {
+            return false;
+        }
+        if (!bounce_abort_) {
+            bouncer_.Render(frames);
+        }
+        std::atomic_signal_fence(std::memory_order_seq_cst); // rendered before it's handed over
+        if (bounce_abort_) {
+            bounce_ = BounceState::DROP;
+        } else if (bouncer_.IsDone()) {
+            bounce_ = BounceState::READY;
+        }
+        return true;
+    }
+
+    /// a render is going, or waiting to be swapped in (or let go)
+    bool IsBouncing() const {
+        return bounce_ != BounceState::IDLE && bounce_ != BounceState::FADE;
+    }
+
+    /// of the render going, 0 to 1
+    float GetBounceProgress() const {
+        if (bounce_ == BounceState::RENDER) {
+            return bouncer_.GetProgress();
+        }
+        return bounce_ == BounceState::READY ? 1.f : 0.f;
+    }
+
+    /// the pitch the loop playing was rendered at, 0 as recorded
+    float GetBouncedSemitones() const {
+        return base_st_;
+    }
+
     void ProcessFrame(const float *in, float *out) {
+        ProcessUndo(1);
+        ProcessBounce(1);
+        if (stop_pending_ && StopDue(in)) {
+            StopFirstTake();
+        }
+
         // figure out sample increment
         float inc = 1.;
         if (state_ == State::EMPTY || state_ == State::REC_FIRST) {
@@ -84,12 +243,16 @@ public:
 
             }
         } else if (state_ == State::REC_FIRST) {
+            // grow into the arena as we go
+            const bool full = !buf_.Reserve((size_t)pos_ + 2);
+
             for (size_t chan = 0; chan < chans_; ++chan) {
                 out[chan] = 0.0f;
             }
             for (size_t chan = 0; chan < chans_ ; ++chan) {
                 sig_[chan] = SoftLimit(in[chan] * win_);
             }
+            PushCrossing();
             poker_.SetOverdub(0.f);
             poker_.Poke(pos_, sig_.data());
 
@@ -99,56 +262,60 @@ public:
             recsize_ = pos_;
             pos_    += inc;
 
-            if (pos_ > ((float)frames_ - 1)) {
+            if (full || pos_ > ((float)frames_ - 1)) {
                 state_   = State::PLAYING;
                 pos_     = 0;
                 // TODO: should we be resetting win idx here to 0? 
                 win_idx_ = 0;
+                stop_pending_ = false;
+                ReindexHead();
             }
         } else if (state_ == State::PLAYING) {
-            peeker_.Peek(pos_, out);
             // "seamless looping: the first N samps after recording is done are recorded with the input faded out."
 
             if (win_idx_ < kWindowSamps - 1) {
+                peeker_.Peek(pos_, out);
                 for (size_t chan = 0; chan < chans_ ; ++chan) {
                     sig_[chan] = out[chan] + in[chan] * (1.f - win_);
                 } 
+                if (reindex_) {
+                    PushCrossing();
+                }
                 poker_.SetOverdub(0.f);
                 poker_.Poke(pos_, sig_.data());
                 win_idx_ += 1;
+                AdvancePlaying(inc);
             } else {
+                PlayFrame(out, inc);
                 poker_.SetOverdub(overdub_);
                 poker_.Poke(-1.f, sig_.data()); // stop writing
+                undo_.End(); // a dub's fade out is in its level
             }
 
-            pos_ += inc;
-            if (pos_ > recsize_ - 1){
-                pos_  = 0;
-            } else if (pos_ < 0){
-                pos_ = recsize_ - 1;
+            if (jump_pending_ && JumpDue(out)) {
+                Jump();
             }
         } else if (state_ == State::REC_DUB) {
-            peeker_.Peek(pos_, out);
+            const float at = pos_;
+            PlayFrame(out, inc);
 
             poker_.SetOverdub(overdub_);
 
             for (size_t chan = 0; chan < chans_ ; ++chan) {
                 sig_[chan] = SoftLimit(in[chan] * win_);
             } 
-            poker_.Poke(pos_, sig_.data());
+            poker_.Poke(at, sig_.data());
 
-            // increment win idx and pos
+            // increment win idx
             if (win_idx_ < kWindowSamps - 1) {
                 win_idx_ += 1;
             }
 
-            // handle pos
-            pos_ += inc;
-            if (pos_ > recsize_ - 1){
-                pos_  = 0;
-                poker_.ResetIndex(); // reset the index in the poker
-            } else if (pos_ < 0){
-                pos_ = recsize_ - 1;
+            if (pos_ < at - 0.5f * recsize_) {
+                poker_.ResetIndex(); // went round: reset the index in the poker
+            }
+            if (jump_pending_ && JumpDue(out)) {
+                Jump();
             }
         }
 
@@ -160,14 +327,68 @@ public:
         near_beginning_ = state_ != State::EMPTY && !Recording() && pos_ < 4800 ? true : false;
     }
 
+    /**
+       Process `size` interleaved frames: the same as calling ProcessFrame()
+       for each, but the state is looked at once per run of frames and each
+       state has its own loop. The block is split where the first recording
+       ends. The rate ramp is worked out ahead for each run, with powf only
+       when the rate moves, and the window's sin only while it fades.
+    */
+    void ProcessBlock(const float *in, float *out, size_t size) {
+        ProcessUndo(size);
+        ProcessBounce(size);
+
+        size_t done = 0;
+        while (done < size) {
+            const float *x = in + done * chans_;
+            float *y = out + done * chans_;
+            const size_t n = size - done;
+            switch (state_) {
+                case State::EMPTY:     done += ProcessEmpty(y, n); break;
+                case State::REC_FIRST: done += ProcessRecFirst(x, y, n); break;
+                case State::PLAYING:   done += ProcessPlaying(x, y, n); break;
+                case State::REC_DUB:   done += ProcessDub(x, y, n); break;
+            }
+        }
+
+        near_beginning_ = state_ != State::EMPTY && !Recording() && pos_ < 4800 ? true : false;
+    }
+
+    /**
+       jump to `pos`. With snapping on, while the loop plays: at the next
+       upward zero crossing of the output (or SetSnapFrames() frames from
+       now, at the latest), to the crossing nearest `pos`.
+    */
     void SetPositionSamples(float pos) {
         if (pos < 0.f) {
-            pos_ = 0.f;
+            pos = 0.f;
         } else if (pos > recsize_ - 1) {
-            pos_ = recsize_ - 1;
-        } else {
+            pos = recsize_ - 1;
+        }
+        if (snap_ == 0 || (state_ != State::PLAYING && state_ != State::REC_DUB)) {
             pos_ = pos;
+            EndFade();
+            if (wsola_.IsRunning()) {
+                wsola_.Jump(pos_, recsize_);
+            }
+            return;
         }
+        // the index is of the take as recorded: scaled to a bounce of it
+        const size_t at = crossings_.Nearest((size_t)(pos / index_scale_), snap_);
+        const size_t to = (size_t)((float)at * index_scale_ + 0.5f);
+        jump_to_      = to < recsize_ ? (float)to : pos;
+        jump_wait_    = snap_;
+        jump_prev_    = 0.f;
+        jump_pending_ = true;
+    }
+
+    /**
+       how long stopping the first take and jumps may wait for an upward
+       zero crossing, and how far a jump may move to land on one; 0 (the
+       default): as they come. The index is built from the next take on.
+    */
+    void SetSnapFrames(size_t frames) {
+        snap_ = frames;
     }
 
     float GetPositionSamples() const {
@@ -178,15 +399,70 @@ public:
         return recsize_;
     }
 
+    /// empty, and the memory goes back to the arena
     inline void Clear() {
         state_ = State::EMPTY; 
+        poker_.Poke(-1.f, sig_.data()); // finish writing before the memory goes
+        undo_.Clear();
+        dub_queued_ = false;
+        crossings_.Reset();
+        jump_pending_ = false;
+        stop_pending_ = false;
+        wsola_.Reset();
+        buf_.Release();
+        if (bounce_ == BounceState::RENDER) {
+            bounce_abort_ = true; // still being written: let go once the main loop stops
+        } else {
+            spare_.Release();
+            bounce_ = BounceState::IDLE;
+        }
+        orig_.Release();
+        orig_held_   = false;
+        base_st_     = 0.f;
+        index_scale_ = 1.f;
+        settled_     = 0;
+        bounce_blocked_ = false;
+        near_beginning_ = false;
+    }
+
+    /// frames of arena memory held, bounces included
+    size_t GetMemoryFrames() const {
+        return buf_.GetCapacityFrames() + spare_.GetCapacityFrames() + orig_.GetCapacityFrames();
     }
 
+    /**
+       load a loop from outside (a WavImporter, from the main loop): make
+       room for `frames` while empty, write them into GetBuffer(), then
+       EndLoad() plays them. False if not empty or the memory isn't there.
+    */
+    bool BeginLoad(size_t frames) {
+        if (state_ != State::EMPTY) {
+            return false;
+        }
+        if (!buf_.Reserve(frames + 1)) {
+            buf_.Release();
+            return false;
+        }
+        return true;
+    }
+
+    void EndLoad(size_t frames) {
+        pos_     = 0;
+        recsize_ = frames;
+        win_idx_ = (size_t)kWindowSamps - 1; // no fade in: there's no input to fade out
+        state_   = State::PLAYING;
+    }
+
+    /// the loop's memory: GetRecSizeSamples() frames of it (to save it, say)
+    Buffer &GetBuffer() { return buf_; }
+    const Buffer &GetBuffer() const { return buf_; }
+
     inline const bool Recording() const { return state_ == State::REC_DUB || state_ == State::REC_FIRST; }
 
     inline bool IsNearBeginning() { return near_beginning_; }
 
     inline void TrigRecord() {
+        reindex_ = false;
         switch (state_)
         {
             case State::EMPTY:
@@ -194,16 +470,39 @@ public:
                 recsize_    = 0;
                 state_      = State::REC_FIRST;
                 SetRateSemitones(0.f);
+                crossings_.Reset();
+                wsola_.Reset();
+                jump_pending_ = false;
+                stop_pending_ = false;
                 break;
             case State::REC_FIRST: 
+                if (snap_ > 0) {
+                    // at the input's next upward zero crossing
+                    stop_pending_ = true;
+                    stop_wait_    = snap_;
+                    stop_prev_    = 0.f;
+                    return;
+                }
                 pos_ = 0;
                 state_ = State::PLAYING; 
                 poker_.ResetIndex();
+                ReindexHead();
                 break;
             case State::REC_DUB: 
+                // the level closes once the input has faded out of the loop
                 state_ = State::PLAYING; 
                 break;
             case State::PLAYING: 
+                if (undo_.Busy()) {
+                    dub_queued_ = true; // starts once the undo is done
+                    return;
+                }
+                if (Buffer::kInMemory) {
+                    undo_.Begin();
+                }
+                if (orig_held_) {
+                    DropOriginal(); // the dub goes into the bounce
+                }
                 poker_.ResetIndex();
                 state_ = State::REC_DUB; 
                 break;
@@ -211,19 +510,507 @@ public:
 
         }
         win_idx_ = 0;
+        EndFade(); // the input fades in or out over the loop alone
     }
 
     State GetState() const { return state_; }
 
-public:// TODO: make private. just for debugging to print
+    /**
+       undo the last overdub (stopping it, if it's going): the old pages
+       come back over the next few blocks. False if there's nothing to undo.
+    */
+    bool TrigUndo() {
+        if (state_ == State::EMPTY || state_ == State::REC_FIRST) {
+            return false;
+        }
+        dub_queued_ = false;
+        const bool dubbing = state_ == State::REC_DUB;
+        state_ = State::PLAYING;
+        poker_.Poke(-1.f, sig_.data()); // the last write goes in the level too
+        if (!undo_.Undo()) {
+            if (dubbing) {
+                win_idx_ = 0; // stopped as TrigRecord() would
+                EndFade();
+            }
+            return false;
+        }
+        win_idx_ = (size_t)kWindowSamps - 1; // no fade out of a dub that's going away
+        return true;
+    }
 
-    void InitBuff() {
-        std::fill(&buf_[0], &buf_[frames_ * chans_], 0);
+    /// put the last undone overdub back. False if there's none.
+    bool TrigRedo() {
+        if (state_ != State::PLAYING) {
+            return false;
+        }
+        return undo_.Redo();
     }
 
+    size_t GetNumUndo() const { return undo_.GetNumUndo(); }
+    size_t GetNumRedo() const { return undo_.GetNumRedo(); }
+
+    /// frames of arena memory the undo levels hold
+    size_t GetUndoMemoryFrames() const { return undo_.GetMemoryFrames(); }
+
+    /**
+       streamed loops only, from the main loop: keep the buffer's window on
+       the head, reading ahead for the faster of the rate and where it's
+       heading. False on an I/O error.
+    */
+    bool Service() {
+        const float st = fmax(rate_st_, rate_st_line_.GetEnd());
+        float rate = state_ == State::REC_FIRST ? 1.f : powf(2, st / 12.0f);
+        if (wsola_.IsRunning()) {
+            rate = fmax(rate, tempo_); // the grains run ahead at the rate
+        }
+        return buf_.Service(pos_, rate, state_ == State::EMPTY ? 0 : recsize_,
+                            state_ == State::REC_FIRST);
+    }
+
+public:// TODO: make private. just for debugging to print
+
     float WindowVal(float in) { return sin(HALFPI_F * in);}
     // float WindowVal(float in) { return 1.f;}
 
+private:
+    static constexpr size_t kMaxRun = 64; // frames of rate ramp worked out at once
+
+    void ProcessUndo(size_t frames) {
+        undo_frames_ += frames;
+        if (undo_frames_ >= kUndoFrames) {
+            undo_.Process(undo_frames_ / kUndoFrames * kUndoPages);
+            undo_frames_ %= kUndoFrames;
+        }
+        if (dub_queued_ && !undo_.Busy()) {
+            dub_queued_ = false;
+            if (state_ == State::PLAYING) {
+                TrigRecord();
+            }
+        }
+    }
+
+    /**
+       a bounce's steps on the audio side: start one once the rate has held
+       a while, give up on one the loop moved on from, swap a finished one
+       in. The memory for it comes and goes here, where the arena is used.
+    */
+    void ProcessBounce(size_t n) {
+        if (!Buffer::kInMemory) {
+            return;
+        }
+        const float want = base_st_ + rate_st_;
+        switch (bounce_) {
+            case BounceState::IDLE:
+                if (!Bounceable() || rate_st_ == 0.f || Blocked(want)) {
+                    settled_ = 0;
+                } else if ((settled_ += n) >= kBounceSettle) {
+                    StartBounce(want);
+                }
+                break;
+            case BounceState::RENDER:
+                if (!Bounceable() || want != bounce_st_) {
+                    bounce_abort_ = true;
+                }
+                break;
+            case BounceState::DROP:
+                spare_.Release();
+                bounce_ = BounceState::IDLE;
+                break;
+            case BounceState::READY:
+                if (bounce_abort_ || !Bounceable() || want != bounce_st_) {
+                    spare_.Release();
+                    bounce_ = BounceState::IDLE;
+                } else {
+                    SwapIn(false);
+                }
+                break;
+            case BounceState::FADE: break;
+        }
+    }
+
+    /// playing the loop as it is, at a rate that's done moving
+    inline bool Bounceable() const {
+        return bounce_on_ && state_ == State::PLAYING && win_idx_ >= kWindowSamps - 1
+               && !stretch_ && !wsola_.IsRunning() && !undo_.Busy() && !dub_queued_
+               && recsize_ > 1 && rate_st_ == rate_st_line_.GetEnd();
+    }
+
+    /// the last bounce to `want` didn't fit, and nothing that would let it has changed
+    inline bool Blocked(float want) const {
+        return bounce_blocked_ && want == blocked_st_ && arena_->GetNumFree() <= blocked_free_;
+    }
+
+    /// render the take (or what's playing) at `want` semitones, or swap straight back to the take
+    void StartBounce(float want) {
+        settled_ = 0;
+        if (orig_held_ && want == orig_st_) {
+            SwapIn(true);
+            return;
+        }
+        const Buffer *src      = orig_held_ ? &orig_ : &buf_;
+        const size_t  src_size = orig_held_ ? orig_size_ : recsize_;
+        const float   src_st   = orig_held_ ? orig_st_ : base_st_;
+        const size_t  size     = (size_t)((float)src_size * powf(2, (src_st - want) / 12.0f) + 0.5f);
+        const size_t chunk  = arena_->GetChunkFrames();
+        const size_t render = (size + 1 + chunk - 1) / chunk * chunk;
+        const size_t kept   = orig_held_ ? orig_.GetCapacityFrames() : buf_.GetCapacityFrames();
+        bounce_blocked_     = true;
+        blocked_st_         = want;
+        if (size < 2 || render + kept > bounce_budget_) {
+            blocked_free_ = kNone; // over budget: free memory won't help
+            return;
+        }
+        if (!spare_.Reserve(size + 1)) {
+            spare_.Release();
+            blocked_free_ = arena_->GetNumFree(); // the arena's full: wait for some back
+            return;
+        }
+        bounce_blocked_ = false;
+        bouncer_.Begin(src, src_size, &spare_, size, chans_);
+        bounce_st_    = want;
+        bounce_size_  = size;
+        bounce_abort_ = false;
+        std::atomic_signal_fence(std::memory_order_seq_cst); // set up before the main loop sees it
+        bounce_ = BounceState::RENDER;
+    }
+
+    /**
+       play the render (or, `back`, the take it came from) from where the
+       loop is at, at rate 1, fading out the loop that was playing
+    */
+    void SwapIn(bool back) {
+        const size_t old_size = recsize_;
+        const size_t size     = back ? orig_size_ : bounce_size_;
+        const float  st       = back ? orig_st_ : bounce_st_;
+        Buffer      *from     = &spare_;
+        if (back) {
+            Trade(buf_, orig_);   // the take plays again
+            Trade(orig_, spare_); // the render fades out from spare_
+            orig_held_ = false;
+        } else if (orig_held_) {
+            Trade(buf_, spare_);  // the last render fades out from spare_
+        } else {
+            Trade(buf_, spare_);
+            Trade(spare_, orig_); // the take is kept, and fades out from there
+            orig_held_ = true;
+            orig_size_ = old_size;
+            orig_st_   = base_st_;
+            from       = &orig_;
+        }
+        fade_peeker_.Init(from, frames_, chans_);
+        fade_pos_   = pos_;
+        fade_scale_ = (float)old_size / (float)size;
+        fade_size_  = old_size;
+        fade_idx_   = 0;
+
+        pos_ = roundf(pos_ * (float)size / (float)old_size); // on a frame: read without interpolating
+        if (pos_ > size - 1) {
+            pos_ = 0;
+        }
+        index_scale_ *= (float)size / (float)old_size;
+        recsize_ = size;
+        base_st_ = st;
+        rate_st_ = 0.f;
+        rate_st_line_.Start(0.f, 0.f, 1.f); // holds at 0
+        undo_.Clear(); // its pages are the old loop's
+        bounce_ = BounceState::FADE;
+    }
+
+    /// the loop the swap replaced, fading out under y
+    inline void FadeFrame(float *y, float inc) {
+        fade_peeker_.Peek(fade_pos_, fade_.data());
+        const float g = (float)fade_idx_ * (1.f / kBounceFade);
+        for (size_t chan = 0; chan < chans_; ++chan) {
+            y[chan] = fade_[chan] + g * (y[chan] - fade_[chan]);
+        }
+        fade_pos_ += inc * fade_scale_;
+        if (fade_pos_ > fade_size_ - 1) {
+            fade_pos_ = 0; // where AdvancePlaying() would have gone round
+        }
+        if (++fade_idx_ == kBounceFade) {
+            EndFade();
+        }
+    }
+
+    /// a swap's crossfade is over (or cut short): the old loop's memory goes
+    inline void EndFade() {
+        if (bounce_ != BounceState::FADE) {
+            return;
+        }
+        spare_.Release();
+        if (!orig_held_) {
+            orig_.Release();
+        }
+        bounce_ = BounceState::IDLE;
+    }
+
+    /// an overdub goes into the render: the take it came from is out of date
+    void DropOriginal() {
+        orig_held_ = false;
+        if (bounce_ != BounceState::FADE) {
+            orig_.Release(); // (a render of it reading on is dropped)
+        }
+    }
+
+    /// the loops' memory changes hands (in memory: streamed loops don't bounce)
+    static void Trade(Buffer &a, Buffer &b) {
+        Trade(a, b, std::integral_constant<bool, Buffer::kInMemory>());
+    }
+    static void Trade(Buffer &a, Buffer &b, std::true_type) { a.Swap(b); }
+    static void Trade(Buffer &, Buffer &, std::false_type) {}
+
+    inline float Window() {
+        return win_idx_ < kWindowSamps - 1 ? WindowVal(win_idx_ * kWindowFactor) : win_end_;
+    }
+
+    /// the next n increments of the rate ramp
+    void PrepareIncrements(size_t n) {
+        for (size_t j = 0; j < n; j++) {
+            uint8_t rate_st_line_finished = 0;
+            rate_st_ = rate_st_line_.Process(&rate_st_line_finished);
+            if (rate_st_ != inc_rate_st_) {
+                inc_rate_st_ = rate_st_;
+                inc_last_    = powf(2, rate_st_ / 12.0f);
+            }
+            incs_[j] = inc_last_;
+        }
+    }
+
+    size_t ProcessEmpty(float *out, size_t n) {
+        for (size_t i = 0; i < n * chans_; ++i) {
+            out[i] = 0.0f;
+        }
+        poker_.Poke(-1.f, sig_.data()); // stop writing
+        return n;
+    }
+
+    size_t ProcessRecFirst(const float *in, float *out, size_t n) {
+        // grow into the arena for the whole run at once
+        buf_.Reserve((size_t)pos_ + n + 1);
+        const size_t capacity = buf_.GetCapacityFrames();
+        poker_.SetOverdub(0.f);
+
+        for (size_t j = 0; j < n; ++j) {
+            if (stop_pending_ && StopDue(in + j * chans_)) {
+                StopFirstTake();
+                return j;
+            }
+            win_ = Window();
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                out[j * chans_ + chan] = 0.0f;
+                sig_[chan] = SoftLimit(in[j * chans_ + chan] * win_);
+            }
+            PushCrossing();
+            const bool full = (size_t)pos_ + 2 > capacity;
+            poker_.Poke(pos_, sig_.data());
+
+            if (win_idx_ < kWindowSamps - 1) {
+                win_idx_ += 1;
+            }
+            recsize_ = pos_;
+            pos_    += 1.f;
+
+            if (full || pos_ > ((float)frames_ - 1)) {
+                state_   = State::PLAYING;
+                pos_     = 0;
+                win_idx_ = 0;
+                stop_pending_ = false;
+                ReindexHead();
+                return j + 1;
+            }
+        }
+        return n;
+    }
+
+    size_t ProcessPlaying(const float *in, float *out, size_t n) {
+        n = n < kMaxRun ? n : kMaxRun;
+        PrepareIncrements(n);
+
+        size_t j = 0;
+        // the first samples after recording, with the input fading out
+        for (; j < n && win_idx_ < kWindowSamps - 1; ++j) {
+            float *y = out + j * chans_;
+            win_ = Window();
+            peeker_.Peek(pos_, y);
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                sig_[chan] = y[chan] + in[j * chans_ + chan] * (1.f - win_);
+            }
+            if (reindex_) {
+                PushCrossing();
+            }
+            poker_.SetOverdub(0.f);
+            poker_.Poke(pos_, sig_.data());
+            win_idx_ += 1;
+            AdvancePlaying(incs_[j]);
+            if (jump_pending_ && JumpDue(y)) {
+                Jump();
+            }
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                y[chan] *= level_;
+            }
+        }
+        if (j == n) {
+            return n;
+        }
+
+        win_ = win_end_;
+        const size_t first = j;
+        for (; j < n; ++j) {
+            float *y = out + j * chans_;
+            PlayFrame(y, incs_[j]);
+            if (j == first) {
+                // after the read: the last faded frame may sit under it
+                poker_.SetOverdub(overdub_);
+                poker_.Poke(-1.f, sig_.data()); // stop writing
+                undo_.End(); // a dub's fade out is in its level
+            }
+            if (jump_pending_ && JumpDue(y)) {
+                Jump();
+            }
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                y[chan] *= level_;
+            }
+        }
+        return n;
+    }
+
+    size_t ProcessDub(const float *in, float *out, size_t n) {
+        n = n < kMaxRun ? n : kMaxRun;
+        PrepareIncrements(n);
+        poker_.SetOverdub(overdub_);
+
+        for (size_t j = 0; j < n; ++j) {
+            float *y = out + j * chans_;
+            win_ = Window();
+            const float at = pos_;
+            PlayFrame(y, incs_[j]);
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                sig_[chan] = SoftLimit(in[j * chans_ + chan] * win_);
+            }
+            poker_.Poke(at, sig_.data());
+
+            if (win_idx_ < kWindowSamps - 1) {
+                win_idx_ += 1;
+            }
+            if (pos_ < at - 0.5f * recsize_) {
+                poker_.ResetIndex(); // went round
+            }
+            if (jump_pending_ && JumpDue(y)) {
+                Jump();
+            }
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                y[chan] *= level_;
+            }
+        }
+        return n;
+    }
+
+    /// first takes only: index where the input crosses zero going up
+    inline void PushCrossing() {
+        if (snap_ == 0) {
+            return;
+        }
+        float x = 0.f;
+        for (size_t chan = 0; chan < chans_; ++chan) {
+            x += sig_[chan];
+        }
+        crossings_.Push((size_t)pos_, x);
+    }
+
+    /**
+       a first take just stopped: its first frames get the input after it
+       faded into them, so index them again as they're written
+    */
+    inline void ReindexHead() {
+        if (snap_ == 0) {
+            return;
+        }
+        crossings_.Restart((size_t)kWindowSamps);
+        reindex_ = true;
+    }
+
+    /// the input (this frame's) crossed zero going up, or the wait is over
+    inline bool StopDue(const float *in) {
+        float x = 0.f;
+        for (size_t chan = 0; chan < chans_; ++chan) {
+            x += in[chan];
+        }
+        const bool due = (stop_prev_ < 0.f && x >= 0.f) || --stop_wait_ == 0;
+        stop_prev_ = x;
+        return due;
+    }
+
+    /// a stop that waited for a crossing: the loop is every frame before this one
+    inline void StopFirstTake() {
+        recsize_      = (size_t)pos_;
+        pos_          = 0;
+        state_        = State::PLAYING;
+        win_idx_      = 0;
+        stop_pending_ = false;
+        poker_.Poke(-1.f, sig_.data()); // the last frame goes in, and a new run starts
+        ReindexHead();
+    }
+
+    /// the output (this frame's, y) crossed zero going up, or the wait is over
+    inline bool JumpDue(const float *y) {
+        float x = 0.f;
+        for (size_t chan = 0; chan < chans_; ++chan) {
+            x += y[chan];
+        }
+        const bool due = (jump_prev_ < 0.f && x >= 0.f) || --jump_wait_ == 0;
+        jump_prev_ = x;
+        return due;
+    }
+
+    inline void Jump() {
+        pos_          = jump_to_;
+        jump_pending_ = false;
+        EndFade();
+        if (wsola_.IsRunning()) {
+            wsola_.Jump(pos_, recsize_);
+        }
+        if (state_ == State::REC_DUB) {
+            poker_.ResetIndex(); // don't draw a line across the loop
+        }
+    }
+
+    /// frame y of the loop, and pos_ on: read at inc, or stretched
+    inline void PlayFrame(float *y, float inc) {
+        if (stretch_ && !wsola_.IsRunning()) {
+            EndFade();
+            wsola_.Start(pos_, recsize_);
+        } else if (!stretch_ && wsola_.IsRunning() && !wsola_.IsDraining()) {
+            wsola_.Stop(); // hands back to the plain read a hop on
+        }
+        if (wsola_.IsRunning()) {
+            wsola_.Process(y, recsize_, inc, tempo_);
+            pos_ = wsola_.GetPosition();
+            return;
+        }
+        const size_t i = (size_t)pos_;
+        if (inc == 1.f && (float)i == pos_) {
+            // on a frame at rate 1 (a bounced loop): what Peek() would give, without interpolating
+            for (size_t chan = 0; chan < chans_; ++chan) {
+                y[chan] = zapgremlins(buf_.Read(i * chans_ + chan));
+            }
+        } else {
+            peeker_.Peek(pos_, y);
+        }
+        if (bounce_ == BounceState::FADE) {
+            FadeFrame(y, inc);
+        }
+        AdvancePlaying(inc);
+    }
+
+    inline void AdvancePlaying(float inc) {
+        pos_ += inc;
+        if (pos_ > recsize_ - 1){
+            pos_  = 0;
+        } else if (pos_ < 0){
+            pos_ = recsize_ - 1;
+        }
+    }
+
 public: // TODO: make private. just for debugging to print
 
     State state_; 
@@ -231,14 +1018,68 @@ public: // TODO: make private. just for debugging to print
     
     float sr_;
 
-    float *buf_;
+    Buffer buf_;
     size_t frames_;
     size_t chans_;
 
     std::vector<float> sig_; // temp vector for output
 
-    Ipeek peeker_;
-    Ipoke poker_;
+    IpeekT<StoreRef<Buffer>> peeker_;
+    IpokeT<UndoStore<Buffer, Undo>> poker_;
+    Undo undo_;
+    size_t undo_frames_ = 0; // since the last pages were swapped
+    bool dub_queued_ = false;
+
+    Stretch wsola_;
+    bool  stretch_ = false;
+    float tempo_   = 1.f; // stretched, how fast the loop goes round
+
+    enum class BounceState
+    {
+        IDLE,
+        RENDER, // the main loop renders into spare_
+        DROP,   // it stopped on a render no longer wanted: spare_ goes
+        READY,  // rendered: swapped in
+        FADE,   // swapped: the old loop fades out
+    };
+
+    Buffer spare_;             // where a bounce renders
+    Buffer orig_;              // the take a render playing came from
+    bool   orig_held_ = false;
+    size_t orig_size_ = 0;
+    float  orig_st_   = 0.f;   // its pitch
+    float  base_st_   = 0.f;   // what the loop playing was rendered at; rate_st_ is from here
+    float  index_scale_ = 1.f; // the loop playing's frames per frame of the indexed take
+    bool   bounce_on_ = false;
+    size_t settled_   = 0;     // frames the rate has held
+    ChunkArena *arena_ = nullptr;
+    size_t bounce_budget_  = 0;  // frames, besides the loop playing
+    bool   bounce_blocked_ = false;
+    float  blocked_st_     = 0.f;   // the pitch that didn't fit
+    size_t blocked_free_   = 0;     // the arena's free chunks then (kNone: over budget)
+    static constexpr size_t kNone = (size_t)-1;
+    LoopBounce<Buffer> bouncer_;
+    volatile BounceState bounce_ = BounceState::IDLE;
+    volatile bool bounce_abort_  = false;
+    float  bounce_st_   = 0.f;
+    size_t bounce_size_ = 0;
+    IpeekT<StoreRef<Buffer>> fade_peeker_;
+    std::vector<float> fade_;
+    float  fade_pos_   = 0.f;
+    float  fade_scale_ = 1.f; // the old loop's frames per frame of the new
+    size_t fade_size_  = 0;
+    size_t fade_idx_   = 0;
+
+    ZeroCrossIndex<kIndexChunks> crossings_;
+    size_t snap_ = 0;            // frames a stop or jump may wait or move, 0: off
+    bool   stop_pending_ = false;
+    bool   reindex_ = false;     // the fade after a first take is being indexed
+    size_t stop_wait_ = 0;
+    float  stop_prev_ = 0.f;
+    bool   jump_pending_ = false;
+    float  jump_to_   = 0.f;
+    size_t jump_wait_ = 0;       // frames left to wait for a crossing
+    float  jump_prev_ = 0.f;     // the output's last frame, summed
 
     // position, window val
     float pos_, win_;
@@ -249,6 +1090,8 @@ public: // TODO: make private. just for debugging to print
     static constexpr float kWindowSamps = 1024;
     static constexpr float kWindowFactor = (1.f / kWindowSamps);
 
+    float win_end_; // the window once it's done fading
+
     float level_ = 1.f;
     float overdub_ = 0.f;
 
@@ -256,11 +1099,21 @@ public: // TODO: make private. just for debugging to print
     float rate_slew_ms_ = 100.f; // slew time for rate changes in milliseconds
     float rate_st_ = 0.f; // playback rate in semitones    
 
+    float incs_[kMaxRun];       // ProcessBlock's rate ramp, as increments
+    float inc_rate_st_ = 0.f;   // the rate inc_last_ was worked out for
+    float inc_last_    = 1.f;
+
     // bool rec_queue_; 
     bool near_beginning_ = false; // whether the position is near the beginning of the buffer
 
 };
 
+using Wigglr = WigglrT<>;
+
+/// a looper in a file of up to MaxPages arena chunks, Slots of them in RAM
+template <size_t MaxPages, size_t Slots = 8>
+using StreamedWigglr = WigglrT<StreamedBuffer<MaxPages, Slots>>;
+
 } // namespace daisysp
 
 #endif // __cplusplus
@@ -0,0 +1,104 @@
+#pragma once
+#ifndef WMRS_LIB_WIGGLR_BANK_H
+#define WMRS_LIB_WIGGLR_BANK_H
+
+#ifdef __cplusplus
+
+#include "wigglr.h"
+
+namespace daisysp
+{
+
+/**
+   N Wigglrs over one ChunkArena, with their outputs summed. This is not a
+   fused mix: each loop runs its own ProcessBlock() over the block (reading
+   the input itself) and is added into the output in turn, so the cost is
+   one looper per layer playing. What the bank saves is the empty loops:
+   they're skipped, so a bank can be sized for the most layers wanted and
+   only pay for the ones recorded. Each loop is controlled on its own
+   through operator[].
+*/
+template <size_t N>
+class WigglrBank
+{
+public:
+    WigglrBank() {}
+    ~WigglrBank() {}
+
+    static constexpr size_t kNumLoops = N;
+
+    void Init(float sr, ChunkArena* arena) {
+        chans_ = arena->GetChans();
+        for (auto &w : loops_) {
+            w.Init(sr, arena);
+        }
+    }
+
+    Wigglr &operator[](size_t i) { return loops_[i]; }
+    const Wigglr &operator[](size_t i) const { return loops_[i]; }
+
+    static constexpr size_t size() { return N; }
+
+    /// loops that aren't empty
+    size_t GetNumActive() const {
+        size_t n = 0;
+        for (const auto &w : loops_) {
+            n += w.GetState() != Wigglr::State::EMPTY;
+        }
+        return n;
+    }
+
+    /// empty every loop, all the memory goes back to the arena
+    void Clear() {
+        for (auto &w : loops_) {
+            w.Clear();
+        }
+    }
+
+    /**
+       `size` interleaved frames of input in, the sum of every loop out,
+       loop by loop: the first loop playing writes straight into `out`,
+       each other one into a scratch block that's then added on.
+    */
+    void ProcessBlock(const float *in, float *out, size_t size) {
+        const size_t run = kScratch / chans_;
+        while (size > 0) {
+            const size_t n = size < run ? size : run;
+            const size_t len = n * chans_;
+            bool written = false;
+            for (auto &w : loops_) {
+                if (w.GetState() == Wigglr::State::EMPTY && !w.IsBouncing()) {
+                    continue; // silent, and Clear() left nothing to finish
+                } else if (!written) {
+                    w.ProcessBlock(in, out, n);
+                    written = true;
+                } else {
+                    w.ProcessBlock(in, scratch_, n);
+                    for (size_t i = 0; i < len; ++i) {
+                        out[i] += scratch_[i];
+                    }
+                }
+            }
+            if (!written) {
+                for (size_t i = 0; i < len; ++i) {
+                    out[i] = 0.f;
+                }
+            }
+            in   += len;
+            out  += len;
+            size -= n;
+        }
+    }
+
+private:
+    static constexpr size_t kScratch = 64; // floats
+
+    Wigglr loops_[N];
+    size_t chans_ = 1;
+    float  scratch_[kScratch];
+};
+
+} // namespace daisysp
+
+#endif // __cplusplus
+#endif // WMRS_LIB_WIGGLR_BANK_H
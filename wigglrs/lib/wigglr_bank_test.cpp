@@ -0,0 +1,186 @@
+// wigglr_bank_test.cpp
+// WigglrBank: its sum is the loops' outputs added up, empty loops are
+// free, and what each added layer costs (1, 2, 4, 8 loops): a looper's
+// worth, since the loops run one after the other.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../../flib -I../../DaisySP/Source wigglr_bank_test.cpp
+//       ../../DaisySP/build/libdaisysp.a -o wigglr_bank_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "wigglr_bank.h"
+
+using daisysp::ChunkArena;
+using daisysp::Wigglr;
+using daisysp::WigglrBank;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr     = 48000.f;
+static constexpr size_t kFrames = 48000 * 40;
+static constexpr size_t kLog2   = 14;
+static constexpr size_t kBlock  = 2; // as wigglrs.cpp
+
+struct Pool
+{
+    std::vector<float>    mem  = std::vector<float>(kFrames);
+    std::vector<uint16_t> list = std::vector<uint16_t>((kFrames >> kLog2) + 1);
+    ChunkArena            arena;
+    ChunkArena* Init()
+    {
+        arena.Init(mem.data(), mem.size(), kLog2, 1, list.data(), list.size());
+        return &arena;
+    }
+};
+
+float noise(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return 0.25f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+}
+
+// record loop i for 1 + i/2 s, play it back at its own rate and level
+template <typename Loops>
+void layer_up(Loops& loops, size_t count, std::vector<float>& scratch_out,
+              void (*process)(Loops&, const float*, float*, size_t))
+{
+    uint32_t seed = 1;
+    float in[kBlock];
+    for (size_t i = 0; i < count; i++) {
+        loops[i].SetLevel(0.8f - 0.05f * i);
+        loops[i].TrigRecord();
+        for (size_t f = 0; f < (size_t)(kSr * (1.f + 0.5f * i)); f += kBlock) {
+            for (size_t j = 0; j < kBlock; j++)
+                in[j] = noise(seed);
+            process(loops, in, scratch_out.data(), kBlock);
+        }
+        loops[i].TrigRecord();
+        loops[i].SetRateSemitones((float)(i % 3) * 5.f - 5.f);
+    }
+}
+
+// Test 1: the bank's output is the loops' outputs added up
+void test_sum()
+{
+    std::cout << "\n== Test 1: the mix ==\n";
+    static Pool pb, p[3];
+    static WigglrBank<4> bank;
+    static Wigglr        loose[3];
+    bank.Init(kSr, pb.Init());
+    for (size_t i = 0; i < 3; i++)
+        loose[i].Init(kSr, p[i].Init());
+
+    std::vector<float> out(kBlock);
+    layer_up<WigglrBank<4>>(bank, 3, out, [](WigglrBank<4>& b, const float* in, float* o, size_t n) {
+        b.ProcessBlock(in, o, n);
+    });
+    layer_up<Wigglr[3]>(loose, 3, out, [](Wigglr (&l)[3], const float* in, float*, size_t n) {
+        float tmp[kBlock];
+        for (Wigglr& w : l)
+            w.ProcessBlock(in, tmp, n);
+    });
+    CHECK(bank.GetNumActive() == 3, "three layers recorded, the fourth empty");
+
+    bool same = true;
+    uint32_t seed = 9;
+    for (size_t f = 0; f < (size_t)kSr * 10; f += kBlock) {
+        float in[kBlock], got[kBlock], a[kBlock], b[kBlock], c[kBlock];
+        for (size_t j = 0; j < kBlock; j++)
+            in[j] = noise(seed);
+        bank.ProcessBlock(in, got, kBlock);
+        loose[0].ProcessBlock(in, a, kBlock);
+        loose[1].ProcessBlock(in, b, kBlock);
+        loose[2].ProcessBlock(in, c, kBlock);
+        for (size_t j = 0; j < kBlock; j++)
+            same = same && got[j] == a[j] + b[j] + c[j];
+    }
+    CHECK(same, "10 s: the sum of three loops playing at their own rates");
+
+    bank.Clear();
+    float in[kBlock] = {0.5f, 0.5f}, got[kBlock] = {1.f, 1.f};
+    bank.ProcessBlock(in, got, kBlock);
+    CHECK(got[0] == 0.f && got[1] == 0.f && pb.arena.GetNumFree() == pb.arena.GetNumChunks(),
+          "cleared: silent, and the memory is back");
+}
+
+template <typename F>
+double ns_per(F&& run, size_t n)
+{
+    double best = 1e9;
+    for (int k = 0; k < 3; k++) { // best of three, the host's timing is noisy
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+    }
+    return best;
+}
+
+// what a frame costs with `layers` of a bank of N playing
+template <size_t N>
+double cost(size_t layers)
+{
+    static Pool              pool;
+    static WigglrBank<N>     bank;
+    bank.Init(kSr, pool.Init());
+    std::vector<float> out(kBlock);
+    layer_up<WigglrBank<N>>(bank, layers, out, [](WigglrBank<N>& b, const float* in, float* o, size_t n) {
+        b.ProcessBlock(in, o, n);
+    });
+
+    const size_t n = 48000 * 10;
+    float in[kBlock] = {0.1f, -0.1f}, acc = 0.f;
+    const double t = ns_per([&] {
+        for (size_t f = 0; f < n; f += kBlock) {
+            bank.ProcessBlock(in, out.data(), kBlock);
+            acc += out[0];
+        }
+    }, n);
+    volatile float sink = acc;
+    (void)sink;
+    bank.Clear();
+    return t;
+}
+
+// Test 2: each layer adds about one looper's worth, empty ones add nothing
+void test_cost()
+{
+    std::cout << "\n== Test 2: cost per layer ==\n";
+    const double budget = 1e9 / kSr; // ns per frame at 48 kHz
+    const double t1 = cost<1>(1);
+    const double t2 = cost<2>(2);
+    const double t4 = cost<4>(4);
+    const double t8 = cost<8>(8);
+    const double t8_1 = cost<8>(1);
+    std::printf("layers  ns/frame  of the 48 kHz budget\n");
+    std::printf("  1     %6.1f    %5.2f%%\n", t1, 100.0 * t1 / budget);
+    std::printf("  2     %6.1f    %5.2f%%\n", t2, 100.0 * t2 / budget);
+    std::printf("  4     %6.1f    %5.2f%%\n", t4, 100.0 * t4 / budget);
+    std::printf("  8     %6.1f    %5.2f%%\n", t8, 100.0 * t8 / budget);
+    std::printf("  1 of 8 %5.1f\n", t8_1);
+    std::printf("each added layer: %.1f ns\n", (t8 - t1) / 7);
+    CHECK(t8 < 8 * t1 * 1.5, "eight layers cost about eight loops"); // generous: the host is noisy
+    CHECK(t8_1 < t1 * 1.5 + 5.0, "empty layers cost next to nothing");
+}
+
+int main()
+{
+    std::cout << "Running wigglr bank tests...\n";
+    test_sum();
+    test_cost();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
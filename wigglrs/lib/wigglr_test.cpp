@@ -0,0 +1,814 @@
+// wigglr_test.cpp
+// Two Wigglrs sharing one ChunkArena: one can record past its old 60 s
+// while the other is empty, the other gets what's left, and Clear() gives
+// the memory back. ProcessBlock() against ProcessFrame(): same output,
+// less time. Undoing overdubs, saving and loading a loop as a WAV, a
+// loop streamed through a file playing as one held in memory, loop
+// ends and jumps landing on zero crossings, a time-stretched loop, and a
+// loop rendered again at the pitch it's left at, within a budget.
+// build (host build of DaisySP):
+//   g++ -O2 -std=c++14 -I../../flib -I../../DaisySP/Source wigglr_test.cpp
+//       ../../DaisySP/build/libdaisysp.a -o wigglr_test
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include "wigglr.h"
+#include "wav.h"
+
+using daisysp::ChunkArena;
+using daisysp::Wigglr;
+using daisysp::WigglrT;
+using daisysp::StreamedWigglr;
+using daisysp::ChunkedBuffer;
+using daisysp::WavImporter;
+using daisysp::WavWriter;
+
+// A tiny test helper for readable PASS/FAIL output.
+#define CHECK(cond, msg)                                                          \
+    do {                                                                          \
+        if (cond) {                                                               \
+            std::cout << "✔ " << msg << "\n";                                     \
+        } else {                                                                  \
+            std::cerr << "✘ " << msg << "\n";                                     \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+static constexpr float  kSr     = 48000.f;
+static constexpr size_t kFrames = 48000 * 120; // as wigglrs.cpp
+static constexpr size_t kLog2   = 14;
+
+static std::vector<float>    pool(kFrames);
+static std::vector<uint16_t> free_list((kFrames >> kLog2) + 1);
+
+void run(Wigglr& a, Wigglr& b, size_t frames)
+{
+    uint32_t seed = 1;
+    for (size_t i = 0; i < frames; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        const float in = 0.25f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+        float out;
+        a.ProcessFrame(&in, &out);
+        b.ProcessFrame(&in, &out);
+    }
+}
+
+// Test 1: memory shared through the arena
+void test_memory()
+{
+    std::cout << "\n== Test 1: shared memory ==\n";
+    ChunkArena arena;
+    arena.Init(pool.data(), pool.size(), kLog2, 1, free_list.data(), free_list.size());
+    Wigglr w1, w2;
+    w1.Init(kSr, &arena);
+    w2.Init(kSr, &arena);
+
+    // one looper, 100 s (each had 60 s of its own before)
+    w1.TrigRecord();
+    run(w1, w2, (size_t)kSr * 100);
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "w1 still recording at 100 s, holding %.1f s",
+                  w1.GetMemoryFrames() / kSr);
+    CHECK(w1.GetState() == Wigglr::State::REC_FIRST && w1.GetMemoryFrames() >= kSr * 100, msg);
+    CHECK(w2.GetMemoryFrames() == 0, "the empty w2 holds nothing");
+
+    // the other gets what's left, then loops it
+    w2.TrigRecord();
+    run(w1, w2, (size_t)kSr * 30);
+    std::snprintf(msg, sizeof(msg), "pool used up: w1 looped at %.1f s, w2 at %.1f s",
+                  w1.GetRecSizeSamples() / kSr, w2.GetRecSizeSamples() / kSr);
+    CHECK(w1.GetState() == Wigglr::State::PLAYING && w2.GetState() == Wigglr::State::PLAYING
+              && arena.GetNumFree() == 0, msg);
+    CHECK(w1.GetRecSizeSamples() + w2.GetRecSizeSamples() > kFrames - 2 * (1 << kLog2),
+          "together they filled the pool");
+
+    // clearing hands the memory back
+    w1.Clear();
+    std::snprintf(msg, sizeof(msg), "w1 cleared: %zu of %zu chunks free", arena.GetNumFree(),
+                  arena.GetNumChunks());
+    CHECK(w1.GetMemoryFrames() == 0 && arena.GetNumFree() > 0, msg);
+    w2.Clear();
+    CHECK(arena.GetNumFree() == arena.GetNumChunks(), "both cleared: the whole pool is free");
+
+    // and a loop recorded into reused chunks plays back what went in
+    w1.TrigRecord();
+    run(w1, w2, (size_t)kSr * 2);
+    w1.TrigRecord();
+    float peak = 0.f;
+    for (size_t i = 0; i < (size_t)kSr * 2; i++) {
+        const float in = 0.f;
+        float out;
+        w1.ProcessFrame(&in, &out);
+        peak = std::fmax(peak, std::fabs(out));
+    }
+    std::snprintf(msg, sizeof(msg), "a 2 s loop in reused memory plays (peak %.3f)", peak);
+    CHECK(w1.GetRecSizeSamples() == (size_t)kSr * 2 - 1 && peak > 0.1f && peak <= 0.125f, msg);
+    w1.Clear();
+}
+
+// a small arena of its own for each looper in the block tests
+struct Looper
+{
+    std::vector<float>    mem = std::vector<float>(48000 * 8);
+    std::vector<uint16_t> list = std::vector<uint16_t>(64);
+    ChunkArena            arena;
+    Wigglr                w;
+    void Init()
+    {
+        arena.Init(mem.data(), mem.size(), 12, 1, list.data(), list.size());
+        w.Init(kSr, &arena);
+    }
+};
+
+// the control changes a session might make, at block boundaries
+void control(Wigglr& w, size_t block, uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    const uint32_t r = seed >> 8;
+    if (block == 100 || (block > 210000 && block % 9000 == 100))
+        w.TrigRecord(); // a first take that fills the arena, then record, loop, dub, ...
+    if (r % 3000 == 0)
+        w.SetRateSemitones((float)((int)(r % 25) - 12));
+    if (r % 2000 == 1)
+        w.SetOverdub((r % 100) / 100.f);
+    if (r % 2500 == 2)
+        w.SetLevel((r % 100) / 100.f);
+    if (r % 6000 == 4)
+        w.SetStretch(!w.GetStretch());
+    if (r % 3500 == 5)
+        w.SetTempo(0.5f + (r % 150) / 100.f);
+    if (r % 7000 == 3 && w.GetState() == Wigglr::State::PLAYING) // a skip
+        w.SetPositionSamples((float)(r % w.GetRecSizeSamples()));
+    if (block == 200000 || block == 205000)
+        w.Clear(); // one while playing, one while empty
+}
+
+// a session run frame by frame and in blocks, side by side
+void block_session(size_t snap)
+{
+    static Looper a, b;
+    a.Init();
+    b.Init();
+    a.w.SetRateSlewMs(300.f);
+    b.w.SetRateSlewMs(300.f);
+    a.w.SetSnapFrames(snap);
+    b.w.SetSnapFrames(snap);
+
+    uint32_t sa = 5, sb = 5, noise = 1;
+    bool same = true, ran_out = false;
+    size_t frames = 0;
+    std::vector<float> in(70), out_a(70), out_b(70);
+    for (size_t block = 0; block < 300000; block++) {
+        control(a.w, block, sa);
+        control(b.w, block, sb);
+        const size_t n = (block / 1000) % 2 ? 2 : 1 + block % 70; // the pedal's, and odd ones
+        for (size_t j = 0; j < n; j++) {
+            noise = noise * 1664525u + 1013904223u;
+            in[j] = 0.5f * ((float)(noise >> 8) / 16777216.f - 0.5f);
+            a.w.ProcessFrame(&in[j], &out_a[j]);
+        }
+        b.w.ProcessBlock(in.data(), out_b.data(), n);
+        for (size_t j = 0; j < n; j++)
+            same = same && out_a[j] == out_b[j];
+        same = same && a.w.GetState() == b.w.GetState() && a.w.GetPositionSamples() == b.w.GetPositionSamples();
+        ran_out = ran_out || (b.arena.GetNumFree() == 0 && b.w.GetState() == Wigglr::State::PLAYING
+                              && b.w.GetRecSizeSamples() + 4096 + snap >= b.w.GetMemoryFrames());
+        frames += n;
+    }
+    char msg[96];
+    std::snprintf(msg, sizeof(msg), "%.0f s of a session, sample for sample%s", frames / kSr,
+                  snap ? ", snapping" : "");
+    CHECK(same, msg);
+    CHECK(ran_out, "including a first take that filled the arena");
+}
+
+// Test 2: ProcessBlock() gives exactly what ProcessFrame() does, through
+// recording, looping, overdubs, rate ramps, jumps, stretching, a clear, a first take
+// that runs out of memory, and odd block sizes; then again with loop ends
+// and jumps snapping to zero crossings
+void test_block()
+{
+    std::cout << "\n== Test 2: ProcessBlock == ProcessFrame ==\n";
+    for (size_t snap : {0, 480})
+        block_session(snap);
+}
+
+template <typename F>
+double ns_per(F&& run, size_t n)
+{
+    double best = 1e9;
+    for (int k = 0; k < 3; k++) { // best of three, the host's timing is noisy
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+    }
+    return best;
+}
+
+// Test 3: what a frame costs either way, playing and overdubbing with the
+// rate sliding, in the pedal's 2-frame blocks
+void test_block_cost()
+{
+    std::cout << "\n== Test 3: cost ==\n";
+    static Looper a;
+    a.Init();
+    Wigglr& w = a.w;
+    std::vector<float> in(2, 0.1f), out(2);
+    w.TrigRecord();
+    for (size_t i = 0; i < 48000 * 4; i++)
+        w.ProcessFrame(in.data(), out.data());
+    w.TrigRecord();
+    w.SetRateSlewMs(1000.f);
+
+    const size_t n = 48000 * 20;
+    float acc = 0.f;
+    for (int dub = 0; dub < 2; dub++) {
+        if (dub)
+            w.TrigRecord();
+        const double tf = ns_per([&] {
+            w.SetRateSemitones(w.GetTargetRateSemitones() == 0.f ? 7.f : 0.f);
+            for (size_t i = 0; i < n; i += 2) {
+                w.ProcessFrame(&in[0], &out[0]);
+                w.ProcessFrame(&in[1], &out[1]);
+                acc += out[1];
+            }
+        }, n);
+        const double tb = ns_per([&] {
+            w.SetRateSemitones(w.GetTargetRateSemitones() == 0.f ? 7.f : 0.f);
+            for (size_t i = 0; i < n; i += 2) {
+                w.ProcessBlock(in.data(), out.data(), 2);
+                acc += out[1];
+            }
+        }, n);
+        std::printf("%s: ProcessFrame %.1f ns, ProcessBlock %.1f ns per frame\n",
+                    dub ? "overdub" : "play   ", tf, tb);
+        if (dub) {
+            // the writes dominate here, the saving is smaller than the host's noise
+            CHECK(tb < tf * 1.2, "overdubbing costs no more by the block");
+        } else {
+            CHECK(tb < tf, "playing costs less by the block");
+        }
+    }
+    volatile float sink = acc;
+    (void)sink;
+}
+
+// the loop as it stands
+std::vector<float> snapshot(const Wigglr& w)
+{
+    std::vector<float> v(w.GetRecSizeSamples() + 1);
+    for (size_t i = 0; i < v.size(); i++)
+        v[i] = w.buf_.Read(i);
+    return v;
+}
+
+// play (or record) for `frames`, in 2-frame blocks; the most pages saved
+// for undo in any one block
+size_t play(Wigglr& w, size_t frames, uint32_t& seed)
+{
+    size_t most = 0;
+    for (size_t i = 0; i < frames; i += 2) {
+        float in[2], out[2];
+        for (float& x : in) {
+            seed = seed * 1664525u + 1013904223u;
+            x = 0.25f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+        }
+        const size_t before = w.undo_.GetSavedPages();
+        w.ProcessBlock(in, out, 2);
+        const size_t after = w.undo_.GetSavedPages();
+        most = std::max(most, after > before ? after - before : 0);
+    }
+    return most;
+}
+
+// Test 4: two overdubs undone and redone exactly, the undo memory is what
+// was dubbed over, saving is a page or two a block, a stopped dub's level
+// is closed, and swapping back takes as long frame by frame as in blocks
+void test_undo()
+{
+    std::cout << "\n== Test 4: undo ==\n";
+    static Looper a;
+    a.Init();
+    Wigglr& w = a.w;
+    uint32_t seed = 3;
+    w.SetOverdub(0.7f);
+    w.TrigRecord();
+    play(w, 48000 * 2, seed);
+    w.TrigRecord();
+    play(w, 4800, seed); // past the fade in
+    const std::vector<float> take = snapshot(w);
+    const size_t chunks_free = a.arena.GetNumFree();
+
+    // half a second of dub, then a dub over the whole loop, twice round
+    w.TrigRecord();
+    size_t most = play(w, 24000, seed);
+    w.TrigRecord();
+    play(w, 4800, seed);
+    const std::vector<float> dub1 = snapshot(w);
+    char msg[112];
+    std::snprintf(msg, sizeof(msg), "a 0.5 s dub keeps %.2f s to undo",
+                  (float)w.GetUndoMemoryFrames() / kSr);
+    CHECK(w.GetUndoMemoryFrames() < 48000 * 0.7f && w.GetUndoMemoryFrames() >= 24000, msg);
+    CHECK(!w.undo_.IsOpen(), "the dub stopped and faded out: its level is closed");
+
+    w.TrigRecord();
+    most = std::max(most, play(w, 48000 * 5, seed));
+    w.TrigRecord();
+    play(w, 4800, seed);
+    const std::vector<float> dub2 = snapshot(w);
+    std::snprintf(msg, sizeof(msg), "no more than %zu pages saved in a block", most);
+    CHECK(most <= 2, msg);
+    CHECK(w.GetNumUndo() == 2 && dub2 != dub1 && dub1 != take, "two overdubs to undo");
+
+    CHECK(w.TrigUndo(), "undo");
+    size_t blocks = 0;
+    while (w.undo_.Busy()) {
+        play(w, 2, seed);
+        blocks++;
+    }
+    std::snprintf(msg, sizeof(msg), "the whole-loop dub is gone after %zu blocks (%.0f ms)", blocks,
+                  blocks * 2 / kSr * 1000.f);
+    CHECK(snapshot(w) == dub1, msg);
+    w.TrigUndo();
+    play(w, 4800, seed);
+    CHECK(snapshot(w) == take && w.GetNumUndo() == 0 && !w.TrigUndo(), "and the first: back to the take");
+
+    w.TrigRedo();
+    play(w, 4800, seed);
+    CHECK(snapshot(w) == dub1, "redo");
+    w.TrigRedo();
+    size_t frames = 0;
+    while (w.undo_.Busy()) {
+        float in[2] = {}, out[2];
+        w.ProcessFrame(in, out);
+        frames++;
+    }
+    CHECK(snapshot(w) == dub2 && w.GetNumRedo() == 0, "redo again");
+    std::snprintf(msg, sizeof(msg), "frame by frame, back in %zu frames against %zu in blocks",
+                  frames, blocks * 2);
+    CHECK(frames + 48 >= blocks * 2 && frames <= blocks * 2 + 48, msg);
+
+    // a third dub pushes the first level out, and drops nothing else
+    w.TrigRecord();
+    play(w, 12000, seed);
+    w.TrigRecord();
+    play(w, 4800, seed);
+    w.TrigUndo();
+    play(w, 48000, seed);
+    w.TrigUndo();
+    play(w, 48000, seed);
+    CHECK(snapshot(w) == dub1 && !w.TrigUndo(), "two levels kept: the oldest goes");
+
+    // undo mid-dub, then dub again at once: the dub waits for the undo
+    w.TrigRecord();
+    play(w, 48000, seed);
+    w.TrigUndo();
+    w.TrigRecord();
+    play(w, 2, seed);
+    CHECK(w.GetState() == Wigglr::State::PLAYING, "a dub waits for the undo");
+    play(w, 48000, seed);
+    CHECK(w.GetState() == Wigglr::State::REC_DUB, "then starts");
+    w.TrigUndo();
+    play(w, 48000, seed);
+    CHECK(snapshot(w) == dub1, "stopped and undone mid-dub, cleanly");
+
+    w.Clear();
+    CHECK(a.arena.GetNumFree() == a.arena.GetNumChunks() && chunks_free < a.arena.GetNumChunks(),
+          "cleared: the loop's and the undo levels' memory is back");
+}
+
+static size_t mem_write(void* v, const void* data, size_t size)
+{
+    auto* bytes = (std::vector<uint8_t>*)v;
+    bytes->insert(bytes->end(), (const uint8_t*)data, (const uint8_t*)data + size);
+    return size;
+}
+
+struct MemRead
+{
+    const std::vector<uint8_t>* bytes;
+    size_t pos;
+};
+
+static size_t mem_read(void* v, void* data, size_t size)
+{
+    auto* r = (MemRead*)v;
+    size = std::min(size, r->bytes->size() - r->pos);
+    std::memcpy(data, r->bytes->data() + r->pos, size);
+    r->pos += size;
+    return size;
+}
+
+// Test 5: a loop saved as a WAV, a step at a time while it plays, loads
+// into another looper and plays the same
+void test_wav()
+{
+    std::cout << "\n== Test 5: save and load ==\n";
+    static Looper a, b;
+    a.Init();
+    b.Init();
+    uint32_t seed = 11;
+    a.w.TrigRecord();
+    play(a.w, 48000 * 3, seed);
+    a.w.TrigRecord();
+    play(a.w, 4800, seed);
+
+    std::vector<uint8_t> bytes;
+    WavWriter wr;
+    wr.Init({&bytes, mem_write}, 48000, 1, a.w.GetRecSizeSamples());
+    while (!wr.Done()) {
+        wr.Step(a.w.GetBuffer()); // as from the main loop, between blocks
+        play(a.w, 2, seed);
+    }
+
+    MemRead r = {&bytes, 0};
+    WavImporter imp;
+    imp.Init({&r, mem_read}, kSr, 1);
+    CHECK(b.w.BeginLoad(imp.GetFrames()), "room made for it");
+    while (!imp.Done())
+        imp.Step(b.w.GetBuffer());
+    b.w.EndLoad(imp.GetFrames());
+
+    // both from the top: the same sound
+    a.w.SetPositionSamples(0.f);
+    bool same = b.w.GetRecSizeSamples() == a.w.GetRecSizeSamples();
+    float peak = 0.f;
+    for (size_t i = 0; i < 48000 * 4 && same; i += 2) {
+        float in[2] = {0.f, 0.f}, oa[2], ob[2];
+        a.w.ProcessBlock(in, oa, 2);
+        b.w.ProcessBlock(in, ob, 2);
+        same = oa[0] == ob[0] && oa[1] == ob[1];
+        peak = std::max(peak, std::fabs(ob[0]));
+    }
+    CHECK(same && peak > 0.1f, "the loaded loop plays as the original");
+    CHECK(!b.w.BeginLoad(1000), "no loading over a loop");
+}
+
+// a file where every access takes `latency` frames, with the audio going
+// on meanwhile, as the interrupt does while the main loop waits on an SD card
+struct Disk
+{
+    FILE*                       f;
+    size_t                      latency;
+    std::function<void(size_t)> audio;
+};
+
+static bool disk_read(void* ctx, size_t offset, float* dst, size_t n)
+{
+    Disk* d = (Disk*)ctx;
+    d->audio(d->latency);
+    return std::fseek(d->f, (long)(offset * 4), SEEK_SET) == 0 && std::fread(dst, 4, n, d->f) == n;
+}
+
+static bool disk_write(void* ctx, size_t offset, const float* src, size_t n)
+{
+    Disk* d = (Disk*)ctx;
+    d->audio(d->latency);
+    return std::fseek(d->f, (long)(offset * 4), SEEK_SET) == 0 && std::fwrite(src, 4, n, d->f) == n;
+}
+
+// record, then 2x, an overdub at -5, 4x, a minute each
+template <typename L>
+void stream_control(L& l, size_t frame, size_t take)
+{
+    if (frame == 0 || frame == take || frame == take + 48000 * 60 || frame == take + 48000 * 120)
+        l.TrigRecord(); // record, play, dub, play
+    if (frame == take)
+        l.SetRateSemitones(12.f);
+    if (frame == take + 48000 * 60) {
+        l.SetRateSemitones(-5.f);
+        l.SetOverdub(0.5f);
+    }
+    if (frame == take + 48000 * 120)
+        l.SetRateSemitones(24.f);
+}
+
+// Test 6: a 150 s loop (more than the pedal's whole pool) streamed through
+// a file, 8 chunks of it in RAM and 20 ms an access, plays as the same
+// loop held in memory: the first take, 2x, an overdub at -5, 4x
+void test_stream()
+{
+    std::cout << "\n== Test 6: a loop streamed through a file ==\n";
+    using Streamed = StreamedWigglr<1024>; // 2^24 frames, where a float position stops counting
+    using Held     = WigglrT<ChunkedBuffer<1024>>;
+    static std::vector<float>    smem(8 << kLog2), hmem(48000 * 152);
+    static std::vector<uint16_t> slist(9), hlist((hmem.size() >> kLog2) + 1);
+    static ChunkArena            sarena, harena;
+    static Streamed              s;
+    static Held                  h;
+    sarena.Init(smem.data(), smem.size(), kLog2, 1, slist.data(), slist.size());
+    harena.Init(hmem.data(), hmem.size(), kLog2, 1, hlist.data(), hlist.size());
+    s.Init(kSr, &sarena);
+    h.Init(kSr, &harena);
+    Disk disk = {std::tmpfile(), 960, nullptr};
+    s.GetBuffer().Attach({&disk, disk_read, disk_write}, s.GetBuffer().GetMaxFrames());
+
+    const size_t take = 48000 * 150, end = take + 48000 * 180;
+    size_t frame = 0;
+    uint32_t seed = 3;
+    bool same = true;
+    float peak = 0.f;
+    disk.audio = [&](size_t n) {
+        for (size_t k = 0; k < n && frame < end; k += 2, frame += 2) {
+            stream_control(s, frame, take);
+            stream_control(h, frame, take);
+            float in[2], os[2], oh[2];
+            for (size_t j = 0; j < 2; j++) {
+                seed = seed * 1664525u + 1013904223u;
+                in[j] = 0.5f * ((float)(seed >> 8) / 16777216.f - 0.5f);
+            }
+            s.ProcessBlock(in, os, 2);
+            h.ProcessBlock(in, oh, 2);
+            same = same && os[0] == oh[0] && os[1] == oh[1];
+            peak = std::max(peak, std::fabs(os[0]));
+        }
+    };
+    while (frame < end) {
+        s.Service(); // the main loop, every 5 ms
+        disk.audio(240);
+    }
+    char msg[128];
+    std::snprintf(msg, sizeof(msg), "%.0f s loop, %.1f s of it in RAM: %zu misses",
+                  s.GetRecSizeSamples() / kSr, 8 * s.GetBuffer().GetPageFrames() / kSr,
+                  (size_t)s.GetBuffer().GetMisses());
+    CHECK(s.GetBuffer().GetMisses() == 0 && s.GetRecSizeSamples() == h.GetRecSizeSamples(), msg);
+    CHECK(same && peak > 0.1f, "sample for sample the loop held in memory");
+    CHECK(!s.TrigUndo(), "no undo for a streamed loop");
+    std::fclose(disk.f);
+}
+
+// Test 7: a 220 Hz sine, looped and jumped around in: with snapping, the
+// take stops where the input crosses zero going up, and neither the loop
+// point nor 200 jumps leave a step much bigger than the sine's own;
+// without, the jumps do
+void test_snap()
+{
+    std::cout << "\n== Test 7: zero crossings ==\n";
+    float steps[2];
+    for (size_t snap : {0, 480}) {
+        static Looper a;
+        a.Init();
+        Wigglr& w = a.w;
+        w.SetSnapFrames(snap);
+        double phase = 0.3;
+        auto sine = [&] {
+            phase += 2.0 * M_PI * 220.0 / 48000.0;
+            return 0.4f * (float)std::sin(phase);
+        };
+        w.TrigRecord();
+        for (size_t i = 0; i < 48000 * 2 + 123; i++) {
+            float in = sine(), out;
+            w.ProcessFrame(&in, &out);
+        }
+        w.TrigRecord();
+        for (size_t i = 0; i < 480; i++) {
+            float in = sine(), out;
+            w.ProcessFrame(&in, &out);
+        }
+        const size_t end = w.GetRecSizeSamples();
+        if (snap > 0)
+            CHECK(w.GetBuffer().Read(end - 1) < 0.f && end >= 48000 * 2 + 123
+                      && end <= 48000 * 2 + 123 + snap,
+                  "the take stops at an upward zero crossing, " << end - (48000 * 2 + 123)
+                      << " frames late");
+
+        uint32_t seed = 7;
+        float prev = 0.f, step = 0.f;
+        for (size_t i = 0; i < 48000 * 20; i += 2) {
+            if (i % 4800 == 0 && i >= 48000) { // after the input has faded out of the loop
+                seed = seed * 1664525u + 1013904223u;
+                w.SetPositionSamples((float)((seed >> 8) % end));
+            }
+            float in[2] = {sine(), sine()}, out[2];
+            w.ProcessBlock(in, out, 2);
+            if (i >= 48000)
+                step = std::max(step, std::max(std::fabs(out[0] - prev), std::fabs(out[1] - out[0])));
+            prev = out[1];
+        }
+        steps[snap > 0] = step;
+    }
+    std::printf("biggest step: %.4f snapping, %.4f not; the sine's own: %.4f\n", steps[1], steps[0],
+                0.4 * 2.0 * M_PI * 220.0 / 48000.0);
+    CHECK(steps[1] < 0.03f, "snapping: no clicks at the loop point or the jumps");
+    CHECK(steps[0] > 0.1f, "not: the jumps click");
+}
+
+// Test 8: stretched, the loop goes round at the tempo and keeps its pitch;
+// on and off without a click
+void test_stretch()
+{
+    std::cout << "\n== Test 8: time-stretch ==\n";
+    static Looper a;
+    a.Init();
+    Wigglr& w = a.w;
+    double phase = 0.0;
+    auto sine = [&] {
+        phase += 2.0 * M_PI * 220.0 / 48000.0;
+        return 0.4f * (float)std::sin(phase);
+    };
+    float in = 0.f, out;
+    w.TrigRecord();
+    for (size_t i = 0; i < 48000 * 3; i++) {
+        in = sine();
+        w.ProcessFrame(&in, &out);
+    }
+    w.TrigRecord();
+    in = 0.f;
+    for (size_t i = 0; i < 48000; i++) // past the fade
+        w.ProcessFrame(&in, &out);
+
+    // half tempo for a second, then back to a plain read
+    w.SetStretch(true);
+    w.SetTempo(0.5f);
+    const float from = w.GetPositionSamples();
+    size_t up = 0;
+    float prev = 0.f, step = 0.f;
+    std::vector<float> y(2);
+    for (size_t i = 0; i < 48000 + 2048; i += 2) {
+        float x[2] = {0.f, 0.f};
+        if (i == 48000)
+            w.SetStretch(false);
+        if (i == 48000 - 2) {
+            const float moved = w.GetPositionSamples() - from;
+            CHECK(std::fabs(moved - 24000.f) < 4.f, "half tempo: half a second of loop in a second");
+        }
+        w.ProcessBlock(x, y.data(), 2);
+        for (float o : y) {
+            step = std::max(step, std::fabs(o - prev));
+            up += i < 48000 && prev < 0.f && o >= 0.f;
+            prev = o;
+        }
+    }
+    std::printf("%zu upward crossings in a second, biggest step %.4f (the sine's own %.4f)\n", up, step,
+                0.4 * 2.0 * M_PI * 220.0 / 48000.0);
+    CHECK(up >= 219 && up <= 221, "and at the same pitch");
+    CHECK(step < 0.03f, "stretching on and off without a click");
+    const float at = w.GetPositionSamples();
+    for (size_t i = 0; i < 4800; i++)
+        w.ProcessFrame(&in, &out);
+    CHECK(std::fabs(w.GetPositionSamples() - at - 4800.f) < 1.f, "off: the plain read again");
+}
+
+// a 2 s take of a 220 Hz sine, played on past the fade
+void record_take(Wigglr& w)
+{
+    double phase = 0.0;
+    float  in, out;
+    w.TrigRecord();
+    for (size_t i = 0; i < 48000 * 2; i++) {
+        phase += 2.0 * M_PI * 220.0 / 48000.0;
+        in = 0.4f * (float)std::sin(phase);
+        w.ProcessFrame(&in, &out);
+    }
+    w.TrigRecord();
+    in = 0.f;
+    for (size_t i = 0; i < 4800; i++) // past the fade
+        w.ProcessFrame(&in, &out);
+}
+
+// Test 9: a loop left an octave up is rendered there from the "main
+// loop" and swapped in without a seam; back down swaps the take back
+void test_bounce()
+{
+    std::cout << "\n== Test 9: bounce ==\n";
+    static Looper a;
+    a.Init();
+    Wigglr& w = a.w;
+    float   in = 0.f, out;
+    record_take(w);
+    const size_t take = w.GetRecSizeSamples(), held = w.GetMemoryFrames();
+
+    // the audio side a block at a time, the main loop a slice every 100 blocks
+    size_t up = 0, frames = 0;
+    float  prev = 0.f, step = 0.f, progress = 0.f;
+    bool   partway = false;
+    std::vector<float> y(2);
+    auto play = [&](size_t n) {
+        for (size_t i = 0; i < n; i += 2) {
+            float x[2] = {0.f, 0.f};
+            w.ProcessBlock(x, y.data(), 2);
+            for (float o : y) {
+                step = std::max(step, std::fabs(o - prev));
+                up += prev < 0.f && o >= 0.f;
+                prev = o;
+            }
+            if (i % 200 == 0 && w.Bounce(4800)) {
+                const float p = w.GetBounceProgress();
+                partway  = partway || (p > 0.f && p < 1.f && p >= progress);
+                progress = p;
+            }
+        }
+        frames += n;
+    };
+
+    w.SetBounce(true);
+    w.SetBounceBudget(48000 * 4);
+    w.SetRateSemitones(12.f);
+    play(48000);
+    CHECK(partway, "the render's progress shows as it goes");
+    CHECK(!w.IsBouncing() && w.GetBouncedSemitones() == 12.f && w.GetRateSemitones() == 12.f,
+          "done in a second: the loop plays the render");
+    CHECK(w.GetRecSizeSamples() == (take + 1) / 2, "half as long");
+    const float at = w.GetPositionSamples();
+    CHECK(at == std::floor(at), "read a frame at a time, at rate 1");
+    CHECK(w.GetMemoryFrames() < held + held / 2 + 8192, "holding the take and the render, nothing else");
+
+    up = 0;
+    play(48000);
+    char msg[128];
+    std::snprintf(msg, sizeof(msg), "%zu upward crossings in a second, biggest step %.4f (the sine's own %.4f)",
+                  up, step, 0.4 * 2.0 * M_PI * 440.0 / 48000.0);
+    CHECK(up >= 439 && up <= 441, msg);
+    CHECK(step < 0.03f, "the swap without a click");
+
+    w.SetRateSemitones(0.f);
+    play(48000);
+    CHECK(w.GetBouncedSemitones() == 0.f && w.GetRecSizeSamples() == take && w.GetMemoryFrames() == held,
+          "back down: the take as it was, the render let go");
+    up = 0;
+    play(48000);
+    CHECK(up >= 219 && up <= 221 && step < 0.03f, "at its own pitch, still without a click");
+
+    w.SetRateSemitones(7.f);
+    for (size_t i = 0; i < 24000; i++) // settled, the render started, the main loop not back yet
+        w.ProcessFrame(&in, &out);
+    CHECK(w.IsBouncing(), "a fifth up: rendering");
+    w.Clear();
+    play(4800);
+    CHECK(!w.IsBouncing() && a.arena.GetNumFree() == a.arena.GetNumChunks(),
+          "cleared halfway: the render is dropped once the main loop lets go");
+}
+
+// Test 10: a bounce keeps to its budget and leaves a full arena alone,
+// and one that didn't fit goes once the budget or the memory is there
+void test_bounce_budget()
+{
+    std::cout << "\n== Test 10: bounce budget ==\n";
+    static Looper a;
+    a.Init();
+    Wigglr& w = a.w;
+    record_take(w);
+    const size_t held = w.GetMemoryFrames();
+
+    auto play = [&](size_t n) {
+        for (size_t i = 0; i < n; i += 2) {
+            float x[2] = {0.f, 0.f}, y[2];
+            w.ProcessBlock(x, y, 2);
+            if (i % 200 == 0)
+                w.Bounce(4800);
+        }
+    };
+    w.SetBounce(true);
+    w.SetRateSemitones(12.f);
+    play(48000);
+    CHECK(!w.IsBouncing() && w.GetBouncedSemitones() == 0.f && w.GetMemoryFrames() == held,
+          "no budget: no bounce");
+    w.SetBounceBudget(held); // the take fits, not the render as well
+    play(48000);
+    CHECK(!w.IsBouncing() && w.GetBouncedSemitones() == 0.f && w.GetMemoryFrames() == held,
+          "over budget: no bounce");
+
+    // another loop records until the arena's used up
+    static Wigglr v;
+    v.Init(kSr, &a.arena);
+    float in = 0.1f, out;
+    v.TrigRecord();
+    for (size_t i = 0; a.arena.GetNumFree() > 0 && i < 48000 * 8; i++)
+        v.ProcessFrame(&in, &out);
+    v.TrigRecord();
+    const size_t v_held = v.GetMemoryFrames();
+    CHECK(a.arena.GetNumFree() == 0, "the other loop fills the arena");
+
+    w.SetBounceBudget(48000 * 4);
+    play(48000);
+    CHECK(!w.IsBouncing() && w.GetBouncedSemitones() == 0.f && v.GetMemoryFrames() == v_held,
+          "in budget, but the arena's full: no bounce, the other loop's memory untouched");
+    v.Clear();
+    play(48000);
+    CHECK(!w.IsBouncing() && w.GetBouncedSemitones() == 12.f,
+          "the other loop cleared: bounced within a second");
+}
+
+int main()
+{
+    std::cout << "Running wigglr tests...\n";
+    test_memory();
+    test_block();
+    test_block_cost();
+    test_undo();
+    test_wav();
+    test_stream();
+    test_snap();
+    test_stretch();
+    test_bounce();
+    test_bounce_budget();
+    std::cout << "\nAll tests passed. ✅\n";
+    return 0;
+}
@@ -1,7 +1,8 @@
 #include "daisy_petal.h"
 #include "daisysp.h"
 #include "terrarium.h"
-#include "lib/wigglr.h"
+#include "lib/wigglr_bank.h"
+#include "blocklimiter.h"
 
 using namespace daisy;
 using namespace daisysp;
@@ -24,19 +25,34 @@ Parameter   knob_wigglr1_vol,
 
 float sr;
 
-#define WIGGLR_BUF_SIZE (48000 * 60)  // 60 seconds of audio at 48kHz
+#define WIGGLR_BUF_SIZE (48000 * 120)  // 120 seconds of audio at 48kHz, shared by both wigglrs
 #define WIGGLR_CHANS 1 // mono :(
+#define WIGGLR_CHUNK_LOG2 14 // 16384 frames (~0.34 s) per chunk
 #define BLOCK_SIZE 2 // 2 samples per block for audio processing
-
-float DSY_SDRAM_BSS wigglr1_buf[WIGGLR_BUF_SIZE * WIGGLR_CHANS];
-float DSY_SDRAM_BSS wigglr2_buf[WIGGLR_BUF_SIZE * WIGGLR_CHANS];
+#define WIGGLR_LAYERS 2 // one per footswitch
+#define BOUNCE_SLICE 4800 // frames of a bounce rendered per turn of the main loop
+// a bounce's render and the take it keeps fit in a quarter of the pool (30 s),
+// so a loop holds that plus an earlier render under it (itself under 30 s):
+// half the pool at most, and the other loop keeps its 60 s to record.
+// Loops up to about 15 s bounce.
+#define WIGGLR_BOUNCE_BUDGET (WIGGLR_BUF_SIZE / 4)
+
+// one pool: a wigglr takes chunks as it records and returns them on clear,
+// so either one can use all of it while the other is empty
+float DSY_SDRAM_BSS wigglr_pool[WIGGLR_BUF_SIZE * WIGGLR_CHANS];
+uint16_t wigglr_free_list[(WIGGLR_BUF_SIZE >> WIGGLR_CHUNK_LOG2) + 1];
+ChunkArena wigglr_arena;
 
 // intermediate buffers for wigglr output
-float wigglr_in[WIGGLR_CHANS];
-float wigglr1_out[WIGGLR_CHANS];
-float wigglr2_out[WIGGLR_CHANS];
+float wigglr_in[BLOCK_SIZE * WIGGLR_CHANS];
+float wigglrs_out[BLOCK_SIZE * WIGGLR_CHANS];
+
+WigglrBank<WIGGLR_LAYERS> wigglrs;
+Wigglr &wigglr1 = wigglrs[0], &wigglr2 = wigglrs[1];
 
-Wigglr wigglr1, wigglr2;
+// output limiter, once per block on the mix
+BlockLimiter limiter;
+float mix_buf[BLOCK_SIZE];
 
 float fsw_held_ms = 300.f;
 float max_slew_ms = 2000.f;
@@ -200,7 +216,8 @@ void configure_worm(Wigglr &wigglr, float level, float overdub,
                 skip = skip_maytrig.Process(actual_skip_prob-0.24f);
             }
             if (skip) {
-                // pick a random position in the buffer to skip to
+                // pick a random position in the buffer to skip to (it lands
+                // on a zero crossing near there, when the output crosses one)
                 float pos = (float)(rand() % wigglr.GetRecSizeSamples());
                 wigglr.SetPositionSamples(pos);
                 led_wrap.SetState(LedWrap::LedState::BLINK_SHORT);
@@ -303,17 +320,22 @@ void callback(
     led1_wrap.Process();
     led2_wrap.Process();
 
-    for(size_t i = 0; i < size; i += 2)
+    for(size_t start = 0; start < size; start += 2 * BLOCK_SIZE)
     {
-        wigglr_in[0] = in[i]; // left channel
+        size_t frames = std::min((size_t)BLOCK_SIZE, (size - start) / 2);
+
+        for(size_t j = 0; j < frames; j++)
+            wigglr_in[j] = in[start + 2 * j]; // left channel
 
-        wigglr1.ProcessFrame(wigglr_in, wigglr1_out);
-        wigglr2.ProcessFrame(wigglr_in, wigglr2_out);
+        wigglrs.ProcessBlock(wigglr_in, wigglrs_out, frames);
 
-        out[i] = SoftLimit(
-            in[i] + 
-            wigglr1_out[0] + wigglr2_out[0]
-        ); // mix both wigglrs
+        for(size_t j = 0; j < frames; j++)
+            mix_buf[j] = wigglr_in[j] + wigglrs_out[j]; // dry + every layer
+
+        limiter.ProcessBlock(mix_buf, frames);
+
+        for(size_t j = 0; j < frames; j++)
+            out[start + 2 * j] = mix_buf[j];
     }
 }
 
@@ -341,8 +363,17 @@ int main(void)
     knob_wigglrs_slew.Init(hw.knob[Terrarium::KNOB_5], 0.0f, 1.0f, Parameter::EXPONENTIAL);
     knob_wigglr_skip. Init(hw.knob[Terrarium::KNOB_6], 0.0f, 1.0f, Parameter::LINEAR);
 
-    wigglr1.Init(sr, wigglr1_buf, WIGGLR_BUF_SIZE, WIGGLR_CHANS);
-    wigglr2.Init(sr, wigglr2_buf, WIGGLR_BUF_SIZE, WIGGLR_CHANS);
+    wigglr_arena.Init(
+        wigglr_pool, WIGGLR_BUF_SIZE * WIGGLR_CHANS, WIGGLR_CHUNK_LOG2, WIGGLR_CHANS,
+        wigglr_free_list, sizeof(wigglr_free_list) / sizeof(wigglr_free_list[0])
+    );
+    wigglrs.Init(sr, &wigglr_arena);
+    for (size_t i = 0; i < wigglrs.size(); ++i) {
+        wigglrs[i].SetSnapFrames(480); // loop ends and skips land on zero crossings, 10 ms either way
+        wigglrs[i].SetBounce(true);
+        wigglrs[i].SetBounceBudget(WIGGLR_BOUNCE_BUDGET);
+    }
+    limiter.Init(sr, /*threshold=*/ 1.0f, /*release_ms=*/ 100.0f);
 
     skip_metro.Init(1 / 0.1f, sr);
 
@@ -350,10 +381,23 @@ int main(void)
     hw.StartAudio(callback);
 
 
+    uint32_t last_print = 0;
     while(1)
     {
-        // Do lower priority stuff infinitely here
-        System::Delay(200);
+        // Do lower priority stuff infinitely here: the loops' bounces, a
+        // slice at a time (the audio interrupt comes in whenever), and
+        // the prints every 200 ms
+        bool bouncing = false;
+        for (size_t i = 0; i < wigglrs.size(); ++i) {
+            bouncing = wigglrs[i].Bounce(BOUNCE_SLICE) || bouncing;
+        }
+        if (!bouncing) {
+            System::Delay(10);
+        }
+        if (System::GetNow() - last_print < 200) {
+            continue;
+        }
+        last_print = System::GetNow();
         // hw.seed.PrintLine("wigglr1 State: %d", (int)wigglr1.GetState());
         // hw.seed.PrintLine("wigglr2 State: %d", (int)wigglr2.GetState());
         // // led1.Set(sw1 ? 0.0f : 1.0f);
@@ -407,8 +451,8 @@ int main(void)
         hw.seed.Print("Win\t%.2f\n", 
             wigglr_in[0]
         );
-        hw.seed.Print("W1\t%.2f\t%.2f\n", 
-            wigglr1_out[0], wigglr2_out[0]
+        hw.seed.Print("Wout\t%.2f\t(%d layers)\n", 
+            wigglrs_out[0], (int)wigglrs.GetNumActive()
         );
         hw.seed.PrintLine("--------------------------------");
 
@@ -445,16 +489,22 @@ int main(void)
         // print the first 20 samples of the wigglr1 buffer
         hw.seed.Print("Wigglr1 Buf:\t");
         for (size_t i = 0; i < 20 && i < WIGGLR_BUF_SIZE; ++i) {
-            hw.seed.Print("%.2f ", wigglr1_buf[i]);
+            hw.seed.Print("%.2f ", wigglr1.buf_.Read(i));
         }
         hw.seed.PrintLine("");  
         // print the first 20 samples of the wigglr2 buffer
         hw.seed.Print("Wigglr2 Buf:\t");
         for (size_t i = 0; i < 20 && i < WIGGLR_BUF_SIZE; ++i) {
-            hw.seed.Print("%.2f ", wigglr2_buf[i]);
+            hw.seed.Print("%.2f ", wigglr2.buf_.Read(i));
         }
         hw.seed.PrintLine("");
 
+        hw.seed.PrintLine("Memory:	%d / %d free chunks",
+            (int)wigglr_arena.GetNumFree(), (int)wigglr_arena.GetNumChunks());
+        hw.seed.PrintLine("Bounce:\t%d%% at %d st\t%d%% at %d st",
+            (int)(wigglr1.GetBounceProgress() * 100.f), (int)wigglr1.GetBouncedSemitones(),
+            (int)(wigglr2.GetBounceProgress() * 100.f), (int)wigglr2.GetBouncedSemitones());
+
 
         // log d_start_, d_end_, d_step_ for each ipoke
         hw.seed.Print("Ipoke1:\tStart: %ld\tEnd: %ld\tStep: %ld\n", 